@@ -6,14 +6,17 @@
 
 //------------------------------------------------------------------------------
 
+#ifdef ARDUINO
 //--- Header for periph_module_enable
-#if ESP_ARDUINO_VERSION >= ESP_ARDUINO_VERSION_VAL(3, 0, 0)
-  #include <esp_private/periph_ctrl.h>
-#else
-  #include <driver/periph_ctrl.h>
-#endif
+  #if ESP_ARDUINO_VERSION >= ESP_ARDUINO_VERSION_VAL(3, 0, 0)
+    #include <esp_private/periph_ctrl.h>
+  #else
+    #include <driver/periph_ctrl.h>
+  #endif
 
-#include <hal/clk_gate_ll.h> // For ESP32 board manager
+  #include <hal/clk_gate_ll.h> // For ESP32 board manager
+  #include <esp_timer.h>
+#endif
 
 //------------------------------------------------------------------------------
 //   ESP32 Critical Section
@@ -42,8 +45,27 @@ static portMUX_TYPE portMux = portMUX_INITIALIZER_UNLOCKED ;
   twaiClockEnableAddress (inClockEnableAddress),
   mAcceptedFrameFormat (ACAN_ESP32_Filter::standardAndExtended),
   mDriverReceiveBuffer (),
+  mSubscriptions (),
+  mReceiveRoutines (),
+  mReceiveContexts (),
   mDriverTransmitBuffer (),
-  mDriverIsSending (false) {
+  mDriverIsSending (false),
+  mTransmitSuspended (false),
+  mTrimRequested (false),
+  mTransmitDiscardCount (0),
+  mTransmitFrameCount (),
+  mTransmitDelaySum (),
+  mTransmitDelayMax (),
+  mTransmitSubscriptions (),
+  mTransmitCompleteRoutines (),
+  mTransmitCompleteContexts (),
+  mTransmittingFrame (),
+  mTransmittingFrameValid (false),
+  mTransmitCompleteCount (0),
+  mInterruptCount (0),
+  mInterruptReceivedFrameCount (0),
+  mMaxFramesPerInterrupt (0),
+  mHardwareOverrunCount (0) {
 }
 #endif
 
@@ -55,15 +77,35 @@ static portMUX_TYPE portMux = portMUX_INITIALIZER_UNLOCKED ;
   ACAN_ESP32::ACAN_ESP32 (void) :
   mAcceptedFrameFormat (ACAN_ESP32_Filter::standardAndExtended),
   mDriverReceiveBuffer (),
+  mSubscriptions (),
+  mReceiveRoutines (),
+  mReceiveContexts (),
   mDriverTransmitBuffer (),
-  mDriverIsSending (false) {
+  mDriverIsSending (false),
+  mTransmitSuspended (false),
+  mTrimRequested (false),
+  mTransmitDiscardCount (0),
+  mTransmitFrameCount (),
+  mTransmitDelaySum (),
+  mTransmitDelayMax (),
+  mTransmitSubscriptions (),
+  mTransmitCompleteRoutines (),
+  mTransmitCompleteContexts (),
+  mTransmittingFrame (),
+  mTransmittingFrameValid (false),
+  mTransmitCompleteCount (0),
+  mInterruptCount (0),
+  mInterruptReceivedFrameCount (0),
+  mMaxFramesPerInterrupt (0),
+  mHardwareOverrunCount (0) {
 }
 #endif
 
 //------------------------------------------------------------------------------
-//   Set the GPIO pins
+//   Set the GPIO pins (no pins on a host build)
 //------------------------------------------------------------------------------
 
+#ifdef ARDUINO
 void ACAN_ESP32::setGPIOPins (const gpio_num_t inTXPin,
                               const gpio_num_t inRXPin) {
 //--- Set TX pin
@@ -73,6 +115,7 @@ void ACAN_ESP32::setGPIOPins (const gpio_num_t inTXPin,
   pinMode (inRXPin, INPUT) ;
   pinMatrixInAttach (inRXPin, twaiRxPinSelector, false) ;
 }
+#endif
 
 //------------------------------------------------------------------------------
 //   Set the Requested Mode
@@ -190,6 +233,17 @@ void ACAN_ESP32::setAcceptanceFilter (const ACAN_ESP32_Filter & inFilter) {
   TWAI_ACC_MASK_FILTER (3) = inFilter.mAMR3 ;
 }
 
+//------------------------------------------------------------------------------
+//   Driver buffer: static storage if the settings give one, heap otherwise
+//------------------------------------------------------------------------------
+
+bool ACAN_ESP32::initBuffer (ACAN_ESP32_Buffer16 & ioBuffer, CANMessage * inStorage,
+                             const uint16_t inSize) {
+  return (inStorage != nullptr)
+    ? ioBuffer.initWithStorage (inStorage, inSize)
+    : ioBuffer.initWithSize (inSize) ;
+}
+
 //------------------------------------------------------------------------------
 //   BEGIN
 //------------------------------------------------------------------------------
@@ -213,7 +267,9 @@ uint32_t ACAN_ESP32::begin (const ACAN_ESP32_Settings & inSettings,
 //--------------------------------- Enable CAN module
   periph_module_enable (twaiPeriphModule) ;
 //--------------------------------- Set GPIO pins
-  setGPIOPins (inSettings.mTxPin, inSettings.mRxPin);
+  #ifdef ARDUINO
+    setGPIOPins (inSettings.mTxPin, inSettings.mRxPin);
+  #endif
 //--------------------------------- Required: It is must to enter RESET Mode to write the Configuration Registers
   TWAI_CMD_REG () = TWAI_ABORT_TX ;
   TWAI_MODE_REG () = TWAI_RESET_MODE ;
@@ -246,13 +302,30 @@ uint32_t ACAN_ESP32::begin (const ACAN_ESP32_Settings & inSettings,
     errorCode |= kTooFarFromDesiredBitRate;
   }
   errorCode |= inSettings.CANBitSettingConsistency ();
-//----------------------------------- Allocate buffer
-  if (!mDriverReceiveBuffer.initWithSize (inSettings.mDriverReceiveBufferSize)) {
+//----------------------------------- Allocate buffers, or use the static storage of the settings
+  if (!initBuffer (mDriverReceiveBuffer, inSettings.mDriverReceiveBufferStorage,
+                   inSettings.mDriverReceiveBufferSize)) {
     errorCode |= kCannotAllocateDriverReceiveBuffer ;
   }
-  if (!mDriverTransmitBuffer.initWithSize (inSettings.mDriverTransmitBufferSize)) {
-    errorCode |= kCannotAllocateDriverTransmitBuffer ;
+  CANMessage * const transmitBufferStorages [kTransmitPriorityCount] = {
+    inSettings.mDriverControlTransmitBufferStorage,
+    inSettings.mDriverTransmitBufferStorage,
+    inSettings.mDriverBackgroundTransmitBufferStorage
+  } ;
+  const uint16_t transmitBufferSizes [kTransmitPriorityCount] = {
+    inSettings.mDriverControlTransmitBufferSize,
+    inSettings.mDriverTransmitBufferSize,
+    inSettings.mDriverBackgroundTransmitBufferSize
+  } ;
+  for (uint8_t i=0 ; i<kTransmitPriorityCount ; i++) {
+    if (!initBuffer (mDriverTransmitBuffer [i], transmitBufferStorages [i], transmitBufferSizes [i])) {
+      errorCode |= kCannotAllocateDriverTransmitBuffer ;
+    }
   }
+  mDriverIsSending.store (false) ;
+  mTransmitSuspended.store (false) ;
+  mTrimRequested.store (false) ;
+  mTransmittingFrameValid.store (false) ;
 //--------------------------------- Set Bus timing Registers
   if (errorCode == 0) {
     setBitTimingSettings (inSettings) ;
@@ -267,7 +340,7 @@ uint32_t ACAN_ESP32::begin (const ACAN_ESP32_Settings & inSettings,
 //--------------------------------- Set Interrupt Service Routine
   esp_intr_alloc (twaiInterruptSource, 0, isr, this, & mInterruptHandler) ;
 //--------------------------------- Enable Interupts
-  TWAI_INT_ENA_REG () = TWAI_TX_INT_ENA | TWAI_RX_INT_ENA ;
+  TWAI_INT_ENA_REG () = TWAI_TX_INT_ENA | TWAI_RX_INT_ENA | TWAI_OVERRUN_INT_ENA ;
 //--------------------------------- Set to Requested Mode
   setRequestedCANMode (inSettings, inFilterSettings) ;
 //---
@@ -324,10 +397,25 @@ void IRAM_ATTR ACAN_ESP32::isr (void * inUserArgument) {
   ACAN_ESP32 * myDriver = (ACAN_ESP32 *) inUserArgument ;
 
   portENTER_CRITICAL (&portMux) ;
+  myDriver->mInterruptCount += 1 ;
+//--- Reading TWAI_INT_RAW_REG clears the pending interrupts
   const uint32_t interrupt = myDriver->TWAI_INT_RAW_REG () ;
-  if ((interrupt & TWAI_RX_INT_ST) != 0) {
-     myDriver->handleRXInterrupt () ;
+//--- Hardware receive FIFO overrun: count it and clear the status bit
+  if ((interrupt & TWAI_OVERRUN_INT_ST) != 0) {
+    myDriver->mHardwareOverrunCount += 1 ;
+    myDriver->TWAI_CMD_REG () = TWAI_CLR_OVERRUN ;
+  }
+//--- Empty the hardware receive FIFO, not just the frame that raised the interrupt
+  uint32_t frames = 0 ;
+  while ((frames < kMaxFramesPerInterrupt) && (myDriver->TWAI_RX_MESSAGE_COUNTER_REG () > 0)) {
+    myDriver->handleRXInterrupt () ;
+    frames += 1 ;
+  }
+  myDriver->mInterruptReceivedFrameCount += frames ;
+  if (myDriver->mMaxFramesPerInterrupt < frames) {
+    myDriver->mMaxFramesPerInterrupt = frames ;
   }
+//--- Transmit complete
   if ((interrupt & TWAI_TX_INT_ST) != 0) {
      myDriver->handleTXInterrupt () ;
   }
@@ -338,14 +426,26 @@ void IRAM_ATTR ACAN_ESP32::isr (void * inUserArgument) {
 
 //------------------------------------------------------------------------------
 
+void ACAN_ESP32::resetInterruptStatistics (void) {
+  portENTER_CRITICAL (&portMux) ;
+    mInterruptCount = 0 ;
+    mInterruptReceivedFrameCount = 0 ;
+    mMaxFramesPerInterrupt = 0 ;
+    mHardwareOverrunCount = 0 ;
+  portEXIT_CRITICAL (&portMux) ;
+}
+
+//------------------------------------------------------------------------------
+
 void ACAN_ESP32::handleTXInterrupt (void) {
-  CANMessage message ;
-  const bool sendmsg = mDriverTransmitBuffer.remove (message) ;
-  if (sendmsg) {
-    internalSendMessage (message) ;
-  }else {
-    mDriverIsSending = false ;
+//--- The frame in the controller is done: report it if it went out
+  if (mTransmittingFrameValid.exchange (false)) {
+    if ((TWAI_STATUS_REG () & TWAI_TX_COMPLETE) != 0) {
+      notifyTransmitComplete () ;
+    }
   }
+//--- The token comes back with the interrupt
+  transmitNextFrame () ;
 }
 
 //------------------------------------------------------------------------------
@@ -353,21 +453,34 @@ void ACAN_ESP32::handleTXInterrupt (void) {
 void ACAN_ESP32::handleRXInterrupt (void) {
   CANMessage frame;
   getReceivedMessage (frame) ;
+  bool accepted = false ;
   switch (mAcceptedFrameFormat) {
   case ACAN_ESP32_Filter::standard :
-    if (!frame.ext) {
-      mDriverReceiveBuffer.append (frame) ;
-    }
+    accepted = !frame.ext ;
     break ;
   case ACAN_ESP32_Filter::extended :
-    if (frame.ext) {
-      mDriverReceiveBuffer.append (frame) ;
-    }
+    accepted = frame.ext ;
     break ;
   case ACAN_ESP32_Filter::standardAndExtended :
-    mDriverReceiveBuffer.append (frame) ;
+    accepted = true ;
     break ;
   }
+  if (accepted) {
+    for (uint8_t i=0 ; i<kFrameRoutineCount ; i++) {
+      if (mReceiveRoutines [i] != nullptr) {
+        mReceiveRoutines [i] (frame, mReceiveContexts [i]) ;
+      }
+    }
+    ACAN_ESP32_Subscription * subscription = nullptr ;
+    if (!frame.ext && (frame.id < kSubscribableIdentifierCount)) {
+      subscription = mSubscriptions [frame.id] ;
+    }
+    if (subscription != nullptr) {
+      subscription->publish (frame) ;
+    }else{
+      mDriverReceiveBuffer.append (frame) ;
+    }
+  }
 }
 
 //------------------------------------------------------------------------------
@@ -382,15 +495,160 @@ bool ACAN_ESP32::available (void) const {
 //------------------------------------------------------------------------------
 
 bool ACAN_ESP32::receive (CANMessage & outMessage) {
+//--- The task is the only consumer of the receive buffer: no lock needed
+  return mDriverReceiveBuffer.remove (outMessage) ;
+}
+
+//------------------------------------------------------------------------------
+
+uint32_t ACAN_ESP32::receive (CANMessage outMessages [], const uint32_t inMaxCount) {
+  const uint16_t maxCount = (inMaxCount > 0xFFFF) ? 0xFFFF : uint16_t (inMaxCount) ;
+  return mDriverReceiveBuffer.removeBatch (outMessages, maxCount) ;
+}
+
+//------------------------------------------------------------------------------
+
+uint32_t ACAN_ESP32::drain (ACANCallBackRoutine inRoutine) {
+  return mDriverReceiveBuffer.consumeAll ([inRoutine] (const CANMessage & inMessage) {
+    inRoutine (inMessage) ;
+  }) ;
+}
+
+//------------------------------------------------------------------------------
+
+uint32_t ACAN_ESP32::drain (DrainRoutine inRoutine, void * inContext) {
+  return mDriverReceiveBuffer.consumeAll ([inRoutine, inContext] (const CANMessage & inMessage) {
+    inRoutine (inMessage, inContext) ;
+  }) ;
+}
+
+//------------------------------------------------------------------------------
+
+bool ACAN_ESP32::subscribe (ACAN_ESP32_Subscription & inSubscription) {
+  const bool ok = inSubscription.mIdentifier < kSubscribableIdentifierCount ;
+  if (ok) {
+    portENTER_CRITICAL (&portMux) ;
+      mSubscriptions [inSubscription.mIdentifier] = & inSubscription ;
+    portEXIT_CRITICAL (&portMux) ;
+  }
+  return ok ;
+}
+
+//------------------------------------------------------------------------------
+
+void ACAN_ESP32::unsubscribe (const ACAN_ESP32_Subscription & inSubscription) {
+  if (inSubscription.mIdentifier < kSubscribableIdentifierCount) {
+    portENTER_CRITICAL (&portMux) ;
+      if (mSubscriptions [inSubscription.mIdentifier] == & inSubscription) {
+        mSubscriptions [inSubscription.mIdentifier] = nullptr ;
+      }
+    portEXIT_CRITICAL (&portMux) ;
+  }
+}
+
+//------------------------------------------------------------------------------
+
+bool ACAN_ESP32::addRoutine (ReceiveRoutine ioRoutines [], void * ioContexts [],
+                             ReceiveRoutine inRoutine, void * inContext) {
+  bool ok = inRoutine == nullptr ;
   portENTER_CRITICAL (&portMux) ;
-    const bool hasReceivedMessage = mDriverReceiveBuffer.remove (outMessage) ;
+    for (uint8_t i=0 ; (i<kFrameRoutineCount) && !ok ; i++) {
+      if (ioRoutines [i] == nullptr) {
+        ioContexts [i] = inContext ;
+        ioRoutines [i] = inRoutine ;
+        ok = true ;
+      }
+    }
   portEXIT_CRITICAL (&portMux) ;
-  return hasReceivedMessage ;
+  return ok ;
+}
+
+//------------------------------------------------------------------------------
+
+void ACAN_ESP32::removeRoutine (ReceiveRoutine ioRoutines [], void * ioContexts [],
+                                ReceiveRoutine inRoutine, void * inContext) {
+  portENTER_CRITICAL (&portMux) ;
+    for (uint8_t i=0 ; i<kFrameRoutineCount ; i++) {
+      if ((ioRoutines [i] == inRoutine) && (ioContexts [i] == inContext)) {
+        ioRoutines [i] = nullptr ;
+        ioContexts [i] = nullptr ;
+      }
+    }
+  portEXIT_CRITICAL (&portMux) ;
+}
+
+//------------------------------------------------------------------------------
+
+bool ACAN_ESP32::addReceiveRoutine (ReceiveRoutine inRoutine, void * inContext) {
+  return addRoutine (mReceiveRoutines, mReceiveContexts, inRoutine, inContext) ;
+}
+
+//------------------------------------------------------------------------------
+
+void ACAN_ESP32::removeReceiveRoutine (ReceiveRoutine inRoutine, void * inContext) {
+  removeRoutine (mReceiveRoutines, mReceiveContexts, inRoutine, inContext) ;
+}
+
+//------------------------------------------------------------------------------
+
+bool ACAN_ESP32::addTransmitCompleteRoutine (TransmitCompleteRoutine inRoutine, void * inContext) {
+  return addRoutine (mTransmitCompleteRoutines, mTransmitCompleteContexts, inRoutine, inContext) ;
+}
+
+//------------------------------------------------------------------------------
+
+void ACAN_ESP32::removeTransmitCompleteRoutine (TransmitCompleteRoutine inRoutine, void * inContext) {
+  removeRoutine (mTransmitCompleteRoutines, mTransmitCompleteContexts, inRoutine, inContext) ;
+}
+
+//------------------------------------------------------------------------------
+
+bool ACAN_ESP32::subscribeTransmit (ACAN_ESP32_Subscription & inSubscription) {
+  const bool ok = inSubscription.mIdentifier < kSubscribableIdentifierCount ;
+  if (ok) {
+    portENTER_CRITICAL (&portMux) ;
+      mTransmitSubscriptions [inSubscription.mIdentifier] = & inSubscription ;
+    portEXIT_CRITICAL (&portMux) ;
+  }
+  return ok ;
+}
+
+//------------------------------------------------------------------------------
+
+void ACAN_ESP32::unsubscribeTransmit (const ACAN_ESP32_Subscription & inSubscription) {
+  if (inSubscription.mIdentifier < kSubscribableIdentifierCount) {
+    portENTER_CRITICAL (&portMux) ;
+      if (mTransmitSubscriptions [inSubscription.mIdentifier] == & inSubscription) {
+        mTransmitSubscriptions [inSubscription.mIdentifier] = nullptr ;
+      }
+    portEXIT_CRITICAL (&portMux) ;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Called from the TX interrupt, inside the critical section
+
+void ACAN_ESP32::notifyTransmitComplete (void) {
+  mTransmittingFrame.timestamp = uint32_t (esp_timer_get_time ()) ;
+  mTransmitCompleteCount = mTransmitCompleteCount + 1 ;
+  if (!mTransmittingFrame.ext && (mTransmittingFrame.id < kSubscribableIdentifierCount)) {
+    ACAN_ESP32_Subscription * subscription = mTransmitSubscriptions [mTransmittingFrame.id] ;
+    if (subscription != nullptr) {
+      subscription->publish (mTransmittingFrame) ;
+    }
+  }
+  for (uint8_t i=0 ; i<kFrameRoutineCount ; i++) {
+    if (mTransmitCompleteRoutines [i] != nullptr) {
+      mTransmitCompleteRoutines [i] (mTransmittingFrame, mTransmitCompleteContexts [i]) ;
+    }
+  }
 }
 
 //------------------------------------------------------------------------------
 
 void ACAN_ESP32::getReceivedMessage (CANMessage & outFrame) {
+//--- Stamp the frame as soon as it is read out of the hardware FIFO
+  outFrame.timestamp = uint32_t (esp_timer_get_time ()) ;
   const uint32_t frameInfo = TWAI_FRAME_INFO () ;
 
   outFrame.len = frameInfo & 0xF;
@@ -424,24 +682,185 @@ void ACAN_ESP32::getReceivedMessage (CANMessage & outFrame) {
 //   TRANSMISSION
 //------------------------------------------------------------------------------
 
-bool ACAN_ESP32::tryToSend (const CANMessage & inMessage) {
-  bool sendMessage ;
-//--- Bug fixed in 1.0.2 (thanks to DirkMeintjies)
-  portENTER_CRITICAL (&portMux) ;
-    if (mDriverIsSending) {
-      sendMessage = mDriverTransmitBuffer.append (inMessage);
+bool ACAN_ESP32::tryToSend (const CANMessage & inMessage,
+                            const TransmitPriority inPriority) {
+//--- The queued copy carries its enqueue time, for the queueing delay
+  CANMessage frame = inMessage ;
+  frame.timestamp = uint32_t (esp_timer_get_time ()) ;
+//--- Lock-free: each class has a single producer task, and only the TX
+//    token holder removes frames (see startTransmissionIfIdle)
+  const bool sendMessage = mDriverTransmitBuffer [inPriority].append (frame) ;
+  if (sendMessage) {
+    startTransmissionIfIdle () ;
+  }
+  return sendMessage ;
+}
+
+//------------------------------------------------------------------------------
+
+uint32_t ACAN_ESP32::tryToSendBurst (const CANMessage inMessages [],
+                                     const uint32_t inCount,
+                                     const TransmitPriority inPriority) {
+  const uint32_t now = uint32_t (esp_timer_get_time ()) ;
+  ACAN_ESP32_Buffer16 & buffer = mDriverTransmitBuffer [inPriority] ;
+  uint32_t accepted = 0 ;
+  bool ok = true ;
+  while (ok && (accepted < inCount)) {
+    CANMessage frame = inMessages [accepted] ;
+    frame.timestamp = now ;
+    ok = buffer.append (frame) ;
+    if (ok) {
+      accepted += 1 ;
+    }
+  }
+  if (accepted > 0) {
+    startTransmissionIfIdle () ;
+  }
+  return accepted ;
+}
+
+//------------------------------------------------------------------------------
+// Take the TX token if the controller is idle and load the next frame.
+// Lock-free: holding the token makes the caller the only consumer of the
+// transmit buffers, and trims are left to the holder (transmitNextFrame).
+// The lock is only taken while transmission is suspended.
+
+void ACAN_ESP32::startTransmissionIfIdle (void) {
+  bool idle = false ;
+  if (mDriverIsSending.compare_exchange_strong (idle, true)) {
+    transmitNextFrame () ;
+  //--- A frame loaded just as suspendTransmission () looked for one to
+  //    reclaim may have gone to a controller in reset mode
+    if (mTransmitSuspended.load ()) {
+      portENTER_CRITICAL (&portMux) ;
+        reclaimTransmitToken () ;
+      portEXIT_CRITICAL (&portMux) ;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Called with the TX token: trim if asked, then load the next frame (the
+// token passes to it, and the TX interrupt takes it back), or release the
+// token.
+
+void ACAN_ESP32::transmitNextFrame (void) {
+  bool holding = true ;
+  while (holding) {
+    if (mTrimRequested.exchange (false)) {
+      mTransmitDiscardCount += mDriverTransmitBuffer [control].removeSuperseded () ;
+    }
+    CANMessage message ;
+    if (!mTransmitSuspended.load () && removeNextTransmitFrame (message)) {
+      internalSendMessage (message) ;
+      holding = false ;
     }else{
-      internalSendMessage (inMessage) ;
-      mDriverIsSending = true ;
-      sendMessage = true ;
+      mDriverIsSending.store (false) ;
+    //--- A frame appended, or a trim requested, after we looked may have
+    //    found the token still set: pick it up here
+      std::atomic_thread_fence (std::memory_order_seq_cst) ;
+      const bool work = mTrimRequested.load ()
+                     || (!mTransmitSuspended.load () && !transmitBuffersEmpty ()) ;
+      bool idle = false ;
+      holding = work && mDriverIsSending.compare_exchange_strong (idle, true) ;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+//   Transmit backlog around a bus-off
+//------------------------------------------------------------------------------
+
+uint32_t ACAN_ESP32::suspendTransmission (void) {
+  mTransmitSuspended.store (true) ;
+  portENTER_CRITICAL (&portMux) ;
+    reclaimTransmitToken () ;
+  portEXIT_CRITICAL (&portMux) ;
+  return discardSupersededFrames () ;
+}
+
+//------------------------------------------------------------------------------
+
+uint32_t ACAN_ESP32::resumeTransmission (void) {
+  mTransmitSuspended.store (false) ;
+//--- Trims, then loads the first frame
+  return discardSupersededFrames () ;
+}
+
+//------------------------------------------------------------------------------
+// The trim is done by whoever holds the TX token: this call if the
+// controller is idle, else the TX interrupt before it loads the next frame.
+
+uint32_t ACAN_ESP32::discardSupersededFrames (void) {
+  const uint32_t before = mTransmitDiscardCount ;
+  mTrimRequested.store (true) ;
+  startTransmissionIfIdle () ;
+  return mTransmitDiscardCount - before ;
+}
+
+//------------------------------------------------------------------------------
+// Inside the critical section, while suspended. In reset mode the frame in
+// the controller is gone, and so is its TX interrupt: take its token back.
+
+void ACAN_ESP32::reclaimTransmitToken (void) {
+  if (((TWAI_MODE_REG () & TWAI_RESET_MODE) != 0) && mTransmittingFrameValid.exchange (false)) {
+    mDriverIsSending.store (false) ;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Oldest frame of the highest non-empty class; only the token holder calls it.
+
+bool ACAN_ESP32::removeNextTransmitFrame (CANMessage & outFrame) {
+  for (uint8_t i=0 ; i<kTransmitPriorityCount ; i++) {
+    if (mDriverTransmitBuffer [i].remove (outFrame)) {
+      const uint32_t delay = uint32_t (esp_timer_get_time ()) - outFrame.timestamp ;
+      mTransmitFrameCount [i] = mTransmitFrameCount [i] + 1 ;
+      mTransmitDelaySum [i] = mTransmitDelaySum [i] + delay ;
+      if (mTransmitDelayMax [i] < delay) {
+        mTransmitDelayMax [i] = delay ;
+      }
+      return true ;
+    }
+  }
+  return false ;
+}
+
+//------------------------------------------------------------------------------
+
+bool ACAN_ESP32::transmitBuffersEmpty (void) const {
+  bool empty = true ;
+  for (uint8_t i=0 ; (i<kTransmitPriorityCount) && empty ; i++) {
+    empty = mDriverTransmitBuffer [i].count () == 0 ;
+  }
+  return empty ;
+}
+
+//------------------------------------------------------------------------------
+
+uint32_t ACAN_ESP32::transmitQueueDelayAverage (const TransmitPriority inPriority) const {
+  const uint32_t count = mTransmitFrameCount [inPriority] ;
+  return (count > 0) ? (mTransmitDelaySum [inPriority] / count) : 0 ;
+}
+
+//------------------------------------------------------------------------------
+
+void ACAN_ESP32::resetTransmitStatistics (void) {
+  portENTER_CRITICAL (&portMux) ;
+    for (uint8_t i=0 ; i<kTransmitPriorityCount ; i++) {
+      mTransmitFrameCount [i] = 0 ;
+      mTransmitDelaySum [i] = 0 ;
+      mTransmitDelayMax [i] = 0 ;
     }
   portEXIT_CRITICAL (&portMux) ;
-  return sendMessage ;
 }
 
 //------------------------------------------------------------------------------
 
 void ACAN_ESP32::internalSendMessage (const CANMessage & inFrame) {
+//--- Keep it for the completion report
+  mTransmittingFrame = inFrame ;
+  mTransmittingFrameValid = true ;
 //--- DLC
   const uint8_t dlc = (inFrame.len <= 8) ? inFrame.len : 8 ;
 //--- RTR
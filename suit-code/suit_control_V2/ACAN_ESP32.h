@@ -10,6 +10,7 @@
 #include <ACAN_ESP32_CANMessage.h>
 #include <ACAN_ESP32_Buffer16.h>
 #include <ACAN_ESP32_AcceptanceFilters.h>
+#include <ACAN_ESP32_Subscription.h>
 
 //------------------------------------------------------------------------------
 //   ESP32 CAN class
@@ -60,6 +61,8 @@ class ACAN_ESP32 {
   private: void setRequestedCANMode (const ACAN_ESP32_Settings &inSettings,
                                      const ACAN_ESP32_Filter & inFilter) ;
   private: void setAcceptanceFilter (const ACAN_ESP32_Filter & inFilter) ;
+  private: static bool initBuffer (ACAN_ESP32_Buffer16 & ioBuffer, CANMessage * inStorage,
+                                   const uint16_t inSize) ;
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
   //    Receiving messages
@@ -67,6 +70,15 @@ class ACAN_ESP32 {
 
   public: bool available (void) const ;
   public: bool receive (CANMessage & outMessage) ;
+
+  //--- Batch reception: copy up to inMaxCount frames, returns how many
+  public: uint32_t receive (CANMessage outMessages [], const uint32_t inMaxCount) ;
+
+  //--- Drain: call inRoutine on every pending frame (in place, no copy),
+  //    returns the number of frames handled
+  public: typedef void (*DrainRoutine) (const CANMessage & inMessage, void * inContext) ;
+  public: uint32_t drain (ACANCallBackRoutine inRoutine) ;
+  public: uint32_t drain (DrainRoutine inRoutine, void * inContext) ;
   public: void getReceivedMessage (CANMessage & outFrame) ;
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -83,25 +95,140 @@ class ACAN_ESP32 {
 
   public: inline void resetDriverReceiveBufferPeakCount (void) { mDriverReceiveBuffer.resetPeakCount () ; }
 
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+  //    Per-identifier subscriptions: a standard frame whose identifier has a
+  //    subscriber is written by the RX interrupt straight into that slot and
+  //    bypasses the driver receive buffer
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  public: static const uint32_t kSubscribableIdentifierCount = 32 ;
+
+  public: bool subscribe (ACAN_ESP32_Subscription & inSubscription) ;
+  public: void unsubscribe (const ACAN_ESP32_Subscription & inSubscription) ;
+
+  private: ACAN_ESP32_Subscription * mSubscriptions [kSubscribableIdentifierCount] ;
+
+  //--- Receive routines: called by the RX interrupt with every accepted frame,
+  //    before it goes to its slot or to the receive buffer. Same rules as the
+  //    transmit complete routines below (interrupt context, keep them short).
+  //    Up to kFrameRoutineCount of each kind; add returns false when full.
+  public: typedef void (*ReceiveRoutine) (const CANMessage & inFrame, void * inContext) ;
+  public: static const uint8_t kFrameRoutineCount = 4 ;
+
+  public: bool addReceiveRoutine (ReceiveRoutine inRoutine, void * inContext) ;
+  public: void removeReceiveRoutine (ReceiveRoutine inRoutine, void * inContext) ;
+
+  private: ReceiveRoutine mReceiveRoutines [kFrameRoutineCount] ;
+  private: void * mReceiveContexts [kFrameRoutineCount] ;
+
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
   //    Transmitting messages
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  public: bool tryToSend (const CANMessage & inMessage) ;
+  //--- Transmit priority classes, highest first. Each class has its own
+  //    queue; the TX path always loads the oldest frame of the highest
+  //    non-empty class, so a control frame waits at most for the frame
+  //    already in the controller, never behind queued lower-class traffic.
+  public: typedef enum : uint8_t { control, normal, background } TransmitPriority ;
+  public: static const uint8_t kTransmitPriorityCount = 3 ;
+
+  public: bool tryToSend (const CANMessage & inMessage,
+                          const TransmitPriority inPriority = normal) ;
+
+  //--- Enqueue several frames in one go, so they leave back-to-back;
+  //    returns the number of frames accepted (in order)
+  public: uint32_t tryToSendBurst (const CANMessage inMessages [],
+                                   const uint32_t inCount,
+                                   const TransmitPriority inPriority = normal) ;
   private: void internalSendMessage (const CANMessage & inFrame) ;
+  private: void startTransmissionIfIdle (void) ;
+  private: void transmitNextFrame (void) ;
+  private: bool removeNextTransmitFrame (CANMessage & outFrame) ;
+  private: bool transmitBuffersEmpty (void) const ;
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-  //    Transmit buffer
+  //    Transmit buffers (one per priority class)
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  private: ACAN_ESP32_Buffer16 mDriverTransmitBuffer ;
-  private: bool mDriverIsSending ;
+  private: ACAN_ESP32_Buffer16 mDriverTransmitBuffer [kTransmitPriorityCount] ;
+  //--- Token for the TX path: whoever sets it (task when the controller is
+  //    idle, ISR while frames are in flight) is the transmit buffer consumer,
+  //    and the only one that trims
+  private: std::atomic <bool> mDriverIsSending ;
+  //--- Set while the controller is bus-off: frames are queued, not loaded
+  private: std::atomic <bool> mTransmitSuspended ;
+  //--- Trim asked for by discardSupersededFrames, done by the token holder
+  private: std::atomic <bool> mTrimRequested ;
+  private: std::atomic <uint32_t> mTransmitDiscardCount ;
 
-  public: inline uint16_t driverTransmitBufferSize (void) const { return mDriverTransmitBuffer.size () ; }
-  public: inline uint16_t driverTransmitBufferCount (void) const { return mDriverTransmitBuffer.count () ; }
-  public: inline uint16_t driverTransmitBufferPeakCount (void) const { return mDriverTransmitBuffer.peakCount () ; }
+  public: inline uint16_t driverTransmitBufferSize (const TransmitPriority inPriority = normal) const {
+    return mDriverTransmitBuffer [inPriority].size () ;
+  }
+  public: inline uint16_t driverTransmitBufferCount (const TransmitPriority inPriority = normal) const {
+    return mDriverTransmitBuffer [inPriority].count () ;
+  }
+  public: inline uint16_t driverTransmitBufferPeakCount (const TransmitPriority inPriority = normal) const {
+    return mDriverTransmitBuffer [inPriority].peakCount () ;
+  }
 
-  public: inline void resetDriverTransmitBufferPeakCount (void) { mDriverTransmitBuffer.resetPeakCount () ; }
+  public: inline void resetDriverTransmitBufferPeakCount (const TransmitPriority inPriority = normal) {
+    mDriverTransmitBuffer [inPriority].resetPeakCount () ;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+  //    Transmit queueing delay, per priority class: time (µs) from
+  //    tryToSend to the frame being loaded into the controller
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  private: volatile uint32_t mTransmitFrameCount [kTransmitPriorityCount] ;
+  private: volatile uint32_t mTransmitDelaySum [kTransmitPriorityCount] ; // µs
+  private: volatile uint32_t mTransmitDelayMax [kTransmitPriorityCount] ; // µs
+
+  public: inline uint32_t transmitFrameCount (const TransmitPriority inPriority) const {
+    return mTransmitFrameCount [inPriority] ;
+  }
+  public: inline uint32_t transmitQueueDelayMax (const TransmitPriority inPriority) const {
+    return mTransmitDelayMax [inPriority] ;
+  }
+  public: uint32_t transmitQueueDelayAverage (const TransmitPriority inPriority) const ;
+
+  public: void resetTransmitStatistics (void) ;
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+  //    Transmit completion: once a frame has left the controller, the TX
+  //    interrupt stamps it with the completion time (CANMessage::timestamp, µs)
+  //    and
+  //      - writes it into the transmit subscription of its identifier, if any
+  //        (the slot's count () is then the number of frames delivered);
+  //      - passes it to every transmit complete routine. The routines run
+  //        in the interrupt, inside the driver critical section: keep them
+  //        short, and in IRAM.
+  //    Aborted frames are not reported.
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  public: typedef void (*TransmitCompleteRoutine) (const CANMessage & inFrame, void * inContext) ;
+
+  public: bool addTransmitCompleteRoutine (TransmitCompleteRoutine inRoutine, void * inContext) ;
+  public: void removeTransmitCompleteRoutine (TransmitCompleteRoutine inRoutine, void * inContext) ;
+  public: bool subscribeTransmit (ACAN_ESP32_Subscription & inSubscription) ;
+  public: void unsubscribeTransmit (const ACAN_ESP32_Subscription & inSubscription) ;
+
+  public: inline uint32_t transmitCompleteCount (void) const { return mTransmitCompleteCount ; }
+
+  private: void notifyTransmitComplete (void) ;
+
+  private: ACAN_ESP32_Subscription * mTransmitSubscriptions [kSubscribableIdentifierCount] ;
+  private: TransmitCompleteRoutine mTransmitCompleteRoutines [kFrameRoutineCount] ;
+  private: void * mTransmitCompleteContexts [kFrameRoutineCount] ;
+
+  private: static bool addRoutine (ReceiveRoutine ioRoutines [], void * ioContexts [],
+                                   ReceiveRoutine inRoutine, void * inContext) ;
+  private: static void removeRoutine (ReceiveRoutine ioRoutines [], void * ioContexts [],
+                                      ReceiveRoutine inRoutine, void * inContext) ;
+  //--- Frame loaded in the controller; written by the TX token holder
+  private: CANMessage mTransmittingFrame ;
+  private: std::atomic <bool> mTransmittingFrameValid ;
+  private: volatile uint32_t mTransmitCompleteCount ;
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
   //    Error codes returned by begin
@@ -124,6 +251,26 @@ class ACAN_ESP32 {
   public: void handleTXInterrupt (void) ;
   public: void handleRXInterrupt (void) ;
 
+  //--- The ISR empties the whole hardware RX FIFO (bounded by
+  //    kMaxFramesPerInterrupt) and handles TX completion in the same pass
+  public: static const uint32_t kMaxFramesPerInterrupt = 64 ;
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+  //    Interrupt statistics
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  private: volatile uint32_t mInterruptCount ;
+  private: volatile uint32_t mInterruptReceivedFrameCount ;
+  private: volatile uint32_t mMaxFramesPerInterrupt ;
+  private: volatile uint32_t mHardwareOverrunCount ;
+
+  public: inline uint32_t interruptCount (void) const { return mInterruptCount ; }
+  public: inline uint32_t interruptReceivedFrameCount (void) const { return mInterruptReceivedFrameCount ; }
+  public: inline uint32_t maxFramesPerInterrupt (void) const { return mMaxFramesPerInterrupt ; }
+  public: inline uint32_t hardwareOverrunCount (void) const { return mHardwareOverrunCount ; }
+
+  public: void resetInterruptStatistics (void) ;
+
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
   // STATUS FLAGS
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -142,6 +289,31 @@ class ACAN_ESP32 {
 
   public: bool recoverFromBusOff (void) const ;
 
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+  //    Transmit backlog around a bus-off. Entering bus-off puts the controller
+  //    in reset mode: the frame it was sending is lost without a TX interrupt,
+  //    so the TX token would never come back.
+  //      - suspendTransmission: stop loading frames; if the controller is in
+  //        reset mode, forget the lost frame and release the token;
+  //      - resumeTransmission: once bus-on, start loading frames again;
+  //      - discardSupersededFrames: drop every queued control frame that has a
+  //        newer one with the same identifier behind it (identifiers < 32),
+  //        so only the latest command per motor goes out. The TX token holder
+  //        does it: this call when the controller is idle, otherwise the TX
+  //        interrupt before it loads the next frame.
+  //    Each returns the number of control frames dropped by the time it
+  //    returns; transmitDiscardCount also counts those the TX interrupt drops.
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  public: uint32_t suspendTransmission (void) ;
+  public: uint32_t resumeTransmission (void) ;
+  public: uint32_t discardSupersededFrames (void) ;
+
+  public: inline bool transmissionSuspended (void) const { return mTransmitSuspended ; }
+  public: inline uint32_t transmitDiscardCount (void) const { return mTransmitDiscardCount ; }
+
+  private: void reclaimTransmitToken (void) ;
+
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
   //    No Copy
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -163,132 +335,148 @@ class ACAN_ESP32 {
   //    Register Access
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  public: inline volatile uint32_t & TWAI_MODE_REG (void) const {
-    return * ((volatile uint32_t *) (twaiBaseAddress + 0x000)) ;
+  //--- On a host build (no ARDUINO) the registers are those of the emulated
+  //    controller in host/ACAN_ESP32_EmulatedTWAI
+  #ifdef ARDUINO
+    public: typedef volatile uint32_t & Register ;
+    private: inline Register registerAt (const uint32_t inOffset) const {
+      return * ((volatile uint32_t *) (twaiBaseAddress + inOffset)) ;
+    }
+  #else
+    public: typedef ACAN_ESP32_EmulatedRegister Register ;
+    private: inline Register registerAt (const uint32_t inOffset) const {
+      return Register (twaiBaseAddress + inOffset) ;
+    }
+  #endif
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  public: inline Register TWAI_MODE_REG (void) const {
+    return registerAt (0x000) ;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  public: inline volatile uint32_t & TWAI_CMD_REG (void) const {
-    return * ((volatile uint32_t *) (twaiBaseAddress + 0x004)) ;
+  public: inline Register TWAI_CMD_REG (void) const {
+    return registerAt (0x004) ;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  public: inline volatile uint32_t & TWAI_STATUS_REG (void) const {
-    return * ((volatile uint32_t *) (twaiBaseAddress + 0x008)) ;
+  public: inline Register TWAI_STATUS_REG (void) const {
+    return registerAt (0x008) ;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  public: inline volatile uint32_t & TWAI_INT_RAW_REG (void) const {
-    return * ((volatile uint32_t *) (twaiBaseAddress + 0x00C)) ;
+  public: inline Register TWAI_INT_RAW_REG (void) const {
+    return registerAt (0x00C) ;
   }
 
-  public: inline volatile uint32_t & TWAI_INT_ENA_REG (void) const {
-    return * ((volatile uint32_t *) (twaiBaseAddress + 0x010)) ;
+  public: inline Register TWAI_INT_ENA_REG (void) const {
+    return registerAt (0x010) ;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  public: inline volatile uint32_t & TWAI_BUS_TIMING_0_REG (void) const {
-    return * ((volatile uint32_t *) (twaiBaseAddress + 0x018)) ;
+  public: inline Register TWAI_BUS_TIMING_0_REG (void) const {
+    return registerAt (0x018) ;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  public: inline volatile uint32_t & TWAI_BUS_TIMING_1_REG (void) const {
-    return * ((volatile uint32_t *) (twaiBaseAddress + 0x01C)) ;
+  public: inline Register TWAI_BUS_TIMING_1_REG (void) const {
+    return registerAt (0x01C) ;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  public: inline volatile uint32_t & TWAI_ARB_LOST_CAP_REG (void) const {
-    return * ((volatile uint32_t *) (twaiBaseAddress + 0x02C)) ;
+  public: inline Register TWAI_ARB_LOST_CAP_REG (void) const {
+    return registerAt (0x02C) ;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  public: inline volatile uint32_t & TWAI_ERR_CODE_CAP_REG (void) const {
-    return * ((volatile uint32_t *) (twaiBaseAddress + 0x030)) ;
+  public: inline Register TWAI_ERR_CODE_CAP_REG (void) const {
+    return registerAt (0x030) ;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  public: inline volatile uint32_t & TWAI_ERR_WARNING_LIMIT_REG (void) const {
-    return * ((volatile uint32_t *) (twaiBaseAddress + 0x034)) ;
+  public: inline Register TWAI_ERR_WARNING_LIMIT_REG (void) const {
+    return registerAt (0x034) ;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  public: inline volatile uint32_t & TWAI_RX_ERR_CNT_REG (void) const {
-    return * ((volatile uint32_t *) (twaiBaseAddress + 0x038)) ;
+  public: inline Register TWAI_RX_ERR_CNT_REG (void) const {
+    return registerAt (0x038) ;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  public: inline volatile uint32_t & TWAI_TX_ERR_CNT_REG (void) const {
-    return * ((volatile uint32_t *) (twaiBaseAddress + 0x03C)) ;
+  public: inline Register TWAI_TX_ERR_CNT_REG (void) const {
+    return registerAt (0x03C) ;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  public: inline volatile uint32_t & TWAI_FRAME_INFO (void) const {
-    return * ((volatile uint32_t *) (twaiBaseAddress + 0x040)) ;
+  public: inline Register TWAI_FRAME_INFO (void) const {
+    return registerAt (0x040) ;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   //----- SFF : Standard Frame Format - array size: 2
-  public: inline volatile uint32_t & TWAI_ID_SFF (const uint32_t inIndex) const {
-    return * ((volatile uint32_t *) (twaiBaseAddress + 0x044 + 4 * inIndex)) ;
+  public: inline Register TWAI_ID_SFF (const uint32_t inIndex) const {
+    return registerAt (0x044 + 4 * inIndex) ;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   //----- EFF : Extended Frame Format - array size: 4
-  public: inline volatile uint32_t & TWAI_ID_EFF (const uint32_t inIndex) const {
-    return * ((volatile uint32_t *)(twaiBaseAddress + 0x044 + 4 * inIndex)) ;
+  public: inline Register TWAI_ID_EFF (const uint32_t inIndex) const {
+    return registerAt (0x044 + 4 * inIndex) ;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   //----- DATA array size: 8
-  public: inline volatile uint32_t & TWAI_DATA_SFF (const uint32_t inIndex) const {
-    return * ((volatile uint32_t *) (twaiBaseAddress + 0x04C + 4 * inIndex)) ;
+  public: inline Register TWAI_DATA_SFF (const uint32_t inIndex) const {
+    return registerAt (0x04C + 4 * inIndex) ;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   //----- DATA array size: 8
-  public: inline volatile uint32_t & TWAI_DATA_EFF (const uint32_t inIndex) const {
-    return * ((volatile uint32_t *) (twaiBaseAddress + 0x054 + 4 * inIndex)) ;
+  public: inline Register TWAI_DATA_EFF (const uint32_t inIndex) const {
+    return registerAt (0x054 + 4 * inIndex) ;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
   // CAN Acceptance Filter Registers
   //----- CODE array size: 4
-  public: inline volatile uint32_t & TWAI_ACC_CODE_FILTER (const uint32_t inIndex) const {
-    return * ((volatile uint32_t *) (twaiBaseAddress + 0x040 + 4 * inIndex)) ;
+  public: inline Register TWAI_ACC_CODE_FILTER (const uint32_t inIndex) const {
+    return registerAt (0x040 + 4 * inIndex) ;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   //----- MASK array size: 4
-  public: inline volatile uint32_t & TWAI_ACC_MASK_FILTER (const uint32_t inIndex) const {
-    return * ((volatile uint32_t *) (twaiBaseAddress + 0x050 + 4 * inIndex)) ;
+  public: inline Register TWAI_ACC_MASK_FILTER (const uint32_t inIndex) const {
+    return registerAt (0x050 + 4 * inIndex) ;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  public: inline volatile uint32_t & TWAI_RX_MESSAGE_COUNTER_REG (void) const {
-    return * ((volatile uint32_t *) (twaiBaseAddress + 0x074)) ;
+  public: inline Register TWAI_RX_MESSAGE_COUNTER_REG (void) const {
+    return registerAt (0x074) ;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  public: inline volatile uint32_t & TWAI_CLOCK_DIVIDER_REG (void) const {
-    return * ((volatile uint32_t *) (twaiBaseAddress + 0x07C)) ;
+  public: inline Register TWAI_CLOCK_DIVIDER_REG (void) const {
+    return registerAt (0x07C) ;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -343,8 +531,9 @@ static const uint32_t TWAI_BUS_ERR_INT_ST     = 0x80;
 // TWAI_INT_ENA_REG bit definitions
 //------------------------------------------------------------------------------
 
-static const uint32_t TWAI_RX_INT_ENA = 0x01 ;
-static const uint32_t TWAI_TX_INT_ENA = 0x02 ;
+static const uint32_t TWAI_RX_INT_ENA      = 0x01 ;
+static const uint32_t TWAI_TX_INT_ENA      = 0x02 ;
+static const uint32_t TWAI_OVERRUN_INT_ENA = 0x08 ;
 
 //------------------------------------------------------------------------------
 // TWAI_FRAME_INFO bit definitions
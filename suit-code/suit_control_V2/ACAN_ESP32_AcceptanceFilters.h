@@ -2,7 +2,11 @@
 
 //----------------------------------------------------------------------------------------
 
-#include <Arduino.h>
+#ifdef ARDUINO
+  #include <Arduino.h>
+#else
+  #include <stdint.h>
+#endif
 
 //----------------------------------------------------------------------------------------
 
@@ -5,7 +5,18 @@
 //----------------------------------------------------------------------------------------
 
 #include <ACAN_ESP32_CANMessage.h>
+#include <atomic>
 
+//----------------------------------------------------------------------------------------
+// Single-producer / single-consumer ring buffer.
+//   - capacity is a power of two, indexes are free-running and masked on access;
+//   - append is only called by the producer and remove by the consumer
+//     (receive buffer: ISR -> task, transmit buffer: task -> ISR), so neither
+//     side needs a critical section;
+//   - storage is either allocated by initWithSize, or supplied by the caller
+//     with initWithStorage (see ACAN_ESP32_BufferStorage.h), which never
+//     touches the heap;
+//   - header only, builds on any host with a C++11 <atomic>.
 //----------------------------------------------------------------------------------------
 
 class ACAN_ESP32_Buffer16 {
@@ -15,10 +26,12 @@ class ACAN_ESP32_Buffer16 {
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   public: ACAN_ESP32_Buffer16 (void)  :
-  mBuffer (NULL),
+  mBuffer (nullptr),
+  mOwnsBuffer (false),
   mSize (0),
+  mMask (0),
+  mWriteIndex (0),
   mReadIndex (0),
-  mCount (0),
   mPeakCount (0) {
   }
 
@@ -27,7 +40,7 @@ class ACAN_ESP32_Buffer16 {
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   public: ~ ACAN_ESP32_Buffer16 (void) {
-    delete [] mBuffer ;
+    releaseBuffer () ;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -35,91 +48,194 @@ class ACAN_ESP32_Buffer16 {
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   private: CANMessage * mBuffer ;
-  private: uint16_t mSize ;
-  private: uint16_t mReadIndex ;
-  private: uint16_t mCount ;
-  private: uint16_t mPeakCount ; // > mSize if overflow did occur
+  private: bool mOwnsBuffer ;                     // false: storage supplied by the caller
+  private: uint16_t mSize ;                       // Power of two
+  private: uint16_t mMask ;                       // mSize - 1
+  private: std::atomic <uint32_t> mWriteIndex ;   // Written by producer only
+  private: std::atomic <uint32_t> mReadIndex ;    // Written by consumer only
+  private: std::atomic <uint16_t> mPeakCount ;    // > mSize if overflow did occur
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
   // Accessors
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   public: inline uint16_t size (void) const { return mSize ; }
-  public: inline uint16_t count (void) const { return mCount ; }
-  public: inline uint16_t peakCount (void) const { return mPeakCount ; }
-  public: inline uint16_t didOverflow (void) const { return mPeakCount > mSize ; }
+  public: inline uint16_t count (void) const {
+    return uint16_t (mWriteIndex.load (std::memory_order_acquire) - mReadIndex.load (std::memory_order_acquire)) ;
+  }
+  public: inline uint16_t peakCount (void) const { return mPeakCount.load (std::memory_order_relaxed) ; }
+  public: inline uint16_t didOverflow (void) const { return peakCount () > mSize ; }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-  // initWithSize
+  // initWithSize: the requested size is rounded up to a power of two
+  // (not thread safe: call before producer and consumer are running)
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   public: bool initWithSize (const uint16_t inSize) {
-    delete [] mBuffer ;
-    mBuffer = new CANMessage [inSize] ;
-    const bool ok = mBuffer != NULL ;
+    uint32_t capacity = 1 ;
+    while (capacity < inSize) {
+      capacity <<= 1 ;
+    }
+    if (capacity > 0x8000) { // Keep peakCount () > size () representable
+      capacity = 0x8000 ;
+    }
+    releaseBuffer () ;
+    mBuffer = (inSize > 0) ? new CANMessage [capacity] : nullptr ;
+    mOwnsBuffer = true ;
+    const bool ok = mBuffer != nullptr ;
+    mSize = ok ? uint16_t (capacity) : 0 ;
+    mMask = ok ? uint16_t (capacity - 1) : 0 ;
+    mWriteIndex.store (0) ;
+    mReadIndex.store (0) ;
+    mPeakCount.store (0) ;
+    return ok || (inSize == 0) ;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+  // initWithStorage: use inStorage (inSize messages, a power of two) instead
+  // of allocating; the caller keeps it alive while the buffer uses it
+  // (not thread safe: call before producer and consumer are running)
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  public: bool initWithStorage (CANMessage inStorage [], const uint16_t inSize) {
+    const bool ok = (inStorage != nullptr) && (inSize > 0) && (inSize <= 0x8000)
+                 && ((inSize & (inSize - 1)) == 0) ;
+    releaseBuffer () ;
+    mBuffer = ok ? inStorage : nullptr ;
+    mOwnsBuffer = false ;
     mSize = ok ? inSize : 0 ;
-    mReadIndex = 0 ;
-    mCount = 0 ;
-    mPeakCount = 0 ;
+    mMask = ok ? uint16_t (inSize - 1) : 0 ;
+    mWriteIndex.store (0) ;
+    mReadIndex.store (0) ;
+    mPeakCount.store (0) ;
     return ok ;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-  // append
+  // append (producer side)
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   public: bool append (const CANMessage & inMessage) {
-    const bool ok = mCount < mSize ;
+    const uint32_t writeIndex = mWriteIndex.load (std::memory_order_relaxed) ;
+    const uint32_t readIndex = mReadIndex.load (std::memory_order_acquire) ;
+    const uint16_t currentCount = uint16_t (writeIndex - readIndex) ;
+    const bool ok = currentCount < mSize ;
     if (ok) {
-      uint16_t writeIndex = mReadIndex + mCount ;
-      if (writeIndex >= mSize) {
-        writeIndex -= mSize ;
-      }
-      mBuffer [writeIndex] = inMessage ;
-      mCount += 1 ;
-      if (mPeakCount < mCount) {
-        mPeakCount = mCount ;
+      mBuffer [writeIndex & mMask] = inMessage ;
+      mWriteIndex.store (writeIndex + 1, std::memory_order_release) ;
+      if (mPeakCount.load (std::memory_order_relaxed) < currentCount + 1) {
+        mPeakCount.store (currentCount + 1, std::memory_order_relaxed) ;
       }
     }else{
-      mPeakCount = mSize + 1 ; // Overflow
+      mPeakCount.store (mSize + 1, std::memory_order_relaxed) ; // Overflow
     }
     return ok ;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-  // Remove
+  // Remove (consumer side)
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   public: bool remove (CANMessage & outMessage) {
-    const bool ok = mCount > 0 ;
+    const uint32_t readIndex = mReadIndex.load (std::memory_order_relaxed) ;
+    const uint32_t writeIndex = mWriteIndex.load (std::memory_order_acquire) ;
+    const bool ok = readIndex != writeIndex ;
     if (ok) {
-      outMessage = mBuffer [mReadIndex] ;
-      mCount -= 1 ;
-      mReadIndex += 1 ;
-      if (mReadIndex == mSize) {
-        mReadIndex = 0 ;
-      }
+      outMessage = mBuffer [readIndex & mMask] ;
+      mReadIndex.store (readIndex + 1, std::memory_order_release) ;
     }
     return ok ;
   }
 
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+  // removeBatch (consumer side): copy up to inMaxCount messages, oldest first
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  public: uint16_t removeBatch (CANMessage outMessages [], const uint16_t inMaxCount) {
+    const uint32_t readIndex = mReadIndex.load (std::memory_order_relaxed) ;
+    const uint32_t writeIndex = mWriteIndex.load (std::memory_order_acquire) ;
+    uint16_t n = uint16_t (writeIndex - readIndex) ;
+    if (n > inMaxCount) {
+      n = inMaxCount ;
+    }
+    for (uint16_t i = 0 ; i < n ; i++) {
+      outMessages [i] = mBuffer [(readIndex + i) & mMask] ;
+    }
+    mReadIndex.store (readIndex + n, std::memory_order_release) ;
+    return n ;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+  // consumeAll (consumer side): pass every pending message, in place, to
+  // inFunction, then release the slots all at once
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  public: template <typename FUNCTION> uint16_t consumeAll (FUNCTION inFunction) {
+    const uint32_t readIndex = mReadIndex.load (std::memory_order_relaxed) ;
+    const uint32_t writeIndex = mWriteIndex.load (std::memory_order_acquire) ;
+    for (uint32_t i = readIndex ; i != writeIndex ; i++) {
+      inFunction (mBuffer [i & mMask]) ;
+    }
+    mReadIndex.store (writeIndex, std::memory_order_release) ;
+    return uint16_t (writeIndex - readIndex) ;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+  // removeSuperseded (consumer side): drop every pending standard frame with an
+  // identifier below 32 that has a newer frame with the same identifier behind
+  // it. The survivors keep their order: they are moved towards the newest end,
+  // in slots the consumer owns, and the read index skips the dropped ones, so
+  // the producer may keep appending meanwhile. Returns the number dropped.
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  public: uint16_t removeSuperseded (void) {
+    const uint32_t readIndex = mReadIndex.load (std::memory_order_relaxed) ;
+    const uint32_t writeIndex = mWriteIndex.load (std::memory_order_acquire) ;
+    uint32_t seen = 0 ; // Bit n: a newer frame with identifier n is kept
+    uint32_t keep = writeIndex ;
+    for (uint32_t i = writeIndex ; i != readIndex ; ) {
+      i -= 1 ;
+      const CANMessage & message = mBuffer [i & mMask] ;
+      const bool tracked = !message.ext && (message.id < 32) ;
+      const uint32_t bit = tracked ? (1UL << message.id) : 0 ;
+      if ((seen & bit) == 0) {
+        seen |= bit ;
+        keep -= 1 ;
+        if (keep != i) {
+          mBuffer [keep & mMask] = message ;
+        }
+      }
+    }
+    mReadIndex.store (keep, std::memory_order_release) ;
+    return uint16_t (keep - readIndex) ;
+  }
+
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
   // Free
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
   public: void free (void) {
-    delete [] mBuffer ; mBuffer = nullptr ;
+    releaseBuffer () ;
     mSize = 0 ;
-    mReadIndex = 0 ;
-    mCount = 0 ;
-    mPeakCount = 0 ;
+    mMask = 0 ;
+    mWriteIndex.store (0) ;
+    mReadIndex.store (0) ;
+    mPeakCount.store (0) ;
+  }
+
+  private: void releaseBuffer (void) {
+    if (mOwnsBuffer) {
+      delete [] mBuffer ;
+    }
+    mBuffer = nullptr ;
+    mOwnsBuffer = false ;
   }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
   // Reset Peak Count
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-  public: inline void resetPeakCount (void) { mPeakCount = mCount ; }
+  public: inline void resetPeakCount (void) { mPeakCount.store (count (), std::memory_order_relaxed) ; }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
   // No copy
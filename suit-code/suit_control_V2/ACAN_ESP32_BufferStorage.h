@@ -0,0 +1,25 @@
+//----------------------------------------------------------------------------------------
+
+#pragma once
+
+//----------------------------------------------------------------------------------------
+
+#include <ACAN_ESP32_Buffer16.h>
+
+//----------------------------------------------------------------------------------------
+// Compile-time sized storage for ACAN_ESP32_Buffer16.
+//   - ACAN_ESP32_BufferStorage <SIZE>: SIZE messages, no heap; declare it
+//     global or static and hand it to the driver through ACAN_ESP32_Settings
+//     (useStaticReceiveBuffer ...), begin () then allocates nothing.
+// SIZE must be a power of two (the ring masks its indexes), at most 0x8000.
+//----------------------------------------------------------------------------------------
+
+template <uint16_t SIZE> class ACAN_ESP32_BufferStorage {
+  static_assert (SIZE > 0 && (SIZE & (SIZE - 1)) == 0, "buffer size must be a power of two") ;
+  static_assert (SIZE <= 0x8000, "buffer size must be at most 0x8000") ;
+
+  public: static const uint16_t kSize = SIZE ;
+  public: CANMessage mMessages [SIZE] ;
+} ;
+
+//----------------------------------------------------------------------------------------
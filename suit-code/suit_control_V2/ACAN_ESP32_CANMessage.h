@@ -15,7 +15,11 @@
 
 //----------------------------------------------------------------------------------------
 
-#include <Arduino.h>
+#ifdef ARDUINO
+  #include <Arduino.h>
+#else
+  #include <stdint.h>
+#endif
 
 //----------------------------------------------------------------------------------------
 
@@ -25,6 +29,7 @@ class CANMessage {
   public : bool rtr = false ; // false -> data frame, true -> remote frame
   public : uint8_t idx = 0 ;  // This field is used by the driver
   public : uint8_t len = 0 ;  // Length of data (0 ... 8)
+  public : uint32_t timestamp = 0 ; // Reception time (us), set by the driver
   public : union {
     uint64_t data64        ; // Caution: subject to endianness
     int64_t  data_s64      ; // Caution: subject to endianness
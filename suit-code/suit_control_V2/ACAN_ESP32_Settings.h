@@ -7,6 +7,7 @@
 //----------------------------------------------------------------------------------------
 
 #include <stdint.h>
+#include <ACAN_ESP32_BufferStorage.h>
 
 //--- For getting getApbFrequency function declaration
 #ifdef ARDUINO
@@ -101,7 +102,40 @@ class ACAN_ESP32_Settings {
   //    Transmit buffer sizes
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-    public: uint16_t mDriverTransmitBufferSize = 16 ;
+    public: uint16_t mDriverTransmitBufferSize = 16 ;           // ACAN_ESP32::normal
+    public: uint16_t mDriverControlTransmitBufferSize = 16 ;    // ACAN_ESP32::control
+    public: uint16_t mDriverBackgroundTransmitBufferSize = 8 ;  // ACAN_ESP32::background
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+  //    Static buffer storage: when set, begin () uses it instead of allocating the
+  //    buffer (the size is then the storage size). Set with the use... functions,
+  //    which check at compile time that the size is a power of two.
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+    public: CANMessage * mDriverReceiveBufferStorage = nullptr ;
+    public: CANMessage * mDriverTransmitBufferStorage = nullptr ;
+    public: CANMessage * mDriverControlTransmitBufferStorage = nullptr ;
+    public: CANMessage * mDriverBackgroundTransmitBufferStorage = nullptr ;
+
+    public: template <uint16_t SIZE> void useStaticReceiveBuffer (ACAN_ESP32_BufferStorage <SIZE> & ioStorage) {
+      mDriverReceiveBufferStorage = ioStorage.mMessages ;
+      mDriverReceiveBufferSize = SIZE ;
+    }
+
+    public: template <uint16_t SIZE> void useStaticTransmitBuffer (ACAN_ESP32_BufferStorage <SIZE> & ioStorage) {
+      mDriverTransmitBufferStorage = ioStorage.mMessages ;
+      mDriverTransmitBufferSize = SIZE ;
+    }
+
+    public: template <uint16_t SIZE> void useStaticControlTransmitBuffer (ACAN_ESP32_BufferStorage <SIZE> & ioStorage) {
+      mDriverControlTransmitBufferStorage = ioStorage.mMessages ;
+      mDriverControlTransmitBufferSize = SIZE ;
+    }
+
+    public: template <uint16_t SIZE> void useStaticBackgroundTransmitBuffer (ACAN_ESP32_BufferStorage <SIZE> & ioStorage) {
+      mDriverBackgroundTransmitBufferStorage = ioStorage.mMessages ;
+      mDriverBackgroundTransmitBufferSize = SIZE ;
+    }
 
   // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
   //    Compute actual bit rate
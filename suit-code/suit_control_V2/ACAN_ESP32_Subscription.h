@@ -0,0 +1,86 @@
+//----------------------------------------------------------------------------------------
+
+#pragma once
+
+//----------------------------------------------------------------------------------------
+
+#include <ACAN_ESP32_CANMessage.h>
+#include <atomic>
+
+//----------------------------------------------------------------------------------------
+// Per-identifier slot, filled directly by the RX interrupt (or, for
+// subscribeTransmit, the TX interrupt).
+// Writer (ISR) and reader (task) are synchronised by a sequence lock:
+// mSequence is odd while the slot is being written, and advances by 2
+// for every delivered frame, so the reader never takes a lock.
+//----------------------------------------------------------------------------------------
+
+class ACAN_ESP32_Subscription {
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+  // Constructor
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  public: explicit ACAN_ESP32_Subscription (const uint32_t inIdentifier) :
+  mIdentifier (inIdentifier),
+  mSequence (0),
+  mFrame () {
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+  // Properties
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  public: const uint32_t mIdentifier ; // Standard identifier
+  private: std::atomic <uint32_t> mSequence ;
+  private: CANMessage mFrame ; // Carries its reception timestamp
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+  // publish: called from the RX interrupt only (single writer)
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  public: inline void publish (const CANMessage & inFrame) {
+    const uint32_t sequence = mSequence.load (std::memory_order_relaxed) ;
+    mSequence.store (sequence + 1, std::memory_order_relaxed) ;
+    std::atomic_thread_fence (std::memory_order_release) ;
+    mFrame = inFrame ;
+    mSequence.store (sequence + 2, std::memory_order_release) ;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+  // read: consistent snapshot of the latest frame; returns the number of frames
+  // delivered so far (0 if none yet, outFrame is then the default frame)
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  public: inline uint32_t read (CANMessage & outFrame) const {
+    uint32_t before ;
+    uint32_t after ;
+    do{
+      before = mSequence.load (std::memory_order_acquire) ;
+      outFrame = mFrame ;
+      std::atomic_thread_fence (std::memory_order_acquire) ;
+      after = mSequence.load (std::memory_order_relaxed) ;
+    }while ((before != after) || ((before & 1) != 0)) ;
+    return after >> 1 ;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+  // Number of frames delivered so far
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  public: inline uint32_t count (void) const {
+    return mSequence.load (std::memory_order_acquire) >> 1 ;
+  }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+  // No copy
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  private: ACAN_ESP32_Subscription (const ACAN_ESP32_Subscription &) = delete ;
+  private: ACAN_ESP32_Subscription & operator = (const ACAN_ESP32_Subscription &) = delete ;
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+} ;
+
+//----------------------------------------------------------------------------------------
@@ -23,12 +23,13 @@
 
 #include <stdint.h>
 
-#include <freertos/FreeRTOS.h>
-#include <freertos/queue.h>
-#include <esp_intr_alloc.h>
-#include <soc/gpio_sig_map.h>
-#include <soc/periph_defs.h>
-#include <soc/interrupts.h>
+#ifdef ARDUINO
+  #include <freertos/FreeRTOS.h>
+  #include <freertos/queue.h>
+  #include <esp_intr_alloc.h>
+  #include <soc/gpio_sig_map.h>
+  #include <soc/periph_defs.h>
+  #include <soc/interrupts.h>
 
 //------------------------------------------------------------------------------
 // In ESP32 2.x board managers, ETS_TWAI_INTR_SOURCE is an int constant.
@@ -40,12 +41,16 @@
 //------------------------------------------------------------------------------
 
 // esp32/hardware/esp32/3.3.0-alpha1/cores/esp32/esp_arduino_version.h
-#include <esp_arduino_version.h>
+  #include <esp_arduino_version.h>
 
-#if ESP_ARDUINO_VERSION < ESP_ARDUINO_VERSION_VAL(3, 0, 0)
-  typedef int periph_interrupt_t ;
-#elif ESP_ARDUINO_VERSION < ESP_ARDUINO_VERSION_VAL(3, 3, 0)
-  typedef periph_interrput_t periph_interrupt_t ;
+  #if ESP_ARDUINO_VERSION < ESP_ARDUINO_VERSION_VAL(3, 0, 0)
+    typedef int periph_interrupt_t ;
+  #elif ESP_ARDUINO_VERSION < ESP_ARDUINO_VERSION_VAL(3, 3, 0)
+    typedef periph_interrput_t periph_interrupt_t ;
+  #endif
+#else
+  //--- Host build: ESP-IDF services and TWAI registers are emulated (see host/)
+  #include <ACAN_ESP32_HostPlatform.h>
 #endif
 
 //------------------------------------------------------------------------------
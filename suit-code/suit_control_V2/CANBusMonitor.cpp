@@ -0,0 +1,216 @@
+#include "CANBusMonitor.h"
+
+// Nominal frame length: SOF, arbitration, control, CRC, ACK, EOF and
+// intermission around the data field, without stuff bits
+static const uint32_t STANDARD_FRAME_BITS = 47;
+static const uint32_t EXTENDED_FRAME_BITS = 67;
+
+// -------------------------------------------------------------
+// Construction
+// -------------------------------------------------------------
+CANBusMonitor::CANBusMonitor (ACAN_ESP32 &driver) : driver (driver) {
+}
+
+CANBusMonitor::~CANBusMonitor () {
+    end ();
+}
+
+// -------------------------------------------------------------
+// Start / stop
+// -------------------------------------------------------------
+bool CANBusMonitor::begin (uint32_t rate, uint32_t periodMs) {
+    if (isRunning () || rate == 0 || periodMs == 0) {
+        return false;
+    }
+    esp_timer_create_args_t args = {};
+    args.callback = timerCallback;
+    args.arg = this;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "can_monitor";
+    args.skip_unhandled_events = true;
+    if (esp_timer_create (&args, &timer) != ESP_OK) {
+        timer = nullptr;
+        return false;
+    }
+
+    portENTER_CRITICAL (&lock);
+    bitRate = rate;
+    windows[0] = Window ();
+    windows[1] = Window ();
+    filling = &windows[0];
+    for (uint16_t id = 0; id < MONITORED_ID_COUNT; ++id) {
+        rxClocks[id] = FlowClock ();
+        txClocks[id] = FlowClock ();
+    }
+    windowStart = uint64_t (esp_timer_get_time ());
+    health = CANBusHealth ();
+    for (uint16_t id = 0; id < MONITORED_ID_COUNT; ++id) {
+        rxFlows[id] = CANFlowStatistics ();
+        txFlows[id] = CANFlowStatistics ();
+    }
+    portEXIT_CRITICAL (&lock);
+    lastRxErrorCounter = uint8_t (uint32_t (driver.TWAI_RX_ERR_CNT_REG ()));
+    lastTxErrorCounter = uint8_t (uint32_t (driver.TWAI_TX_ERR_CNT_REG ()));
+
+    if (!driver.addReceiveRoutine (receiveRoutine, this) ||
+        !driver.addTransmitCompleteRoutine (transmitRoutine, this) ||
+        esp_timer_start_periodic (timer, uint64_t (periodMs) * 1000) != ESP_OK) {
+        end ();
+        return false;
+    }
+    return true;
+}
+
+void CANBusMonitor::end () {
+    if (timer != nullptr) {
+        esp_timer_stop (timer);
+        esp_timer_delete (timer);
+        timer = nullptr;
+        driver.removeReceiveRoutine (receiveRoutine, this);
+        driver.removeTransmitCompleteRoutine (transmitRoutine, this);
+    }
+}
+
+bool CANBusMonitor::isRunning () const {
+    return timer != nullptr;
+}
+
+// -------------------------------------------------------------
+// Interrupt side: count every frame the controller sees
+// -------------------------------------------------------------
+uint32_t IRAM_ATTR CANBusMonitor::frameBits (const CANMessage &frame) {
+    const uint32_t dataBits = frame.rtr ? 0 : 8 * ((frame.len > 8) ? 8 : frame.len);
+    return (frame.ext ? EXTENDED_FRAME_BITS : STANDARD_FRAME_BITS) + dataBits;
+}
+
+void IRAM_ATTR CANBusMonitor::receiveRoutine (const CANMessage &frame, void *monitor) {
+    static_cast<CANBusMonitor *>(monitor)->record (frame, false);
+}
+
+void IRAM_ATTR CANBusMonitor::transmitRoutine (const CANMessage &frame, void *monitor) {
+    static_cast<CANBusMonitor *>(monitor)->record (frame, true);
+}
+
+void IRAM_ATTR CANBusMonitor::record (const CANMessage &frame, bool transmitted) {
+    portENTER_CRITICAL_ISR (&lock);
+    Window &window = *filling;
+    window.bits += frameBits (frame);
+    if (transmitted) {
+        ++window.txFrames;
+    } else {
+        ++window.rxFrames;
+    }
+    if (!frame.ext && frame.id < MONITORED_ID_COUNT) {
+        Flow &flow = transmitted ? window.tx[frame.id] : window.rx[frame.id];
+        FlowClock &clock = transmitted ? txClocks[frame.id] : rxClocks[frame.id];
+        if (clock.seen) {
+            const uint32_t interval = frame.timestamp - clock.lastTime;
+            ++flow.intervals;
+            flow.intervalSum += interval;
+            if (interval < flow.minInterval) flow.minInterval = interval;
+            if (interval > flow.maxInterval) flow.maxInterval = interval;
+        }
+        clock.lastTime = frame.timestamp;
+        clock.seen = true;
+        ++flow.frames;
+    }
+    portEXIT_CRITICAL_ISR (&lock);
+}
+
+// -------------------------------------------------------------
+// Timer side: close the period and publish a snapshot
+// -------------------------------------------------------------
+void CANBusMonitor::timerCallback (void *monitor) {
+    static_cast<CANBusMonitor *>(monitor)->sample ();
+}
+
+void CANBusMonitor::closeFlow (const Flow &flow, uint32_t period, CANFlowStatistics &out) {
+    out.frameRate    = uint32_t (uint64_t (flow.frames) * 1'000'000ULL / period);
+    out.meanInterval = (flow.intervals > 0) ? flow.intervalSum / flow.intervals : 0;
+    out.jitter       = (flow.intervals > 0) ? flow.maxInterval - flow.minInterval : 0;
+}
+
+void CANBusMonitor::sample () {
+    // Controller state first; reading the capture registers re-arms them
+    const uint8_t  rxErrors        = uint8_t (uint32_t (driver.TWAI_RX_ERR_CNT_REG ()));
+    const uint8_t  txErrors        = uint8_t (uint32_t (driver.TWAI_TX_ERR_CNT_REG ()));
+    const uint8_t  errorCode       = uint8_t (uint32_t (driver.TWAI_ERR_CODE_CAP_REG ()));
+    const uint8_t  arbitrationLost = uint8_t (uint32_t (driver.TWAI_ARB_LOST_CAP_REG ()) & 0x1F);
+    const uint32_t statusFlags     = driver.statusFlags ();
+
+    // Only the swap under the lock: from here on the interrupt counts into
+    // the other window, and the closed one is ours until it is cleared
+    portENTER_CRITICAL (&lock);
+    Window &closed = *filling;
+    filling = (filling == &windows[0]) ? &windows[1] : &windows[0];
+    const uint64_t now = uint64_t (esp_timer_get_time ());
+    const uint32_t period = (now > windowStart) ? uint32_t (now - windowStart) : 1;
+    windowStart = now;
+    portEXIT_CRITICAL (&lock);
+
+    // Only this timer writes health, so it can be read here without the lock
+    CANBusHealth next = health;
+    next.samples     += 1;
+    next.sampleTime   = uint32_t (now);
+    next.period       = period;
+    next.busLoad      = uint16_t (uint64_t (closed.bits) * 1'000'000'000ULL /
+                                  (uint64_t (bitRate) * period));
+    next.rxFrameRate  = uint32_t (uint64_t (closed.rxFrames) * 1'000'000ULL / period);
+    next.txFrameRate  = uint32_t (uint64_t (closed.txFrames) * 1'000'000ULL / period);
+    if (next.busLoad > next.peakBusLoad) next.peakBusLoad = next.busLoad;
+    CANFlowStatistics rx[MONITORED_ID_COUNT];
+    CANFlowStatistics tx[MONITORED_ID_COUNT];
+    for (uint16_t id = 0; id < MONITORED_ID_COUNT; ++id) {
+        closeFlow (closed.rx[id], period, rx[id]);
+        closeFlow (closed.tx[id], period, tx[id]);
+    }
+    closed = Window ();
+
+    next.rxErrors        = rxErrors;
+    next.txErrors        = txErrors;
+    next.rxErrorTrend    = int16_t (rxErrors) - int16_t (lastRxErrorCounter);
+    next.txErrorTrend    = int16_t (txErrors) - int16_t (lastTxErrorCounter);
+    if (rxErrors > next.peakRxErrors) next.peakRxErrors = rxErrors;
+    if (txErrors > next.peakTxErrors) next.peakTxErrors = txErrors;
+    next.errorCode       = errorCode;
+    next.arbitrationLost = arbitrationLost;
+    next.statusFlags     = statusFlags;
+    next.rxBufferPeak    = driver.driverReceiveBufferPeakCount ();
+    for (uint8_t p = 0; p < ACAN_ESP32::kTransmitPriorityCount; ++p) {
+        next.txBufferPeak[p] = driver.driverTransmitBufferPeakCount (ACAN_ESP32::TransmitPriority (p));
+    }
+    next.hardwareOverruns = driver.hardwareOverrunCount ();
+
+    portENTER_CRITICAL (&lock);
+    health = next;
+    for (uint16_t id = 0; id < MONITORED_ID_COUNT; ++id) {
+        rxFlows[id] = rx[id];
+        txFlows[id] = tx[id];
+    }
+    portEXIT_CRITICAL (&lock);
+
+    lastRxErrorCounter = rxErrors;
+    lastTxErrorCounter = txErrors;
+}
+
+// -------------------------------------------------------------
+// Snapshots
+// -------------------------------------------------------------
+bool CANBusMonitor::getHealth (CANBusHealth &out) const {
+    portENTER_CRITICAL (&lock);
+    out = health;
+    portEXIT_CRITICAL (&lock);
+    return out.samples > 0;
+}
+
+bool CANBusMonitor::getFlowStatistics (uint16_t id, bool transmitted,
+                                       CANFlowStatistics &out) const {
+    if (id >= MONITORED_ID_COUNT) {
+        return false;
+    }
+    portENTER_CRITICAL (&lock);
+    out = transmitted ? txFlows[id] : rxFlows[id];
+    const bool sampled = health.samples > 0;
+    portEXIT_CRITICAL (&lock);
+    return sampled;
+}
@@ -0,0 +1,139 @@
+#include "CANBusRecovery.h"
+
+// Error passive above this (ISO 11898-1)
+static const uint32_t ERROR_PASSIVE_LIMIT = 127;
+
+// -------------------------------------------------------------
+// Construction
+// -------------------------------------------------------------
+CANBusRecovery::CANBusRecovery (ACAN_ESP32 &driver)
+    : driver (driver), discardBaseline (driver.transmitDiscardCount ()) {
+}
+
+CANBusRecovery::~CANBusRecovery () {
+    end ();
+}
+
+// -------------------------------------------------------------
+// Start / stop
+// -------------------------------------------------------------
+bool CANBusRecovery::begin (uint32_t pollIntervalUs, uint32_t retryTimeoutUs) {
+    if (isRunning () || pollIntervalUs == 0) {
+        return false;
+    }
+    esp_timer_create_args_t args = {};
+    args.callback = timerCallback;
+    args.arg = this;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "can_recovery";
+    args.skip_unhandled_events = true;
+    if (esp_timer_create (&args, &timer) != ESP_OK) {
+        timer = nullptr;
+        return false;
+    }
+    retryTimeout = retryTimeoutUs;
+    state = CAN_BUS_ERROR_ACTIVE;
+    if (esp_timer_start_periodic (timer, pollIntervalUs) != ESP_OK) {
+        esp_timer_delete (timer);
+        timer = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void CANBusRecovery::end () {
+    if (timer != nullptr) {
+        esp_timer_stop (timer);
+        esp_timer_delete (timer);
+        timer = nullptr;
+    }
+}
+
+bool CANBusRecovery::isRunning () const {
+    return timer != nullptr;
+}
+
+void CANBusRecovery::timerCallback (void *recovery) {
+    static_cast<CANBusRecovery *>(recovery)->poll ();
+}
+
+// -------------------------------------------------------------
+// State machine
+// -------------------------------------------------------------
+void CANBusRecovery::poll () {
+    const uint32_t now       = uint32_t (esp_timer_get_time ());
+    const bool     busOff    = (uint32_t (driver.TWAI_STATUS_REG ()) & TWAI_BUS_OFF_ST) != 0;
+    const bool     resetMode = (uint32_t (driver.TWAI_MODE_REG ()) & TWAI_RESET_MODE) != 0;
+
+    if (state == CAN_BUS_RECOVERING) {
+        if (!busOff && !resetMode) {
+            // Bus-on: only the newest command per motor goes out
+            driver.resumeTransmission ();
+            const uint32_t duration = now - busOffTime;
+            lastRecoveryTime = duration;
+            if (duration > maxRecoveryTime) {
+                maxRecoveryTime = duration;
+            }
+            recoveries = recoveries + 1;
+            state = CAN_BUS_ERROR_ACTIVE;
+            return;
+        }
+        driver.discardSupersededFrames ();
+        if (now - recoveryRequestTime >= retryTimeout && driver.recoverFromBusOff ()) {
+            recoveryRequestTime = now;
+            recoveryRetries = recoveryRetries + 1;
+        }
+        return;
+    }
+
+    if (busOff) {
+        busOffTime = now;
+        busOffCount = busOffCount + 1;
+        driver.suspendTransmission ();
+        driver.recoverFromBusOff ();
+        recoveryRequestTime = now;
+        state = CAN_BUS_RECOVERING;
+        return;
+    }
+
+    const bool passive = uint32_t (driver.TWAI_TX_ERR_CNT_REG ()) > ERROR_PASSIVE_LIMIT
+                      || uint32_t (driver.TWAI_RX_ERR_CNT_REG ()) > ERROR_PASSIVE_LIMIT;
+    if (passive) {
+        if (state != CAN_BUS_ERROR_PASSIVE) {
+            errorPassiveCount = errorPassiveCount + 1;
+            state = CAN_BUS_ERROR_PASSIVE;
+        }
+        driver.discardSupersededFrames ();
+    } else {
+        state = CAN_BUS_ERROR_ACTIVE;
+    }
+}
+
+// -------------------------------------------------------------
+// Statistics
+// -------------------------------------------------------------
+CAN_BUS_STATE CANBusRecovery::getState () const {
+    return state;
+}
+
+void CANBusRecovery::getStatistics (Statistics &out) const {
+    out.busOffCount       = busOffCount;
+    out.errorPassiveCount = errorPassiveCount;
+    out.recoveries        = recoveries;
+    out.recoveryRetries   = recoveryRetries;
+    out.lastRecoveryTime  = lastRecoveryTime;
+    out.maxRecoveryTime   = maxRecoveryTime;
+    // Trims left to the TX interrupt only show in the driver's count
+    out.framesDiscarded   = driver.transmitDiscardCount () - discardBaseline;
+}
+
+void CANBusRecovery::resetStatistics () {
+    // Written by the timer; a reset racing a poll may keep one count
+    busOffCount       = 0;
+    errorPassiveCount = 0;
+    recoveries        = 0;
+    recoveryRetries   = 0;
+    lastRecoveryTime  = 0;
+    maxRecoveryTime   = 0;
+    discardBaseline   = driver.transmitDiscardCount ();
+}
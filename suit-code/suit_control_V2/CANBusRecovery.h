@@ -0,0 +1,88 @@
+#ifndef CAN_BUS_RECOVERY_H
+#define CAN_BUS_RECOVERY_H
+
+#include <esp_timer.h>
+#include "ACAN_ESP32.h"
+
+/*
+ * CANBusRecovery — automatic bus-off recovery for the TWAI controller
+ * -------------------------------------------------------------------
+ * ‣ A periodic esp_timer (1 ms by default) polls the controller status and
+ *   the error counters:
+ *     error active  → error passive (TEC or REC > 127): counted; queued
+ *                     control frames superseded by a newer one for the
+ *                     same ID are dropped on every poll, since
+ *                     retransmissions hold the queue up.
+ *     bus-off       → transmission is suspended (the frame that was in the
+ *                     controller is lost), recovery is requested at once
+ *                     (recoverFromBusOff) and the state is RECOVERING.
+ *     RECOVERING    → once the controller is bus-on again the backlog is cut
+ *                     down to the newest control frame per ID and
+ *                     transmission resumes. If it is still bus-off and back
+ *                     in reset mode after the retry timeout, recovery is
+ *                     requested again.
+ * ‣ Time from bus-off to resumed transmission is the recovery itself
+ *   (128 × 11 recessive bits, 1.4 ms at 1 Mbit/s) plus at most two poll
+ *   intervals; every recovery is timed.
+ * ‣ Senders keep queueing while suspended: a full queue refuses frames as
+ *   usual, but superseded control frames are dropped on every poll, so
+ *   commands do not pile up.
+ */
+
+typedef enum {
+    CAN_BUS_ERROR_ACTIVE = 0,
+    CAN_BUS_ERROR_PASSIVE,
+    CAN_BUS_RECOVERING          // bus-off, waiting for bus-on
+} CAN_BUS_STATE;
+
+class CANBusRecovery {
+public:
+    struct Statistics {
+        uint32_t busOffCount       = 0;
+        uint32_t errorPassiveCount = 0;  // error active → error passive
+        uint32_t recoveries        = 0;  // bus-off → transmission resumed
+        uint32_t recoveryRetries   = 0;  // recovery requested again
+        uint32_t lastRecoveryTime  = 0;  // µs, bus-off seen → transmission resumed
+        uint32_t maxRecoveryTime   = 0;  // µs
+        uint32_t framesDiscarded   = 0;  // superseded control frames dropped
+    };
+
+    explicit CANBusRecovery(ACAN_ESP32& driver = ACAN_ESP32::can);
+    ~CANBusRecovery();
+
+    CANBusRecovery(const CANBusRecovery&) = delete;
+    CANBusRecovery& operator=(const CANBusRecovery&) = delete;
+
+    // Start / stop polling (after CANHandler::setupCAN())
+    bool begin(uint32_t pollIntervalUs = 1000, uint32_t retryTimeoutUs = 20000);
+    void end();
+    bool isRunning() const;
+
+    // One status check (called by the timer)
+    void poll();
+
+    CAN_BUS_STATE getState() const;
+    void getStatistics(Statistics& out) const;
+    void resetStatistics();
+
+private:
+    static void timerCallback(void* recovery);
+
+    ACAN_ESP32& driver;
+    esp_timer_handle_t timer = nullptr;
+    uint32_t retryTimeout = 20000;          // µs
+
+    volatile CAN_BUS_STATE state = CAN_BUS_ERROR_ACTIVE;
+    uint32_t busOffTime = 0;                // µs, bus-off detected
+    uint32_t recoveryRequestTime = 0;       // µs, last recoverFromBusOff()
+
+    volatile uint32_t busOffCount = 0;
+    volatile uint32_t errorPassiveCount = 0;
+    volatile uint32_t recoveries = 0;
+    volatile uint32_t recoveryRetries = 0;
+    volatile uint32_t lastRecoveryTime = 0;
+    volatile uint32_t maxRecoveryTime = 0;
+    uint32_t discardBaseline;               // driver discard count at reset
+};
+
+#endif  // CAN_BUS_RECOVERY_H
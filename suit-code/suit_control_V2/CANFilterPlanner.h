@@ -0,0 +1,100 @@
+#ifndef CAN_FILTER_PLANNER_H
+#define CAN_FILTER_PLANNER_H
+
+#include <stdint.h>
+
+/*
+ * CANFilterPlanner — tightest SJA1000 acceptance filter for a set of IDs
+ * ----------------------------------------------------------------------
+ * ‣ A filter matches a "cube" of 11-bit identifiers: a code plus a mask of
+ *   don't-care bits (2^popcount(dontCare) IDs pass).
+ * ‣ planStandardFilter() tries the single filter and every split of the
+ *   IDs over the two dual-mode filters, and keeps whichever lets the fewest
+ *   identifiers through (single wins a tie).
+ * ‣ Pure integer maths, no Arduino dependency, so it also builds on a host.
+ */
+
+struct CANFilterCube {
+    uint16_t code     = 0;
+    uint16_t dontCare = 0;
+
+    bool accepts (uint16_t id) const {
+        return ((id ^ code) & ~dontCare & 0x7FF) == 0;
+    }
+    uint32_t size () const {
+        return 1UL << __builtin_popcount (dontCare & 0x7FF);
+    }
+};
+
+struct CANFilterPlan {
+    bool          acceptAll = true;   // no IDs given
+    bool          dual      = false;
+    CANFilterCube filter[2];
+    uint32_t      acceptedCount = 2048;
+
+    bool accepts (uint16_t id) const {
+        return acceptAll || filter[0].accepts (id) || (dual && filter[1].accepts (id));
+    }
+};
+
+// Smallest cube containing every ID selected by mask (bit i → ids[i])
+inline CANFilterCube coverStandardIds (const uint16_t ids[], uint8_t count, uint32_t mask) {
+    CANFilterCube cube;
+    bool first = true;
+    for (uint8_t i = 0; i < count; ++i) {
+        if ((mask & (1UL << i)) == 0) {
+            continue;
+        }
+        if (first) {
+            cube.code = ids[i] & 0x7FF;
+            first = false;
+        } else {
+            cube.dontCare |= (ids[i] ^ cube.code) & 0x7FF;
+        }
+    }
+    cube.code &= ~cube.dontCare;
+    return cube;
+}
+
+// Number of identifiers accepted by either of two cubes
+inline uint32_t unionSize (const CANFilterCube &a, const CANFilterCube &b) {
+    uint32_t total = a.size () + b.size ();
+    const uint16_t fixedInBoth = ~(a.dontCare | b.dontCare) & 0x7FF;
+    if (((a.code ^ b.code) & fixedInBoth) == 0) {
+        total -= 1UL << __builtin_popcount (a.dontCare & b.dontCare & 0x7FF);
+    }
+    return total;
+}
+
+// count ≤ 16; larger sets fall back to the single filter
+inline CANFilterPlan planStandardFilter (const uint16_t ids[], uint8_t count) {
+    CANFilterPlan plan;
+    if (count == 0) {
+        return plan;
+    }
+    const uint32_t all = (count >= 32) ? 0xFFFFFFFFUL : ((1UL << count) - 1);
+
+    plan.acceptAll     = false;
+    plan.filter[0]     = coverStandardIds (ids, count, all);
+    plan.acceptedCount = plan.filter[0].size ();
+
+    if (count > 16) {
+        return plan;
+    }
+    // ids[0] always goes to filter 0, so each split is visited once
+    for (uint32_t split = 1; split < (1UL << (count - 1)); ++split) {
+        const uint32_t group1 = split << 1;
+        const CANFilterCube a = coverStandardIds (ids, count, all & ~group1);
+        const CANFilterCube b = coverStandardIds (ids, count, group1);
+        const uint32_t accepted = unionSize (a, b);
+        if (accepted < plan.acceptedCount) {
+            plan.dual          = true;
+            plan.filter[0]     = a;
+            plan.filter[1]     = b;
+            plan.acceptedCount = accepted;
+        }
+    }
+    return plan;
+}
+
+#endif  // CAN_FILTER_PLANNER_H
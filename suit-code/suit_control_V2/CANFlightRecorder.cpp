@@ -0,0 +1,231 @@
+#include "CANFlightRecorder.h"
+
+// -------------------------------------------------------------
+// Construction
+// -------------------------------------------------------------
+CANFlightRecorder::CANFlightRecorder (ACAN_ESP32 &driver) : driver (driver) {
+}
+
+CANFlightRecorder::~CANFlightRecorder () {
+    end ();
+    delete [] records;
+}
+
+// -------------------------------------------------------------
+// Start / stop
+// -------------------------------------------------------------
+bool CANFlightRecorder::begin (uint16_t capacity, uint32_t rate) {
+    if (running || capacity == 0 || capacity > 0x8000) {
+        return false;
+    }
+    uint16_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    if (records == nullptr || size != uint16_t (mask + 1)) {
+        delete [] records;
+        records = new CANFlightRecord [size];
+        if (records == nullptr) {
+            return false;
+        }
+        mask = size - 1;
+    }
+    bitRate = rate;
+    resume ();
+
+    if (!driver.addReceiveRoutine (receiveRoutine, this) ||
+        !driver.addTransmitCompleteRoutine (transmitRoutine, this)) {
+        driver.removeReceiveRoutine (receiveRoutine, this);
+        return false;
+    }
+    running = true;
+    return true;
+}
+
+void CANFlightRecorder::end () {
+    if (running) {
+        driver.removeReceiveRoutine (receiveRoutine, this);
+        driver.removeTransmitCompleteRoutine (transmitRoutine, this);
+        running = false;
+    }
+}
+
+bool CANFlightRecorder::isRunning () const {
+    return running;
+}
+
+// -------------------------------------------------------------
+// Interrupt side: one record per frame
+// -------------------------------------------------------------
+void IRAM_ATTR CANFlightRecorder::receiveRoutine (const CANMessage &frame, void *recorder) {
+    static_cast<CANFlightRecorder *>(recorder)->record (frame, false);
+}
+
+void IRAM_ATTR CANFlightRecorder::transmitRoutine (const CANMessage &frame, void *recorder) {
+    static_cast<CANFlightRecorder *>(recorder)->record (frame, true);
+}
+
+void IRAM_ATTR CANFlightRecorder::record (const CANMessage &frame, bool transmitted) {
+    portENTER_CRITICAL_ISR (&lock);
+    ++seen;
+    if (!frozen) {
+        toRecord (frame, transmitted, records[head & mask]);
+        ++head;
+        if (held <= mask) {
+            ++held;
+        }
+        if (triggered && --postTrigger == 0) {
+            frozen = true;
+        }
+    }
+    portEXIT_CRITICAL_ISR (&lock);
+}
+
+void IRAM_ATTR CANFlightRecorder::toRecord (const CANMessage &frame, bool transmitted,
+                                            CANFlightRecord &out) {
+    out.timestamp = frame.timestamp;
+    out.id = (frame.id & CAN_RECORD_ID_MASK)
+           | (frame.ext ? CAN_RECORD_EXT_FLAG : 0)
+           | (frame.rtr ? CAN_RECORD_RTR_FLAG : 0)
+           | (transmitted ? CAN_RECORD_TX_FLAG : 0);
+    out.len = frame.len;
+    out.reserved[0] = out.reserved[1] = out.reserved[2] = 0;
+    memcpy (out.data, frame.data, sizeof (out.data));
+}
+
+void CANFlightRecorder::toMessage (const CANFlightRecord &record, CANMessage &out) {
+    out.id        = record.id & CAN_RECORD_ID_MASK;
+    out.ext       = (record.id & CAN_RECORD_EXT_FLAG) != 0;
+    out.rtr       = (record.id & CAN_RECORD_RTR_FLAG) != 0;
+    out.len       = (record.len > 8) ? 8 : record.len;
+    out.timestamp = record.timestamp;
+    memcpy (out.data, record.data, sizeof (record.data));
+}
+
+// -------------------------------------------------------------
+// Trigger
+// -------------------------------------------------------------
+void CANFlightRecorder::trigger (uint16_t postTriggerRecords) {
+    portENTER_CRITICAL (&lock);
+    if (!triggered && !frozen) {
+        triggered   = postTriggerRecords > 0;
+        postTrigger = postTriggerRecords;
+        frozen      = postTriggerRecords == 0;
+    }
+    portEXIT_CRITICAL (&lock);
+}
+
+bool CANFlightRecorder::isTriggered () const {
+    portENTER_CRITICAL (&lock);
+    const bool result = triggered || frozen;
+    portEXIT_CRITICAL (&lock);
+    return result;
+}
+
+bool CANFlightRecorder::isFrozen () const {
+    portENTER_CRITICAL (&lock);
+    const bool result = frozen;
+    portEXIT_CRITICAL (&lock);
+    return result;
+}
+
+void CANFlightRecorder::resume () {
+    portENTER_CRITICAL (&lock);
+    head        = 0;
+    held        = 0;
+    seen        = 0;
+    postTrigger = 0;
+    triggered   = false;
+    frozen      = false;
+    dumping     = false;
+    portEXIT_CRITICAL (&lock);
+}
+
+// -------------------------------------------------------------
+// Dump (the ring is frozen: the interrupt no longer writes it)
+// -------------------------------------------------------------
+void CANFlightRecorder::startDump () {
+    if (dumping || records == nullptr) {
+        return;
+    }
+    portENTER_CRITICAL (&lock);
+    frozen = true;
+    memcpy (dumpHeader.magic, "CANR", 4);
+    dumpHeader.version    = DUMP_VERSION;
+    dumpHeader.recordSize = sizeof (CANFlightRecord);
+    dumpHeader.count      = held;
+    dumpHeader.dropped    = seen - held;
+    dumpHeader.bitRate    = bitRate;
+    portEXIT_CRITICAL (&lock);
+    dumpOffset = 0;
+    dumpSize   = sizeof (CANFlightDumpHeader) + size_t (dumpHeader.count) * sizeof (CANFlightRecord);
+    dumping    = true;
+}
+
+size_t CANFlightRecorder::dump (Print &out, size_t maxBytes) {
+    if (!dumping) {
+        return 0;
+    }
+    size_t written = 0;
+    while (dumpOffset < dumpSize && written < maxBytes) {
+        const uint8_t *chunk;
+        size_t length;
+        if (dumpOffset < sizeof (CANFlightDumpHeader)) {
+            chunk  = reinterpret_cast<const uint8_t *> (&dumpHeader) + dumpOffset;
+            length = sizeof (CANFlightDumpHeader) - dumpOffset;
+        } else {
+            // Oldest record is at head − count; one record at a time, as the
+            // ring may wrap in the middle of the dump
+            const size_t offset = dumpOffset - sizeof (CANFlightDumpHeader);
+            const uint32_t index = head - dumpHeader.count + uint32_t (offset / sizeof (CANFlightRecord));
+            const size_t within = offset % sizeof (CANFlightRecord);
+            chunk  = reinterpret_cast<const uint8_t *> (&records[index & mask]) + within;
+            length = sizeof (CANFlightRecord) - within;
+        }
+        if (length > maxBytes - written) {
+            length = maxBytes - written;
+        }
+        const size_t sent = out.write (chunk, length);
+        dumpOffset += sent;
+        written    += sent;
+        if (sent < length) {
+            break;  // Output full, carry on next call
+        }
+    }
+    if (dumpOffset >= dumpSize) {
+        resume ();
+    }
+    return written;
+}
+
+bool CANFlightRecorder::isDumping () const {
+    return dumping;
+}
+
+// -------------------------------------------------------------
+// In-memory access
+// -------------------------------------------------------------
+uint16_t CANFlightRecorder::copyRecords (CANFlightRecord *out, uint16_t maxCount) const {
+    portENTER_CRITICAL (&lock);
+    const uint16_t count = (held < maxCount) ? held : maxCount;
+    const uint32_t first = head - count;
+    for (uint16_t i = 0; i < count; ++i) {
+        out[i] = records[(first + i) & mask];
+    }
+    portEXIT_CRITICAL (&lock);
+    return count;
+}
+
+uint16_t CANFlightRecorder::getRecordCount () const {
+    portENTER_CRITICAL (&lock);
+    const uint16_t result = held;
+    portEXIT_CRITICAL (&lock);
+    return result;
+}
+
+uint32_t CANFlightRecorder::getSeenCount () const {
+    portENTER_CRITICAL (&lock);
+    const uint32_t result = seen;
+    portEXIT_CRITICAL (&lock);
+    return result;
+}
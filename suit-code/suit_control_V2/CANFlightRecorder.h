@@ -0,0 +1,124 @@
+#ifndef CAN_FLIGHT_RECORDER_H
+#define CAN_FLIGHT_RECORDER_H
+
+#include <Arduino.h>
+#include "ACAN_ESP32.h"
+
+/*
+ * CANFlightRecorder — always-on binary log of every CAN frame
+ * -----------------------------------------------------------
+ * ‣ begin() adds a receive and a transmit complete routine to the driver;
+ *   every frame the controller accepts or sends is stored as a 20-byte
+ *   CANFlightRecord with its driver timestamp (µs: RX interrupt, or end of
+ *   transmission for our own frames). The ring keeps the newest frames and
+ *   overwrites the oldest.
+ * ‣ It sits on the ACAN_ESP32 driver, so it sees what ESP32CANTransport
+ *   sends and receives (on the hardware, or on the emulated TWAI).
+ * ‣ trigger(n) keeps recording n more frames, then freezes the ring, so a
+ *   dump shows what led up to the event and what followed it. Frames seen
+ *   while frozen are only counted.
+ * ‣ startDump() freezes the ring (if it is not already) and dump(out, max)
+ *   writes it, header first and oldest record first, at most max bytes per
+ *   call, so a dump over Serial can be spread over several loop() passes.
+ *   The last call resumes recording with an empty ring.
+ *   Nothing else may be printed to the same port until the dump is over,
+ *   or the records are cut apart.
+ * ‣ Dump format (little-endian, like the ESP32 and x86 hosts):
+ *     CANFlightDumpHeader, then header.count × CANFlightRecord.
+ *   host/CANRecordTool turns it into candump text and replays it; it finds
+ *   the header by its magic, so a dump mixed with Serial text is fine.
+ */
+
+// Flags in the top bits of CANFlightRecord::id (the SocketCAN layout for
+// ext / rtr, bit 29 marks our own frames)
+static const uint32_t CAN_RECORD_EXT_FLAG = 1UL << 31;
+static const uint32_t CAN_RECORD_RTR_FLAG = 1UL << 30;
+static const uint32_t CAN_RECORD_TX_FLAG  = 1UL << 29;
+static const uint32_t CAN_RECORD_ID_MASK  = 0x1FFFFFFFUL;
+
+struct CANFlightRecord {
+    uint32_t timestamp;      // µs, driver time
+    uint32_t id;             // identifier | CAN_RECORD_*_FLAG
+    uint8_t  len;
+    uint8_t  reserved[3];
+    uint8_t  data[8];
+};
+
+struct CANFlightDumpHeader {
+    char     magic[4];       // "CANR"
+    uint16_t version;
+    uint16_t recordSize;     // sizeof (CANFlightRecord)
+    uint32_t count;          // records that follow
+    uint32_t dropped;        // frames seen since recording (re)started, not in the dump
+    uint32_t bitRate;
+};
+
+static_assert(sizeof(CANFlightRecord) == 20, "CANFlightRecord is a file format");
+static_assert(sizeof(CANFlightDumpHeader) == 20, "CANFlightDumpHeader is a file format");
+
+class CANFlightRecorder {
+public:
+    static const uint16_t DUMP_VERSION = 1;
+
+    explicit CANFlightRecorder(ACAN_ESP32& driver = ACAN_ESP32::can);
+    ~CANFlightRecorder();
+
+    CANFlightRecorder(const CANFlightRecorder&) = delete;
+    CANFlightRecorder& operator=(const CANFlightRecorder&) = delete;
+
+    // Start recording (after CANHandler::setupCAN()); capacity is rounded
+    // up to a power of two, bitRate only goes into the dump header
+    bool begin(uint16_t capacity = 1024, uint32_t bitRate = 1'000'000UL);
+    void end();
+    bool isRunning() const;
+
+    // Freeze after postTriggerRecords more frames (0 → now); ignored while
+    // a trigger is pending or the ring is frozen
+    void trigger(uint16_t postTriggerRecords = 0);
+    bool isTriggered() const;
+    bool isFrozen() const;
+
+    // Dump: freeze, then write up to maxBytes per call; resumes when done
+    void   startDump();
+    size_t dump(Print& out, size_t maxBytes = SIZE_MAX);
+    bool   isDumping() const;
+
+    // Empty the ring and record again (also cancels a trigger or a dump)
+    void resume();
+
+    // Held records, oldest first; returns how many were copied
+    uint16_t copyRecords(CANFlightRecord* out, uint16_t maxCount) const;
+    uint16_t getRecordCount() const;
+    uint32_t getSeenCount() const;   // frames since recording (re)started
+
+    static void toRecord(const CANMessage& frame, bool transmitted, CANFlightRecord& out);
+    static void toMessage(const CANFlightRecord& record, CANMessage& out);
+
+private:
+    static void receiveRoutine(const CANMessage& frame, void* recorder);
+    static void transmitRoutine(const CANMessage& frame, void* recorder);
+    void record(const CANMessage& frame, bool transmitted);
+
+    ACAN_ESP32& driver;
+    mutable portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+    CANFlightRecord* records = nullptr;
+    uint16_t mask = 0;               // capacity − 1
+    uint32_t bitRate = 1'000'000UL;
+    bool     running = false;
+
+    // Written by the interrupt, under lock
+    uint32_t head = 0;               // next write, free-running
+    uint16_t held = 0;               // records in the ring
+    uint32_t seen = 0;
+    uint16_t postTrigger = 0;        // frames still to record after trigger()
+    bool     triggered = false;
+    bool     frozen = false;
+
+    // Dump in progress (ring frozen)
+    bool     dumping = false;
+    CANFlightDumpHeader dumpHeader;
+    size_t   dumpOffset = 0;         // bytes written so far
+    size_t   dumpSize = 0;
+};
+
+#endif  // CAN_FLIGHT_RECORDER_H
@@ -1,32 +1,58 @@
 #include <Arduino.h>
 #include "CANHandler.h"
+#include "ESP32CANTransport.h"
+#include "RemoteDebug.h"
 
-// ─────────────────────────────────────────────────────────────
-// NOTE:  Constructor definition no longer needed because the
-//        header uses  = default;
-//        Remove the old body you had here.
-// ─────────────────────────────────────────────────────────────
+// -------------------------------------------------------------
+// Construction
+// -------------------------------------------------------------
+CANHandler::CANHandler () : transport (ESP32CANTransport::instance ()) {
+}
+
+CANHandler::CANHandler (CANTransport &transport) : transport (transport) {
+}
+
+CANTransport& CANHandler::getTransport () {
+    return transport;
+}
 
+uint32_t CANHandler::getBitRate () const {
+    return DESIRED_BIT_RATE;
+}
 
 // -------------------------------------------------------------
 // CAN initialisation
 // -------------------------------------------------------------
 void CANHandler::setupCAN (uint8_t txPin, uint8_t rxPin) {
 
-    ACAN_ESP32_Settings settings (DESIRED_BIT_RATE);
-
-    // Cast uint8_t → gpio_num_t
-    settings.mTxPin = static_cast<gpio_num_t>(txPin);  // GPIO 22
-    settings.mRxPin = static_cast<gpio_num_t>(rxPin);  // GPIO 21
+    // Only let the IDs we listen to through the hardware filter
+    uint16_t ids[MAX_CACHED_ID];
+    uint8_t  idCount = 0;
+    for (uint16_t id = 0; id < MAX_CACHED_ID; ++id) {
+        if (subscriptions[id] != nullptr || extraIds[id]) {
+            ids[idCount++] = id;
+        }
+    }
+    filterPlan = planStandardFilter (ids, idCount);
 
-    settings.mRequestedCANMode = ACAN_ESP32_Settings::NormalMode;
+    const uint32_t errorCode = transport.begin (txPin, rxPin, DESIRED_BIT_RATE, filterPlan);
 
-    const uint32_t errorCode = ACAN_ESP32::can.begin (settings);
+    // Hand over the slots registered before the driver was running
+    for (uint16_t id = 0; id < MAX_CACHED_ID; ++id) {
+        if (subscriptions[id] != nullptr) {
+            transport.subscribe (*subscriptions[id]);
+        }
+        if (transmitSubscriptions[id] != nullptr) {
+            transport.subscribeTransmit (*transmitSubscriptions[id]);
+        }
+    }
+    started = true;
 
     if (errorCode == 0) {
-        Serial.println("CAN initialised successfully.");
+        debugI ("CAN initialised successfully (filter passes %lu IDs).",
+                (unsigned long) filterPlan.acceptedCount);
     } else {
-        Serial.printf ("CAN init failed, error code: %lu\n", errorCode);
+        debugE ("CAN init failed, error code: %lu", (unsigned long) errorCode);
     }
 }
 
@@ -34,60 +60,163 @@ void CANHandler::setupCAN (uint8_t txPin, uint8_t rxPin) {
 // Message transmit
 // -------------------------------------------------------------
 void CANHandler::sendCANMessage (const CANMessage &message) {
-    if (!ACAN_ESP32::can.tryToSend (message)) {
-        Serial.println("CAN‑TX failed (buffer full?).");
+    if (!transport.send (message)) {
+        debugW_every(100, "CAN‑TX failed (buffer full?).");
     }
 }
 
+bool CANHandler::trySend (const CANMessage &message, CAN_PRIORITY priority) {
+    return transport.send (message, priority);
+}
+
+uint32_t CANHandler::trySendBurst (const CANMessage messages[], uint32_t count,
+                                   CAN_PRIORITY priority) {
+    return transport.sendBurst (messages, count, priority);
+}
+
+bool CANHandler::claimControlPriority () {
+    if (controlClaimed) {
+        return false;
+    }
+    controlClaimed = true;
+    return true;
+}
+
+void CANHandler::releaseControlPriority () {
+    controlClaimed = false;
+}
+
+CAN_PRIORITY CANHandler::commandPriority () const {
+    return controlClaimed ? CAN_PRIORITY_NORMAL : CAN_PRIORITY_CONTROL;
+}
+
 // -------------------------------------------------------------
-// Poll CAN controller, cache most‑recent frames
+// Poll CAN controller, cache most‑recent frame per ID
 // -------------------------------------------------------------
 void CANHandler::update () {
-    CANMessage message;
-    uint8_t    count = 0;
-
-    while (ACAN_ESP32::can.receive (message) && count < 4) {
-        latestFrame[count]      = message;
-        lastRecievedTime[count] = millis();
+    // Drain everything the ISR has queued in one pass, so the driver
+    // buffer never backs up
+    transport.drain (ingestCallback, this);
+}
 
-        // Optional debug print
-        // Serial.printf("RX ‑ ID: 0x%lX  Data:", message.id);
-        for (uint8_t i = 0; i < message.len; ++i) {
-            // Serial.printf(" %02X", message.data[i]);
-        }
-        // Serial.println();
+void CANHandler::ingestCallback (const CANMessage &message, void *handler) {
+    static_cast<CANHandler *>(handler)->ingest (message);
+}
 
-        ++count;
+void CANHandler::ingest (const CANMessage &message) {
+    if (message.ext || message.id >= MAX_CACHED_ID) {
+        ++uncachedFrames;
+        return;
     }
+    CANFeedbackEntry &entry = cache[message.id];
+    entry.frame     = message;
+    entry.timestamp = message.timestamp;
+    ++entry.sequence;
+
+    // Optional debug print
+    // Serial.printf("RX ‑ ID: 0x%lX  Data:", message.id);
+    // for (uint8_t i = 0; i < message.len; ++i) Serial.printf(" %02X", message.data[i]);
+    // Serial.println();
 }
 
 // -------------------------------------------------------------
 // Convenience helpers
 // -------------------------------------------------------------
+bool CANHandler::subscribe (ACAN_ESP32_Subscription &slot) {
+    static_assert (MAX_CACHED_ID <= ACAN_ESP32::kSubscribableIdentifierCount,
+                   "every cached ID must be subscribable");
+    if (slot.mIdentifier >= MAX_CACHED_ID) {
+        return false;
+    }
+    subscriptions[slot.mIdentifier] = &slot;
+    return !started || transport.subscribe (slot);
+}
+
+bool CANHandler::subscribeTransmit (ACAN_ESP32_Subscription &slot) {
+    if (slot.mIdentifier >= MAX_CACHED_ID) {
+        return false;
+    }
+    transmitSubscriptions[slot.mIdentifier] = &slot;
+    return !started || transport.subscribeTransmit (slot);
+}
+
+void CANHandler::unsubscribe (const ACAN_ESP32_Subscription &slot) {
+    if (slot.mIdentifier >= MAX_CACHED_ID || subscriptions[slot.mIdentifier] != &slot) {
+        return;
+    }
+    subscriptions[slot.mIdentifier] = nullptr;
+    if (started) {
+        transport.unsubscribe (slot);
+    }
+}
+
+void CANHandler::unsubscribeTransmit (const ACAN_ESP32_Subscription &slot) {
+    if (slot.mIdentifier >= MAX_CACHED_ID || transmitSubscriptions[slot.mIdentifier] != &slot) {
+        return;
+    }
+    transmitSubscriptions[slot.mIdentifier] = nullptr;
+    if (started) {
+        transport.unsubscribeTransmit (slot);
+    }
+}
+
+bool CANHandler::acceptId (uint16_t id) {
+    if (id >= MAX_CACHED_ID) {
+        return false;
+    }
+    extraIds[id] = true;
+    return true;
+}
+
+const CANFilterPlan& CANHandler::getFilterPlan () const {
+    return filterPlan;
+}
+
+bool CANHandler::getFeedback (uint32_t targetId, CANFeedbackEntry &out) const {
+    if (targetId >= MAX_CACHED_ID) {
+        return false;
+    }
+    const ACAN_ESP32_Subscription *slot = subscriptions[targetId];
+    if (slot != nullptr) {
+        out.sequence  = slot->read (out.frame);
+        out.timestamp = out.frame.timestamp;
+    } else {
+        out = cache[targetId];
+    }
+    return true;
+}
+
+uint32_t CANHandler::getSequence (uint32_t targetId) const {
+    if (targetId >= MAX_CACHED_ID) {
+        return 0;
+    }
+    const ACAN_ESP32_Subscription *slot = subscriptions[targetId];
+    return (slot != nullptr) ? slot->count () : cache[targetId].sequence;
+}
+
+uint32_t CANHandler::getUncachedFrameCount () const {
+    return uncachedFrames;
+}
+
 bool CANHandler::getIsOnline (uint8_t id) {
-    return (millis() - lastRecievedTime[id - 1]) <= recieveTimeout;
+    return isMessageOnline (id, recieveTimeout);
 }
 
 CANMessage CANHandler::getLatestFrame (uint8_t id) {
-    return latestFrame[id - 1];
+    return getLatestMessage (id);
 }
 
 CANMessage CANHandler::getLatestMessage (uint32_t targetId) {
-    for (int i = 0; i < 4; ++i) {
-        if (latestFrame[i].id == targetId) {
-            return latestFrame[i];
-        }
+    CANFeedbackEntry entry;
+    if (getFeedback (targetId, entry) && entry.sequence != 0) {
+        return entry.frame;
     }
     return CANMessage{};   // Empty/zeroed struct if not found
 }
 
 bool CANHandler::isMessageOnline (uint32_t targetId,
                                   uint32_t timeout) const {
-    for (int i = 0; i < 4; ++i) {
-        if (latestFrame[i].id == targetId &&
-            (millis() - lastRecievedTime[i] <= timeout)) {
-            return true;
-        }
-    }
-    return false;
+    CANFeedbackEntry entry;
+    return getFeedback (targetId, entry) && entry.sequence != 0 &&
+           (micros() - entry.timestamp <= timeout * 1000UL);
 }
@@ -1,20 +1,44 @@
 #ifndef CAN_HANDLER_H
 #define CAN_HANDLER_H
 
-#include <ACAN_ESP32.h>
+#include "CANTransport.h"
+#include "CANFilterPlanner.h"
 
 /*
- * CANHandler — lightweight wrapper around ACAN_ESP32
- * --------------------------------------------------
- * ‣ Call setupCAN(txPin, rxPin) from your sketch’s setup().
- *   If no pins are passed, TX defaults to GPIO 22 and RX to GPIO 21.
- * ‣ DESIRED_BIT_RATE is set to 1 Mbit s⁻¹; adjust if needed.
- * ‣ latestFrame[0‑3] holds the most recent frame for motor IDs 1‑4.
+ * CANHandler — lightweight wrapper around the CAN controller
+ * ----------------------------------------------------------
+ * ‣ All traffic goes through a CANTransport: ACAN_ESP32 by default, or a
+ *   host backend (loopback bus, SocketCAN) passed to the constructor.
+ * ‣ Call setupCAN(txPin, rxPin) from your sketch’s setup().
+ *   If no pins are passed, TX defaults to GPIO 22 and RX to GPIO 21.
+ * ‣ DESIRED_BIT_RATE is set to 1 Mbit s⁻¹; adjust if needed.
+ * ‣ update() drains the whole driver receive buffer into a feedback cache
+ *   indexed directly by standard CAN ID (0 … MAX_CACHED_ID‑1), so lookups
+ *   are O(1) however many nodes are on the bus.
+ * ‣ subscribe() hands a slot to the driver: frames for that ID are written
+ *   by the RX interrupt straight into it and never go through update().
+ *   The lookup helpers below read subscribed IDs from their slot.
+ * ‣ subscribeTransmit() does the same for our own frames once they have
+ *   left the controller, stamped with the completion time.
+ * ‣ setupCAN() programs the hardware acceptance filter to the tightest
+ *   single/dual filter covering every subscribed ID plus any acceptId()
+ *   extras, so traffic from other nodes never reaches the ISR.
  */
 
+// One cache slot per CAN ID
+struct CANFeedbackEntry {
+    CANMessage frame;          // Most recent frame with this ID
+    uint32_t   timestamp = 0;  // Reception time (µs, from the RX interrupt)
+    uint32_t   sequence  = 0;  // Frames received with this ID (0 → never seen)
+};
+
 class CANHandler {
 public:
-    CANHandler() = default;
+    // IDs 0 … MAX_CACHED_ID‑1 are cached (hips, knees, ankles, spare nodes)
+    static const uint16_t MAX_CACHED_ID = 32;
+
+    CANHandler();                                   // ACAN_ESP32::can
+    explicit CANHandler(CANTransport& transport);
 
     // Initialise CAN controller
     void setupCAN(uint8_t txPin = 22, uint8_t rxPin = 21);
@@ -22,6 +46,25 @@ public:
     // Transmit a message
     void sendCANMessage(const CANMessage& message);
 
+    // Transmit without reporting; false → frame refused (queue full).
+    // Higher priority classes leave first (see CANTransport.h).
+    bool       trySend(const CANMessage& message,
+                       CAN_PRIORITY priority = CAN_PRIORITY_NORMAL);
+    // Queue frames back-to-back; returns how many were accepted
+    uint32_t   trySendBurst(const CANMessage messages[], uint32_t count,
+                            CAN_PRIORITY priority = CAN_PRIORITY_NORMAL);
+
+    // CAN_PRIORITY_CONTROL has a single-producer transmit queue. A producer
+    // in another task (MotorScheduler's timer) claims it; while it is
+    // claimed, commandPriority() is CAN_PRIORITY_NORMAL instead, so loop
+    // side commands (Motor::update(), MotorGroup) stay out of its queue.
+    bool         claimControlPriority();   // false → already claimed
+    void         releaseControlPriority();
+    CAN_PRIORITY commandPriority() const;
+
+    CANTransport& getTransport();
+    uint32_t      getBitRate() const;             // bit/s set by setupCAN()
+
     // Poll CAN hardware; call this each loop()
     void update();
 
@@ -31,17 +74,52 @@ public:
     CANMessage getLatestMessage(uint32_t targetId);
     bool       isMessageOnline(uint32_t targetId, uint32_t timeout) const;
 
-    // Last frame received for IDs 0‑3 (motor1‑motor4)
-    CANMessage latestFrame[4];
+    // Deliver frames for slot.mIdentifier straight from the RX interrupt.
+    // May be called before setupCAN() (e.g. from a global constructor).
+    bool       subscribe(ACAN_ESP32_Subscription& slot);
+
+    // Write frames sent with ID slot.mIdentifier into the slot once they are
+    // on the wire (timestamp → completion time, µs). Same rules as subscribe().
+    bool       subscribeTransmit(ACAN_ESP32_Subscription& slot);
+
+    // Hand a slot back before it is destroyed; its ID goes back through
+    // update(). The acceptance filter is left as setupCAN() planned it.
+    void       unsubscribe(const ACAN_ESP32_Subscription& slot);
+    void       unsubscribeTransmit(const ACAN_ESP32_Subscription& slot);
+
+    // Let an unsubscribed ID through the acceptance filter (before setupCAN())
+    bool       acceptId(uint16_t id);
+
+    // Acceptance filter programmed by setupCAN()
+    const CANFilterPlan& getFilterPlan() const;
+
+    // Snapshot of the latest frame for an ID (false if outside the cache)
+    bool       getFeedback(uint32_t targetId, CANFeedbackEntry& out) const;
+    uint32_t   getSequence(uint32_t targetId) const;
+
+    // Frames that could not be cached (extended or ID ≥ MAX_CACHED_ID)
+    uint32_t   getUncachedFrameCount() const;
 
 private:
-    static const uint32_t DESIRED_BIT_RATE = 1'000'000UL;  // 1 Mbps
+    static const uint32_t DESIRED_BIT_RATE = 1'000'000UL;  // 1 Mbps
+
+    // Store one received frame in its cache slot
+    void ingest(const CANMessage& message);
+    static void ingestCallback(const CANMessage& message, void* handler);
 
-    // Timestamp (ms) when each ID was last seen
-    uint32_t lastRecievedTime[4] = {0, 0, 0, 0};
+    CANTransport& transport;
+    CANFeedbackEntry cache[MAX_CACHED_ID];
+    ACAN_ESP32_Subscription* subscriptions[MAX_CACHED_ID] = {};
+    ACAN_ESP32_Subscription* transmitSubscriptions[MAX_CACHED_ID] = {};
+    bool     extraIds[MAX_CACHED_ID] = {};
+    CANFilterPlan filterPlan;
+    uint32_t uncachedFrames = 0;
+    bool     started = false;
+    bool     controlClaimed = false;
 
     // How long (ms) before we consider a device “offline”
-    int recieveTimeout = 600;
+    // (compared against the µs reception timestamp)
+    uint32_t recieveTimeout = 600;
 };
 
 #endif  // CAN_HANDLER_H
@@ -0,0 +1,74 @@
+#ifndef CAN_TRANSPORT_H
+#define CAN_TRANSPORT_H
+
+#include <ACAN_ESP32_CANMessage.h>
+#include <ACAN_ESP32_Subscription.h>
+#include "CANFilterPlanner.h"
+
+/*
+ * CANTransport — the CAN controller as seen by CANHandler
+ * -------------------------------------------------------
+ * ‣ ESP32CANTransport (ACAN_ESP32::can) is the default and the only one
+ *   built into the sketch.
+ * ‣ Host builds can hand CANHandler one of the backends in host/ instead:
+ *   LoopbackCANTransport (a node on an in-process HostCANBus) or
+ *   SocketCANTransport (Linux SocketCAN, e.g. vcan0).
+ * ‣ Frames for a subscribed ID are written into their slot as they arrive
+ *   (RX interrupt, bus callback or reader thread); every other accepted
+ *   frame is queued until drain().
+ * ‣ send() / sendBurst() never block: a full transmit queue refuses frames.
+ * ‣ Frames are queued by priority class: the next frame to go out is the
+ *   oldest of the highest non-empty class (CAN_PRIORITY_CONTROL first).
+ */
+
+// Transmit priority classes, highest first
+typedef enum {
+    CAN_PRIORITY_CONTROL = 0,   // Torque / MIT commands
+    CAN_PRIORITY_NORMAL,        // Default, stop
+    CAN_PRIORITY_BACKGROUND,    // Start, re-zero, diagnostics
+    CAN_PRIORITY_COUNT
+} CAN_PRIORITY;
+
+class CANTransport {
+public:
+    typedef void (*DrainRoutine)(const CANMessage& message, void* context);
+
+    virtual ~CANTransport() = default;
+
+    // Start the controller with a standard-ID acceptance filter.
+    // Returns 0 on success, otherwise a backend-specific error code.
+    virtual uint32_t begin(uint8_t txPin, uint8_t rxPin, uint32_t bitRate,
+                           const CANFilterPlan& filter) = 0;
+
+    // Queue one frame (false → transmit queue full or controller down)
+    virtual bool send(const CANMessage& message,
+                      CAN_PRIORITY priority = CAN_PRIORITY_NORMAL) = 0;
+
+    // Queue frames in order; returns how many were accepted
+    virtual uint32_t sendBurst(const CANMessage messages[], uint32_t count,
+                               CAN_PRIORITY priority = CAN_PRIORITY_NORMAL) {
+        uint32_t accepted = 0;
+        while (accepted < count && send(messages[accepted], priority)) {
+            ++accepted;
+        }
+        return accepted;
+    }
+
+    // Hand every queued received frame to routine; returns the frame count
+    virtual uint32_t drain(DrainRoutine routine, void* context) = 0;
+
+    // Deliver frames for slot.mIdentifier straight into the slot
+    virtual bool subscribe(ACAN_ESP32_Subscription& slot) = 0;
+
+    // Write every frame with ID slot.mIdentifier that has left the
+    // controller into the slot, timestamped (µs) with its completion time.
+    // false → not supported by this backend.
+    virtual bool subscribeTransmit(ACAN_ESP32_Subscription& /* slot */) { return false; }
+
+    // Stop writing into slot (if it is still the one for its ID). Once
+    // these return, the slot is not being written and may be destroyed.
+    virtual void unsubscribe(const ACAN_ESP32_Subscription& slot) = 0;
+    virtual void unsubscribeTransmit(const ACAN_ESP32_Subscription& /* slot */) {}
+};
+
+#endif  // CAN_TRANSPORT_H
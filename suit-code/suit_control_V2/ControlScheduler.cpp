@@ -0,0 +1,193 @@
+#include "ControlScheduler.h"
+
+// esp_timer does not accept periodic timers shorter than this
+static const uint32_t MIN_PERIOD_US = 50;
+
+ControlScheduler::~ControlScheduler()
+{
+  end();
+}
+
+// ------------------ Configuration ------------------
+
+bool ControlScheduler::addStage(const char *name, ControlStage stage, void *context, uint16_t divider)
+{
+  if (isRunning() || stage == nullptr || divider == 0 || stageCount >= MAX_STAGES) {
+    return false;
+  }
+  Stage &slot = stages[stageCount++];
+  slot.name = name;
+  slot.function = stage;
+  slot.context = context;
+  slot.divider = divider;
+  return true;
+}
+
+// ------------------ Timer ------------------
+
+bool ControlScheduler::begin(uint32_t periodUs)
+{
+  if (isRunning() || periodUs < MIN_PERIOD_US || stageCount == 0) {
+    return false;
+  }
+  esp_timer_create_args_t args = {};
+  args.callback = timerCallback;
+  args.arg = this;
+  args.dispatch_method = ESP_TIMER_TASK;
+  args.name = "control_release";
+  args.skip_unhandled_events = true;  // releases come from the clock
+  if (esp_timer_create(&args, &timer) != ESP_OK) {
+    timer = nullptr;
+    return false;
+  }
+  period = periodUs;
+  nextIndex = 0;
+  for (uint8_t i = 0; i < stageCount; i++) {
+    stages[i].lastStart = 0;
+  }
+  // Read before the timer starts, so it never fires ahead of our release
+  startTime = uint64_t(esp_timer_get_time()) + period;
+  if (esp_timer_start_periodic(timer, period) != ESP_OK) {
+    esp_timer_delete(timer);
+    timer = nullptr;
+    return false;
+  }
+  return true;
+}
+
+void ControlScheduler::end()
+{
+  if (timer != nullptr) {
+    esp_timer_stop(timer);
+    esp_timer_delete(timer);
+    timer = nullptr;
+  }
+}
+
+bool ControlScheduler::isRunning() const { return timer != nullptr; }
+
+void ControlScheduler::timerCallback(void *scheduler)
+{
+  ControlScheduler &self = *static_cast<ControlScheduler *>(scheduler);
+#ifdef ARDUINO
+  TaskHandle_t task = self.waiting.load(std::memory_order_acquire);
+  if (task != nullptr) {
+    xTaskNotifyGive(task);
+  }
+#else
+  {
+    std::lock_guard<std::mutex> lock(self.wakeLock);
+    self.woken = true;
+  }
+  self.wake.notify_all();
+#endif
+}
+
+// ------------------ Loop Side ------------------
+
+void ControlScheduler::run()
+{
+#ifdef ARDUINO
+  waiting.store(xTaskGetCurrentTaskHandle(), std::memory_order_release);
+  while (!poll() && isRunning()) {
+    // The timeout only matters if a wake-up is lost
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(period / 1000 + 1));
+  }
+#else
+  while (!poll() && isRunning()) {
+    std::unique_lock<std::mutex> lock(wakeLock);
+    wake.wait_for(lock, std::chrono::milliseconds(1), [this] { return woken; });
+    woken = false;
+  }
+#endif
+}
+
+bool ControlScheduler::poll()
+{
+  const uint64_t now = esp_timer_get_time();
+  if (!isRunning() || now < startTime + uint64_t(nextIndex) * period) {
+    return false;
+  }
+
+  // The latest release that has passed; any before it were overrun
+  const uint32_t index = uint32_t((now - startTime) / period);
+  statistics.skippedReleases += index - nextIndex;
+  nextIndex = index + 1;
+
+  ControlTick tick;
+  tick.cycle = index;
+  tick.releaseTime = startTime + uint64_t(index) * period;
+  tick.startTime = now;
+  tick.lateness = uint32_t(now - tick.releaseTime);
+
+  for (uint8_t i = 0; i < stageCount; i++) {
+    Stage &stage = stages[i];
+    if (index % stage.divider != 0) {
+      continue;
+    }
+    const uint64_t stageStart = esp_timer_get_time();
+    tick.dt = (stage.lastStart != 0) ? (stageStart - stage.lastStart) * 1e-6f
+                                     : float(period) * stage.divider * 1e-6f;
+    stage.lastStart = stageStart;
+    stage.function(tick, stage.context);
+    const uint32_t execution = uint32_t(esp_timer_get_time() - stageStart);
+    stage.runs++;
+    stage.lastExecution = execution;
+    if (execution > stage.maxExecution) {
+      stage.maxExecution = execution;
+    }
+  }
+
+  const uint64_t end = esp_timer_get_time();
+  const uint32_t execution = uint32_t(end - now);
+  statistics.cycles++;
+  statistics.lastExecution = execution;
+  if (execution > statistics.maxExecution) {
+    statistics.maxExecution = execution;
+  }
+  statistics.lastLateness = tick.lateness;
+  if (tick.lateness > statistics.maxLateness) {
+    statistics.maxLateness = tick.lateness;
+  }
+  if (end > startTime + uint64_t(nextIndex) * period) {
+    statistics.deadlineMisses++;
+  }
+  return true;
+}
+
+// ------------------ Statistics ------------------
+
+uint32_t ControlScheduler::getPeriod() const { return period; }
+
+uint64_t ControlScheduler::getNextRelease() const
+{
+  return startTime + uint64_t(nextIndex) * period;
+}
+
+void ControlScheduler::getStatistics(Statistics &out) const
+{
+  out = statistics;
+}
+
+bool ControlScheduler::getStageStatistics(uint8_t index, StageStatistics &out) const
+{
+  if (index >= stageCount) {
+    return false;
+  }
+  const Stage &stage = stages[index];
+  out.name = stage.name;
+  out.runs = stage.runs;
+  out.lastExecution = stage.lastExecution;
+  out.maxExecution = stage.maxExecution;
+  return true;
+}
+
+void ControlScheduler::resetStatistics()
+{
+  statistics = Statistics();
+  for (uint8_t i = 0; i < stageCount; i++) {
+    stages[i].runs = 0;
+    stages[i].lastExecution = 0;
+    stages[i].maxExecution = 0;
+  }
+}
@@ -0,0 +1,128 @@
+#ifndef CONTROL_SCHEDULER_H
+#define CONTROL_SCHEDULER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <esp_timer.h>
+
+#ifdef ARDUINO
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+/*
+ * ControlScheduler — fixed-rate control loop released by a periodic timer
+ * -----------------------------------------------------------------------
+ * ‣ begin(periodUs) starts a periodic esp_timer (e.g. 10000 µs → 100 Hz,
+ *   1000 µs → 1 kHz). Cycle n is released (n + 1) periods after begin(),
+ *   whatever the previous cycles took, so the rate does not drift with
+ *   the work.
+ * ‣ run() (from loop()) waits for the next release, then calls every
+ *   registered stage in order in the calling task. poll() is the
+ *   non-blocking form: it runs a cycle only if one is due.
+ * ‣ Each stage gets a ControlTick with the µs start time of the cycle and
+ *   dt, the time since that stage last started, from esp_timer_get_time()
+ *   (µs resolution). A stage with divider d runs every d-th cycle.
+ * ‣ A cycle that ends after the next release is a deadline miss. If a cycle
+ *   starts more than a period late, the releases it overran are skipped
+ *   (counted, not replayed), and the next cycle keeps the original phase.
+ * ‣ The timer only wakes the waiting task; releases come from the clock.
+ *   On a host build the clock and the timer are those of the host platform
+ *   (a HostCANBus's virtual time, or a clock set with acanHostSetClock()),
+ *   so a test drives the schedule by advancing that clock and calling poll().
+ */
+
+struct ControlTick {
+    uint32_t cycle;          // release index since begin()
+    uint64_t releaseTime;    // µs, ideal start of this cycle
+    uint64_t startTime;      // µs, when the stages started
+    uint32_t lateness;       // µs, startTime − releaseTime
+    float    dt;             // s, since this stage last started (the period the first time)
+};
+
+typedef void (*ControlStage)(const ControlTick &tick, void *context);
+
+class ControlScheduler
+{
+public:
+  static const uint8_t MAX_STAGES = 8;
+
+  struct Statistics {
+    uint32_t cycles = 0;           // cycles run
+    uint32_t deadlineMisses = 0;   // cycles that ended after the next release
+    uint32_t skippedReleases = 0;  // releases overrun with no cycle of their own
+    uint32_t lastExecution = 0;    // µs, all stages of the last cycle
+    uint32_t maxExecution = 0;     // µs
+    uint32_t lastLateness = 0;     // µs, start − release
+    uint32_t maxLateness = 0;      // µs
+  };
+
+  struct StageStatistics {
+    const char *name = nullptr;
+    uint32_t runs = 0;
+    uint32_t lastExecution = 0;    // µs
+    uint32_t maxExecution = 0;     // µs
+  };
+
+  ControlScheduler() = default;
+  ~ControlScheduler();
+
+  ControlScheduler(const ControlScheduler &) = delete;
+  ControlScheduler &operator=(const ControlScheduler &) = delete;
+
+  // Stages run in the order they were added; before begin()
+  bool addStage(const char *name, ControlStage stage, void *context = nullptr, uint16_t divider = 1);
+
+  // Start / stop the release timer; the first cycle is due one period after begin()
+  bool begin(uint32_t periodUs);
+  void end();
+  bool isRunning() const;
+
+  // Wait for the next release and run that cycle
+  void run();
+  // Run a cycle if one is due; false → nothing to do yet
+  bool poll();
+
+  uint32_t getPeriod() const;
+  uint64_t getNextRelease() const;   // µs
+  void getStatistics(Statistics &out) const;
+  bool getStageStatistics(uint8_t stage, StageStatistics &out) const;
+  void resetStatistics();
+
+private:
+  struct Stage {
+    const char *name = nullptr;
+    ControlStage function = nullptr;
+    void *context = nullptr;
+    uint16_t divider = 1;
+    uint64_t lastStart = 0;        // µs, 0 → not run yet
+    uint32_t runs = 0;
+    uint32_t lastExecution = 0;
+    uint32_t maxExecution = 0;
+  };
+
+  static void timerCallback(void *scheduler);
+
+  Stage stages[MAX_STAGES];
+  uint8_t stageCount = 0;
+
+  uint32_t period = 10000;         // µs
+  esp_timer_handle_t timer = nullptr;
+  uint64_t startTime = 0;          // µs, release 0
+  uint32_t nextIndex = 0;          // release the next cycle is for
+  Statistics statistics;
+
+  // Wake-up of the task waiting in run()
+#ifdef ARDUINO
+  std::atomic<TaskHandle_t> waiting{nullptr};
+#else
+  std::mutex wakeLock;
+  std::condition_variable wake;
+  bool woken = false;
+#endif
+};
+
+#endif // CONTROL_SCHEDULER_H
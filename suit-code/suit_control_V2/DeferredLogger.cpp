@@ -0,0 +1,325 @@
+#include "DeferredLogger.h"
+
+#ifndef ARDUINO
+#include <chrono>
+#endif
+
+// -------------------------------------------------------------
+// Construction: slot count rounded up to a power of two
+// -------------------------------------------------------------
+DeferredLogger::DeferredLogger (uint16_t slotCount) {
+    uint16_t size = 1;
+    while (size < slotCount && size < 0x8000) {
+        size <<= 1;
+    }
+    slots = new Slot [size];
+    mask  = size - 1;
+    for (uint16_t i = 0; i < size; ++i) {
+        slots[i].sequence.store (i, std::memory_order_relaxed);
+    }
+}
+
+DeferredLogger::~DeferredLogger () {
+    end ();
+    delete [] slots;
+}
+
+// -------------------------------------------------------------
+// Drain task
+// -------------------------------------------------------------
+bool DeferredLogger::begin (Print &out, uint32_t intervalMs, uint8_t priority) {
+    if (running) {
+        return false;
+    }
+    outputs[0] = &out;
+    if (outputCount.load (std::memory_order_relaxed) == 0) {
+        outputCount.store (1, std::memory_order_release);
+    }
+    interval = (intervalMs > 0) ? intervalMs : 1;
+    running  = true;
+#ifdef ARDUINO
+    taskDone = false;
+    if (xTaskCreate (drainTask, "log", 4096, this, priority, &task) != pdPASS) {
+        task    = nullptr;
+        running = false;
+    }
+#else
+    (void) priority;   // Host threads run at the default priority
+    task = std::thread ([this] () {
+        while (running) {
+            drain ();
+            std::this_thread::sleep_for (std::chrono::milliseconds (interval));
+        }
+        drain ();
+    });
+#endif
+    return running;
+}
+
+void DeferredLogger::end () {
+    if (!running) {
+        return;
+    }
+    running = false;
+#ifdef ARDUINO
+    // The task finishes the pass it is in (a message may be half written),
+    // drains what is left and deletes itself; wait for it, as for the host
+    // thread
+    while (!taskDone) {
+        vTaskDelay (1);
+    }
+    task = nullptr;
+#else
+    task.join ();
+#endif
+}
+
+bool DeferredLogger::isRunning () const {
+    return running;
+}
+
+bool DeferredLogger::addOutput (Print &out) {
+    // After begin(), which owns outputs[0]; the drain reads up to the count
+    const uint8_t count = outputCount.load (std::memory_order_relaxed);
+    if (count == 0 || count >= MAX_OUTPUTS) {
+        return false;
+    }
+    outputs[count] = &out;
+    outputCount.store (count + 1, std::memory_order_release);
+    return true;
+}
+
+#ifdef ARDUINO
+void DeferredLogger::drainTask (void *logger) {
+    DeferredLogger &self = *static_cast<DeferredLogger *>(logger);
+    while (self.running) {
+        self.drain ();
+        vTaskDelay (pdMS_TO_TICKS (self.interval));
+    }
+    self.drain ();
+    // Last access to self: end() returns, and the logger may go, from here
+    self.taskDone = true;
+    vTaskDelete (nullptr);
+}
+#endif
+
+// -------------------------------------------------------------
+// Producer side: bounded multi-producer ring; each slot's
+// sequence says whose turn it is (position → free for that
+// producer, position + 1 → published for the consumer)
+// -------------------------------------------------------------
+DeferredLogger::Slot *DeferredLogger::claim (uint32_t &position) {
+    position = enqueuePosition.load (std::memory_order_relaxed);
+    for (;;) {
+        Slot &slot = slots[position & mask];
+        const int32_t lag = int32_t (slot.sequence.load (std::memory_order_acquire) - position);
+        if (lag == 0) {
+            if (enqueuePosition.compare_exchange_weak (position, position + 1,
+                                                       std::memory_order_relaxed)) {
+                logged.fetch_add (1, std::memory_order_relaxed);
+                return &slot;
+            }
+        } else if (lag < 0) {
+            dropped.fetch_add (1, std::memory_order_relaxed);   // Full
+            return nullptr;
+        } else {
+            position = enqueuePosition.load (std::memory_order_relaxed);
+        }
+    }
+}
+
+bool DeferredLogger::logText (const char *text) {
+    uint32_t position;
+    Slot *slot = claim (position);
+    if (slot == nullptr) {
+        return false;
+    }
+    char *copy = reinterpret_cast<char *> (slot->values);
+    size_t length = 0;
+    while (text != nullptr && text[length] != '\0' && length < TEXT_LENGTH) {
+        copy[length] = text[length];
+        ++length;
+    }
+    copy[length] = '\0';
+    slot->format = nullptr;
+    slot->count  = TEXT_COPY;
+    slot->sequence.store (position + 1, std::memory_order_release);
+    return true;
+}
+
+// -------------------------------------------------------------
+// Consumer side
+// -------------------------------------------------------------
+uint32_t DeferredLogger::drain () {
+    return drainTo (outputs, outputCount.load (std::memory_order_acquire));
+}
+
+uint32_t DeferredLogger::drain (Print &out) {
+    Print *const single[] = { &out };
+    return drainTo (single, 1);
+}
+
+uint32_t DeferredLogger::drainTo (Print *const *targets, uint8_t count) {
+    uint32_t printed = 0;
+    char text[MESSAGE_LENGTH];
+    while (!held.load (std::memory_order_relaxed)) {
+        Slot &slot = slots[dequeuePosition & mask];
+        if (slot.sequence.load (std::memory_order_acquire) != dequeuePosition + 1) {
+            break;   // Empty, or the next message is still being written
+        }
+        // One message per line, as RemoteDebug always printed them
+        size_t length = format (slot, text, sizeof (text) - 1);
+        if (length == 0 || text[length - 1] != '\n') {
+            text[length++] = '\n';
+        }
+        // Hand the slot back to the producers one lap later
+        slot.sequence.store (dequeuePosition + mask + 1, std::memory_order_release);
+        ++dequeuePosition;
+        for (uint8_t i = 0; i < count; ++i) {
+            targets[i]->write (reinterpret_cast<const uint8_t *> (text), length);
+        }
+        ++printed;
+    }
+    for (uint8_t i = 1; i < count; ++i) {
+        targets[i]->flush ();   // Extra outputs: send what they batched
+    }
+    return printed;
+}
+
+void DeferredLogger::setHeld (bool hold) {
+    held.store (hold, std::memory_order_relaxed);
+}
+
+uint32_t DeferredLogger::getLoggedCount () const {
+    return logged.load (std::memory_order_relaxed);
+}
+
+uint32_t DeferredLogger::getDroppedCount () const {
+    return dropped.load (std::memory_order_relaxed);
+}
+
+uint16_t DeferredLogger::getPendingCount () const {
+    return uint16_t (enqueuePosition.load (std::memory_order_relaxed) - dequeuePosition);
+}
+
+// -------------------------------------------------------------
+// Formatting: one snprintf per conversion, with the length
+// modifier taken from the stored argument type
+// -------------------------------------------------------------
+size_t DeferredLogger::format (const Slot &slot, char *out, size_t size) {
+    if (slot.count == TEXT_COPY) {
+        const char *text = reinterpret_cast<const char *> (slot.values);
+        const size_t length = strnlen (text, size - 1);
+        memcpy (out, text, length);
+        out[length] = '\0';
+        return length;
+    }
+
+    const char *p = slot.format;
+    uint8_t next = 0;
+    size_t length = 0;
+
+    auto append = [&] (int written) {
+        if (written > 0) {
+            length += size_t (written);
+            if (length > size - 1) {
+                length = size - 1;   // Truncated
+            }
+        }
+    };
+    auto integerArgument = [&] () -> int64_t {
+        if (next >= slot.count) {
+            return 0;
+        }
+        const uint8_t index = next++;
+        return (slot.types[index] == REAL) ? int64_t (slot.values[index].d) : slot.values[index].i;
+    };
+
+    while (p != nullptr && *p != '\0' && length < size - 1) {
+        if (*p != '%') {
+            out[length++] = *p++;
+            continue;
+        }
+        if (p[1] == '%') {
+            out[length++] = '%';
+            p += 2;
+            continue;
+        }
+
+        // %[flags][width][.precision][length]conversion → spec
+        char spec[48];
+        size_t s = 0;
+        spec[s++] = *p++;
+        while (*p != '\0' && strchr ("-+ #0", *p) != nullptr && s < 8) {
+            spec[s++] = *p++;
+        }
+        for (int part = 0; part < 2; ++part) {
+            if (part == 1) {
+                if (*p != '.') {
+                    break;
+                }
+                spec[s++] = *p++;
+            }
+            if (*p == '*') {
+                s += snprintf (spec + s, 12, "%d", int (integerArgument ()));
+                ++p;
+            } else {
+                while (*p >= '0' && *p <= '9' && s < 20) {
+                    spec[s++] = *p++;
+                }
+            }
+        }
+        while (*p != '\0' && strchr ("hlLqjzt", *p) != nullptr) {
+            ++p;
+        }
+        const char conversion = *p;
+        if (conversion == '\0') {
+            break;
+        }
+        ++p;
+
+        if (next >= slot.count) {
+            append (snprintf (out + length, size - length, "<?>"));
+            continue;
+        }
+        const ArgumentType type = slot.types[next];
+        const Value &argument   = slot.values[next++];
+        switch (conversion) {
+        case 'd': case 'i':
+            spec[s++] = 'l'; spec[s++] = 'l'; spec[s++] = conversion; spec[s] = '\0';
+            append (snprintf (out + length, size - length, spec,
+                              (long long) (type == REAL ? int64_t (argument.d) : argument.i)));
+            break;
+        case 'u': case 'o': case 'x': case 'X':
+            spec[s++] = 'l'; spec[s++] = 'l'; spec[s++] = conversion; spec[s] = '\0';
+            append (snprintf (out + length, size - length, spec,
+                              (unsigned long long) (type == REAL ? uint64_t (argument.d) : argument.u)));
+            break;
+        case 'c':
+            spec[s++] = 'c'; spec[s] = '\0';
+            append (snprintf (out + length, size - length, spec, int (argument.i)));
+            break;
+        case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+            spec[s++] = conversion; spec[s] = '\0';
+            append (snprintf (out + length, size - length, spec,
+                              type == REAL     ? argument.d
+                            : type == UNSIGNED ? double (argument.u)
+                            :                             double (argument.i)));
+            break;
+        case 's':
+            spec[s++] = 's'; spec[s] = '\0';
+            append (snprintf (out + length, size - length, spec,
+                              (type == STRING && argument.s != nullptr) ? argument.s : "(null)"));
+            break;
+        case 'p':
+            spec[s++] = 'p'; spec[s] = '\0';
+            append (snprintf (out + length, size - length, spec, argument.p));
+            break;
+        default:
+            append (snprintf (out + length, size - length, "<%c?>", conversion));
+            break;
+        }
+    }
+    out[length] = '\0';
+    return length;
+}
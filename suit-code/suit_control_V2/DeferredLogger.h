@@ -0,0 +1,170 @@
+#ifndef DEFERRED_LOGGER_H
+#define DEFERRED_LOGGER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <type_traits>
+
+#ifdef ARDUINO
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#else
+#include <thread>
+#endif
+
+/*
+ * DeferredLogger — printf-style logging that does not block the caller
+ * --------------------------------------------------------------------
+ * ‣ log(format, args...) stores the format pointer and the raw arguments
+ *   (integers, floating point, pointers) in a fixed-size slot of a
+ *   lock-free ring. Nothing is formatted and nothing is printed at the
+ *   call site. The cost is the same for any message length.
+ * ‣ A low-priority task (a thread on host builds) drains the ring every
+ *   few milliseconds. It formats each message with snprintf and writes it
+ *   to the output, one message per line (a missing final newline is
+ *   added). drain() can also be called directly.
+ * ‣ When the ring is full the message is dropped and counted
+ *   (getDroppedCount()), and the caller is never held up.
+ * ‣ The format string and %s arguments are kept as pointers. They must
+ *   still be valid when the message is printed, so use string literals or
+ *   static buffers.
+ * ‣ Conversions: d i u o x X c e E f F g G a A s p and %%, with flags,
+ *   width and precision (also *). Length modifiers are accepted and
+ *   ignored, because the argument's own type is stored. At most
+ *   MAX_ARGUMENTS arguments per message, checked at compile time.
+ * ‣ logText(text) copies the text instead (up to TEXT_LENGTH characters),
+ *   for strings that will not outlive the call.
+ * ‣ Extra outputs (addOutput()) get every message as well, and are
+ *   flushed after every drain pass, so an output that batches messages
+ *   (UDPLogTransport) sends what it collected. The first output is never
+ *   flushed, because Serial.flush() waits for the UART.
+ * ‣ Several tasks may log at once (multi-producer, single consumer).
+ */
+
+class DeferredLogger {
+public:
+    static const uint8_t  MAX_ARGUMENTS   = 8;
+    static const uint16_t MESSAGE_LENGTH  = 128;   // formatted, incl. the terminator
+    static const uint16_t DEFAULT_SLOTS   = 64;
+    static const uint8_t  MAX_OUTPUTS     = 3;
+    static const uint8_t  TEXT_LENGTH     = 63;    // logText(), in the argument space
+
+    explicit DeferredLogger(uint16_t slotCount = DEFAULT_SLOTS);
+    ~DeferredLogger();
+
+    DeferredLogger(const DeferredLogger&) = delete;
+    DeferredLogger& operator=(const DeferredLogger&) = delete;
+
+    // Start / stop the drain task, which prints to out every intervalMs
+    bool begin(Print& out, uint32_t intervalMs = 10, uint8_t priority = 1);
+    void end();
+    bool isRunning() const;
+
+    // Also print to out, after begin() (MAX_OUTPUTS in all, begin()'s included)
+    bool addOutput(Print& out);
+
+    // Queue one message; false → ring full, message dropped
+    template <typename... Args>
+    bool log(const char* format, Args... args) {
+        static_assert(sizeof...(Args) <= MAX_ARGUMENTS, "too many arguments for a deferred log message");
+        uint32_t position;
+        Slot* slot = claim(position);
+        if (slot == nullptr) {
+            return false;
+        }
+        slot->format = format;
+        slot->count  = sizeof...(Args);
+        uint8_t index = 0;
+        const int expand[] = { 0, (store(slot->types[index], slot->values[index], args), ++index)... };
+        (void) expand;
+        (void) index;
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Queue a copy of text (truncated to TEXT_LENGTH); false → ring full
+    bool logText(const char* text);
+
+    // Format and print every queued message (the task does this); returns
+    // the number printed. Only one drain at a time.
+    uint32_t drain();
+    uint32_t drain(Print& out);
+
+    // While held, the drain leaves messages queued (e.g. while something
+    // else owns the serial port)
+    void setHeld(bool held);
+
+    uint32_t getLoggedCount() const;    // queued since construction
+    uint32_t getDroppedCount() const;   // ring full
+    uint16_t getPendingCount() const;
+
+private:
+    enum ArgumentType : uint8_t { SIGNED, UNSIGNED, REAL, STRING, POINTER };
+
+    union Value {
+        int64_t     i;
+        uint64_t    u;
+        double      d;
+        const char* s;
+        const void* p;
+    };
+
+    static_assert(sizeof(Value) * MAX_ARGUMENTS > TEXT_LENGTH, "logText() copies into the values");
+
+    // Slot::count of a logText() slot, whose text is kept in the values
+    static const uint8_t TEXT_COPY = 0xFF;
+
+    // 88 bytes on the ESP32
+    struct Slot {
+        std::atomic<uint32_t> sequence{0};   // position + 1 once published
+        const char*           format = nullptr;
+        uint8_t               count = 0;
+        ArgumentType          types[MAX_ARGUMENTS];
+        Value                 values[MAX_ARGUMENTS];
+    };
+
+    // Argument capture, by type
+    template <typename T>
+    static typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type
+    store(ArgumentType& type, Value& value, T argument) { type = SIGNED; value.i = argument; }
+
+    template <typename T>
+    static typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type
+    store(ArgumentType& type, Value& value, T argument) { type = UNSIGNED; value.u = argument; }
+
+    template <typename T>
+    static typename std::enable_if<std::is_enum<T>::value>::type
+    store(ArgumentType& type, Value& value, T argument) { type = SIGNED; value.i = int64_t(argument); }
+
+    static void store(ArgumentType& type, Value& value, double argument) { type = REAL; value.d = argument; }
+    static void store(ArgumentType& type, Value& value, const char* argument) { type = STRING; value.s = argument; }
+
+    template <typename T>
+    static void store(ArgumentType& type, Value& value, const T* argument) { type = POINTER; value.p = argument; }
+
+    Slot* claim(uint32_t& position);
+    uint32_t drainTo(Print* const* targets, uint8_t count);   // flushes all but the first
+    static size_t format(const Slot& slot, char* out, size_t size);
+
+#ifdef ARDUINO
+    static void drainTask(void* logger);
+    TaskHandle_t      task = nullptr;
+    std::atomic<bool> taskDone{false};     // the task's last access before it deletes itself
+#else
+    std::thread task;
+#endif
+
+    Slot*                 slots;
+    uint16_t              mask;                 // slot count − 1
+    std::atomic<uint32_t> enqueuePosition{0};
+    uint32_t              dequeuePosition = 0;  // drain side only
+    std::atomic<uint32_t> logged{0};
+    std::atomic<uint32_t> dropped{0};
+    std::atomic<bool>     held{false};
+    std::atomic<bool>     running{false};
+    Print*                outputs[MAX_OUTPUTS] = {};
+    std::atomic<uint8_t>  outputCount{0};
+    uint32_t              interval = 10;        // ms
+};
+
+#endif  // DEFERRED_LOGGER_H
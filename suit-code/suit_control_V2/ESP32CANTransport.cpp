@@ -0,0 +1,93 @@
+#include "ESP32CANTransport.h"
+
+// -------------------------------------------------------------
+// Construction
+// -------------------------------------------------------------
+ESP32CANTransport::ESP32CANTransport (ACAN_ESP32 &driver) : driver (driver) {
+}
+
+ESP32CANTransport& ESP32CANTransport::instance () {
+    static ESP32CANTransport transport (ACAN_ESP32::can);
+    return transport;
+}
+
+ACAN_ESP32& ESP32CANTransport::getDriver () {
+    return driver;
+}
+
+// -------------------------------------------------------------
+// Controller start: settings and acceptance filter
+// -------------------------------------------------------------
+uint32_t ESP32CANTransport::begin (uint8_t txPin, uint8_t rxPin, uint32_t bitRate,
+                                   const CANFilterPlan &plan) {
+
+    ACAN_ESP32_Settings settings (bitRate);
+
+#ifdef ARDUINO
+    // Cast uint8_t → gpio_num_t
+    settings.mTxPin = static_cast<gpio_num_t>(txPin);
+    settings.mRxPin = static_cast<gpio_num_t>(rxPin);
+#else
+    (void) txPin;   // No pins on the emulated controller
+    (void) rxPin;
+#endif
+
+    settings.mRequestedCANMode = ACAN_ESP32_Settings::NormalMode;
+    settings.useStaticReceiveBuffer (receiveStorage);
+    settings.useStaticTransmitBuffer (transmitStorage);
+    settings.useStaticControlTransmitBuffer (controlTransmitStorage);
+    settings.useStaticBackgroundTransmitBuffer (backgroundTransmitStorage);
+
+    ACAN_ESP32_Filter filter = ACAN_ESP32_Filter::acceptAll ();
+    if (plan.dual) {
+        filter = ACAN_ESP32_Filter::dualStandardFilter (
+            ACAN_ESP32_Filter::data, plan.filter[0].code, plan.filter[0].dontCare,
+            ACAN_ESP32_Filter::data, plan.filter[1].code, plan.filter[1].dontCare);
+    } else if (!plan.acceptAll) {
+        filter = ACAN_ESP32_Filter::singleStandardFilter (
+            ACAN_ESP32_Filter::data, plan.filter[0].code, plan.filter[0].dontCare);
+    }
+
+    return driver.begin (settings, filter);
+}
+
+// -------------------------------------------------------------
+// Transmit / receive
+// -------------------------------------------------------------
+ACAN_ESP32::TransmitPriority ESP32CANTransport::driverPriority (CAN_PRIORITY priority) {
+    switch (priority) {
+    case CAN_PRIORITY_CONTROL:    return ACAN_ESP32::control;
+    case CAN_PRIORITY_BACKGROUND: return ACAN_ESP32::background;
+    default:                      return ACAN_ESP32::normal;
+    }
+}
+
+bool ESP32CANTransport::send (const CANMessage &message, CAN_PRIORITY priority) {
+    return driver.tryToSend (message, driverPriority (priority));
+}
+
+uint32_t ESP32CANTransport::sendBurst (const CANMessage messages[], uint32_t count,
+                                       CAN_PRIORITY priority) {
+    // Enqueued in one pass, so the frames leave back-to-back
+    return driver.tryToSendBurst (messages, count, driverPriority (priority));
+}
+
+uint32_t ESP32CANTransport::drain (DrainRoutine routine, void *context) {
+    return driver.drain (routine, context);
+}
+
+bool ESP32CANTransport::subscribe (ACAN_ESP32_Subscription &slot) {
+    return driver.subscribe (slot);
+}
+
+bool ESP32CANTransport::subscribeTransmit (ACAN_ESP32_Subscription &slot) {
+    return driver.subscribeTransmit (slot);
+}
+
+void ESP32CANTransport::unsubscribe (const ACAN_ESP32_Subscription &slot) {
+    driver.unsubscribe (slot);
+}
+
+void ESP32CANTransport::unsubscribeTransmit (const ACAN_ESP32_Subscription &slot) {
+    driver.unsubscribeTransmit (slot);
+}
@@ -0,0 +1,56 @@
+#ifndef ESP32_CAN_TRANSPORT_H
+#define ESP32_CAN_TRANSPORT_H
+
+#include <ACAN_ESP32.h>
+#include "CANTransport.h"
+
+/*
+ * ESP32CANTransport — CANTransport over the ACAN_ESP32 driver
+ * -----------------------------------------------------------
+ * ‣ instance() wraps ACAN_ESP32::can and is what CANHandler uses by default.
+ * ‣ Subscriptions are passed to the driver, so the RX interrupt fills them.
+ * ‣ The driver buffers live in the transport (static storage for
+ *   instance()), sized at compile time: begin() allocates nothing and
+ *   cannot fail for lack of memory.
+ * ‣ On a host build the same driver runs on the emulated TWAI controller
+ *   (host/ACAN_ESP32_EmulatedTWAI.h); the pin arguments are then ignored.
+ */
+
+class ESP32CANTransport : public CANTransport {
+public:
+    // Driver buffer sizes (powers of two)
+    static const uint16_t RECEIVE_BUFFER_SIZE             = 32;
+    static const uint16_t TRANSMIT_BUFFER_SIZE            = 16;
+    static const uint16_t CONTROL_TRANSMIT_BUFFER_SIZE    = 16;
+    static const uint16_t BACKGROUND_TRANSMIT_BUFFER_SIZE = 8;
+
+    explicit ESP32CANTransport(ACAN_ESP32& driver);
+
+    // Transport for ACAN_ESP32::can
+    static ESP32CANTransport& instance();
+
+    uint32_t begin(uint8_t txPin, uint8_t rxPin, uint32_t bitRate,
+                   const CANFilterPlan& filter) override;
+    bool     send(const CANMessage& message,
+                  CAN_PRIORITY priority = CAN_PRIORITY_NORMAL) override;
+    uint32_t sendBurst(const CANMessage messages[], uint32_t count,
+                       CAN_PRIORITY priority = CAN_PRIORITY_NORMAL) override;
+    uint32_t drain(DrainRoutine routine, void* context) override;
+    bool     subscribe(ACAN_ESP32_Subscription& slot) override;
+    bool     subscribeTransmit(ACAN_ESP32_Subscription& slot) override;
+    void     unsubscribe(const ACAN_ESP32_Subscription& slot) override;
+    void     unsubscribeTransmit(const ACAN_ESP32_Subscription& slot) override;
+
+    ACAN_ESP32& getDriver();
+
+private:
+    static ACAN_ESP32::TransmitPriority driverPriority(CAN_PRIORITY priority);
+
+    ACAN_ESP32& driver;
+    ACAN_ESP32_BufferStorage<RECEIVE_BUFFER_SIZE>             receiveStorage;
+    ACAN_ESP32_BufferStorage<TRANSMIT_BUFFER_SIZE>            transmitStorage;
+    ACAN_ESP32_BufferStorage<CONTROL_TRANSMIT_BUFFER_SIZE>    controlTransmitStorage;
+    ACAN_ESP32_BufferStorage<BACKGROUND_TRANSMIT_BUFFER_SIZE> backgroundTransmitStorage;
+};
+
+#endif  // ESP32_CAN_TRANSPORT_H
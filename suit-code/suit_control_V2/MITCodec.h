@@ -0,0 +1,143 @@
+#ifndef MIT_CODEC_H
+#define MIT_CODEC_H
+
+#include <stdint.h>
+#include <math.h>
+
+/*
+ * MITCodec — compile-time specialised MIT-mode frame codec
+ * --------------------------------------------------------
+ * ‣ Each field's range and bit width are template parameters, so every
+ *   scale factor and reciprocal is a compile-time constant and the
+ *   per-frame work is a handful of single-precision multiply-adds.
+ * ‣ Ranges are given as integers over kScale, e.g. MITField<-125, 125, 16, 10>
+ *   is a 16-bit field spanning ±12.5.
+ * ‣ Results are bit-identical to the old double-precision
+ *   floatToUInt / uintToFloat conversions:
+ *     encode — truncation of (x - min) * (2^bits - 1) / span, corrected with
+ *              an exact fmaf() residual so the boundary codes never slip.
+ *     decode — code * span / (2^bits - 1) + min with a single rounding,
+ *              carried as a float-float pair to reproduce the double result.
+ *   This relies on code * span being exact in a float (span * 2^bits < 2^24),
+ *   which holds for every AK-series range.
+ */
+
+template <int32_t kMin, int32_t kMax, uint8_t kBits, int32_t kScale = 1>
+struct MITField {
+  static_assert(kMax > kMin, "MITField: empty range");
+  static_assert(kBits > 0 && kBits <= 16, "MITField: width must be 1..16 bits");
+
+  static constexpr uint32_t kMaxCode = (1UL << kBits) - 1;
+  static constexpr float    kLow     = float(kMin) / float(kScale);
+  static constexpr float    kHigh    = float(kMax) / float(kScale);
+  static constexpr float    kSpan    = float(kMax - kMin) / float(kScale);
+  static constexpr float    kCodes   = float(kMaxCode);
+  static constexpr float    kToCode  = float(double(kMaxCode) * kScale / (kMax - kMin));
+  static constexpr float    kInvCode = float(1.0 / kMaxCode);
+
+  // Clamp to the field range and quantise.
+  static inline uint32_t encode(float x) {
+    x = (x < kLow) ? kLow : ((x > kHigh) ? kHigh : x);
+    const float offset = x - kLow;
+    uint32_t code = static_cast<uint32_t>(offset * kToCode);
+    // The estimate can be one code off either way; settle it exactly.
+    if (fmaf(offset, kCodes, -float(code) * kSpan) < 0.0f) {
+      code -= 1;
+    } else if (code < kMaxCode && fmaf(offset, kCodes, -float(code + 1) * kSpan) >= 0.0f) {
+      code += 1;
+    }
+    return code;
+  }
+
+  static inline float decode(uint32_t code) {
+    const float product  = float(code) * kSpan;               // exact
+    const float quotient = product * kInvCode;
+    const float residual = fmaf(-quotient, kCodes, product);   // product - quotient * codes, exact
+    // Two-sum of quotient + kLow, then fold in both error terms.
+    const float sum      = quotient + kLow;
+    const float virt     = sum - quotient;
+    const float error    = (quotient - (sum - virt)) + (kLow - virt);
+    return sum + fmaf(residual, kInvCode, error);
+  }
+};
+
+/*
+ * MITCodec — bit layout of an 8-byte MIT-mode frame
+ *   Bytes 0-1: Position (16 bits)
+ *   Bytes 2-3: Velocity (12 bits: upper 8 bits in data[2], high nibble in data[3])
+ *   Bytes 3-4: KP (12 bits)
+ *   Bytes 5-6: KD (12 bits)
+ *   Bytes 6-7: Torque/Current (12 bits)
+ */
+
+template <class Position, class Velocity, class Kp, class Kd, class Torque>
+struct MITCodec {
+  typedef Position PositionField;
+  typedef Velocity VelocityField;
+  typedef Kp       KpField;
+  typedef Kd       KdField;
+  typedef Torque   TorqueField;
+
+  static inline void pack(uint8_t data[8], float p_des, float v_des, float kp, float kd, float t_ff) {
+    const uint32_t p_int  = Position::encode(p_des);
+    const uint32_t v_int  = Velocity::encode(v_des);
+    const uint32_t kp_int = Kp::encode(kp);
+    const uint32_t kd_int = Kd::encode(kd);
+    const uint32_t t_int  = Torque::encode(t_ff);
+
+    data[0] = p_int >> 8;
+    data[1] = p_int & 0xFF;
+    data[2] = v_int >> 4;
+    data[3] = ((v_int & 0xF) << 4) | (kp_int >> 8);
+    data[4] = kp_int & 0xFF;
+    data[5] = kd_int >> 4;
+    data[6] = ((kd_int & 0xF) << 4) | (t_int >> 8);
+    data[7] = t_int & 0xFF;
+  }
+
+  static inline void unpack(const uint8_t data[8], float &position, float &velocity, float &torque) {
+    const uint32_t p_int = (uint32_t(data[0]) << 8) | data[1];
+    const uint32_t v_int = (uint32_t(data[2]) << 4) | (data[3] >> 4);
+    const uint32_t t_int = (uint32_t(data[6] & 0x0F) << 8) | data[7];
+
+    position = Position::decode(p_int);
+    velocity = Velocity::decode(v_int);
+    torque   = Torque::decode(t_int);
+  }
+
+  // Inverse of pack(): what a motor reads out of a command frame.
+  static inline void unpackCommand(const uint8_t data[8], float &p_des, float &v_des,
+                                   float &kp, float &kd, float &t_ff) {
+    p_des = Position::decode((uint32_t(data[0]) << 8) | data[1]);
+    v_des = Velocity::decode((uint32_t(data[2]) << 4) | (data[3] >> 4));
+    kp    = Kp::decode((uint32_t(data[3] & 0x0F) << 8) | data[4]);
+    kd    = Kd::decode((uint32_t(data[5]) << 4) | (data[6] >> 4));
+    t_ff  = Torque::decode((uint32_t(data[6] & 0x0F) << 8) | data[7]);
+  }
+
+  // Inverse of unpack(): a feedback frame as the motor sends it
+  // (bits unpack() does not read are left at zero).
+  static inline void packFeedback(uint8_t data[8], float position, float velocity, float torque) {
+    const uint32_t p_int = Position::encode(position);
+    const uint32_t v_int = Velocity::encode(velocity);
+    const uint32_t t_int = Torque::encode(torque);
+
+    data[0] = p_int >> 8;
+    data[1] = p_int & 0xFF;
+    data[2] = v_int >> 4;
+    data[3] = (v_int & 0xF) << 4;
+    data[4] = 0;
+    data[5] = 0;
+    data[6] = t_int >> 8;
+    data[7] = t_int & 0xFF;
+  }
+};
+
+// AK-series limits used by Motor (P ±40 rad, V ±50 rad/s, T ±25 Nm, Kp 0-500, Kd 0-5)
+typedef MITCodec<MITField<-40, 40, 16>,
+                 MITField<-50, 50, 12>,
+                 MITField<0, 500, 12>,
+                 MITField<0, 5, 12>,
+                 MITField<-25, 25, 12> > AKMotorCodec;
+
+#endif // MIT_CODEC_H
@@ -0,0 +1,134 @@
+#include "MITCodecBenchmark.h"
+
+#ifdef MIT_CODEC_BENCHMARK
+
+#include "MITCodec.h"
+
+// ------------------ Old Conversions ------------------
+
+// Motor::floatToUInt / Motor::uintToFloat before MITCodec (also the
+// oracle of host/MITCodecTest.cpp)
+static int floatToUInt(float x, float x_min, float x_max, unsigned int bits)
+{
+  float span = x_max - x_min;
+  float offset = x_min;
+  unsigned int result = 0;
+
+  if (bits == 12) {
+    result = static_cast<unsigned int>((x - offset) * 4095.0 / span);
+  }
+  else if (bits == 16) {
+    result = static_cast<unsigned int>((x - offset) * 65535.0 / span);
+  }
+  return result;
+}
+
+static float uintToFloat(int x_int, float x_min, float x_max, int bits)
+{
+  float span = x_max - x_min;
+  float offset = x_min;
+  float result = 0.0;
+
+  if (bits == 12) {
+    result = static_cast<float>(x_int) * span / 4095.0 + offset;
+  }
+  else if (bits == 16) {
+    result = static_cast<float>(x_int) * span / 65535.0 + offset;
+  }
+  return result;
+}
+
+static void packWithDoubles(uint8_t data[8], float p, float v, float kp, float kd, float t)
+{
+  const unsigned p_int  = floatToUInt(p,  -40.0f, 40.0f, 16);
+  const unsigned v_int  = floatToUInt(v,  -50.0f, 50.0f, 12);
+  const unsigned kp_int = floatToUInt(kp, 0.0f, 500.0f, 12);
+  const unsigned kd_int = floatToUInt(kd, 0.0f, 5.0f, 12);
+  const unsigned t_int  = floatToUInt(t,  -25.0f, 25.0f, 12);
+  data[0] = p_int >> 8;
+  data[1] = p_int & 0xFF;
+  data[2] = v_int >> 4;
+  data[3] = ((v_int & 0xF) << 4) | (kp_int >> 8);
+  data[4] = kp_int & 0xFF;
+  data[5] = kd_int >> 4;
+  data[6] = ((kd_int & 0xF) << 4) | (t_int >> 8);
+  data[7] = t_int & 0xFF;
+}
+
+static void unpackWithDoubles(const uint8_t data[8], float &p, float &v, float &t)
+{
+  p = uintToFloat((data[0] << 8) | data[1], -40.0f, 40.0f, 16);
+  v = uintToFloat((data[2] << 4) | (data[3] >> 4), -50.0f, 50.0f, 12);
+  t = uintToFloat(((data[6] & 0x0F) << 8) | data[7], -25.0f, 25.0f, 12);
+}
+
+// ------------------ Timing ------------------
+
+// Inputs come from tables filled at run time, so nothing is folded at
+// compile time
+static const uint16_t TABLE_SIZE = 256;
+static const uint32_t FRAMES = 20000;
+
+struct BenchmarkCommand {
+  float p, v, kp, kd, t;
+};
+
+static BenchmarkCommand commands[TABLE_SIZE];
+static uint8_t frames[TABLE_SIZE][8];
+static volatile float sink;
+
+static float randomIn(float low, float high)
+{
+  return low + (high - low) * float(random(0x1000000)) * (1.0f / 16777216.0f);
+}
+
+template <class Function>
+static float cyclesPerFrame(Function function)
+{
+  const uint32_t start = ESP.getCycleCount();
+  for (uint32_t i = 0; i < FRAMES; i++) {
+    function(i % TABLE_SIZE);
+  }
+  return float(ESP.getCycleCount() - start) / FRAMES;
+}
+
+void runMITCodecBenchmark(Print &out)
+{
+  for (uint16_t i = 0; i < TABLE_SIZE; i++) {
+    commands[i] = { randomIn(-40, 40), randomIn(-50, 50), randomIn(0, 500),
+                    randomIn(0, 5), randomIn(-25, 25) };
+    for (uint8_t j = 0; j < 8; j++) {
+      frames[i][j] = uint8_t(random(256));
+    }
+  }
+
+  uint8_t data[8];
+  float p, v, t;
+  const float codecPack = cyclesPerFrame([&](uint16_t i) {
+    const BenchmarkCommand &c = commands[i];
+    AKMotorCodec::pack(data, c.p, c.v, c.kp, c.kd, c.t);
+    sink = data[1] + data[4] + data[7];
+  });
+  const float doublePack = cyclesPerFrame([&](uint16_t i) {
+    const BenchmarkCommand &c = commands[i];
+    packWithDoubles(data, c.p, c.v, c.kp, c.kd, c.t);
+    sink = data[1] + data[4] + data[7];
+  });
+  const float codecUnpack = cyclesPerFrame([&](uint16_t i) {
+    AKMotorCodec::unpack(frames[i], p, v, t);
+    sink = p + v + t;
+  });
+  const float doubleUnpack = cyclesPerFrame([&](uint16_t i) {
+    unpackWithDoubles(frames[i], p, v, t);
+    sink = p + v + t;
+  });
+
+  const float mhz = float(getCpuFrequencyMhz());
+  out.printf("MITCodec benchmark, cycles (ns) per frame at %.0f MHz:\n", mhz);
+  out.printf("  pack   : MITCodec %.0f (%.0f), double conversions %.0f (%.0f)\n",
+             codecPack, codecPack * 1000.0f / mhz, doublePack, doublePack * 1000.0f / mhz);
+  out.printf("  unpack : MITCodec %.0f (%.0f), double conversions %.0f (%.0f)\n",
+             codecUnpack, codecUnpack * 1000.0f / mhz, doubleUnpack, doubleUnpack * 1000.0f / mhz);
+}
+
+#endif // MIT_CODEC_BENCHMARK
@@ -0,0 +1,23 @@
+#ifndef MIT_CODEC_BENCHMARK_H
+#define MIT_CODEC_BENCHMARK_H
+
+#include <Arduino.h>
+
+/*
+ * MITCodecBenchmark — MITCodec against the old conversions, on the ESP32
+ * ----------------------------------------------------------------------
+ * ‣ The ESP32 FPU is single precision only, so the double-precision
+ *   floatToUInt / uintToFloat that Motor used before MITCodec run in
+ *   software there. This times pack / unpack of a whole frame both ways,
+ *   in CPU cycles (ESP.getCycleCount()), on the target itself.
+ * ‣ Only built with MIT_CODEC_BENCHMARK defined (build_opt.h:
+ *   -DMIT_CODEC_BENCHMARK); setup() then runs it once and prints to Serial.
+ * ‣ host/MITCodecTest checks that both give the same codes; a host timing
+ *   would say nothing here, x86 has double-precision hardware.
+ */
+
+#ifdef MIT_CODEC_BENCHMARK
+void runMITCodecBenchmark(Print &out);
+#endif
+
+#endif // MIT_CODEC_BENCHMARK_H
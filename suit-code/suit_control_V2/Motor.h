@@ -2,7 +2,9 @@
 #define MOTOR_H
 
 //#include "ACAN_ESP32.h"
+#include <atomic>
 #include "CANHandler.h"
+#include "MITCodec.h"
 #include "RemoteDebug.h"
 
 // Define control mode IDs if not already defined:
@@ -20,6 +22,10 @@ class Motor
 {
 public:
   Motor(uint16_t ID, CANHandler &canHandler, RemoteDebug &Debug);
+  ~Motor();  // Hands the feedback and command slots back to the driver
+
+  Motor(const Motor &) = delete;
+  Motor &operator=(const Motor &) = delete;
 
   void start();
   void stop();
@@ -41,38 +47,64 @@ public:
   int getTemperature() const;  // Changed to signed int so that subtraction works correctly.
   uint8_t getErrorCode() const;
   bool isOnline() const;
+  uint32_t getFeedbackTime() const;  // µs arrival time of the latest feedback frame
+  uint32_t getFeedbackAge() const;   // µs since that frame arrived
+  bool isActive() const;       // started and not stopped
+
+  // Commands that have actually left the controller (from the TX interrupt)
+  uint32_t getCommandsDelivered() const;
+  uint32_t getCommandDeliveryTime() const;  // µs, when the last one finished on the wire
+  uint32_t getCommandAge() const;           // µs since then
+
+  // Frame built by the last sendCommand(); MotorGroup sends these in bursts.
+  const CANMessage &getCommandFrame() const;
+
+  // When set, update() only processes feedback and leaves transmission
+  // of the command frame to the owner (see MotorGroup).
+  void setExternallyDriven(bool enabled);
+
+  // Transmit policy: a changed command goes out on the next update(), an
+  // unchanged one is only repeated as a keep-alive every heartbeat interval.
+  void setHeartbeatInterval(uint32_t ms);
+  bool isTransmitDue(uint32_t now) const;
+  void markTransmitted(uint32_t now);
+  void markSuppressed();
+
+  uint32_t getFramesSent() const;
+  uint32_t getFramesSuppressed() const;
+  void resetTransmitCounters();
 
   void update();
 
 private:
   uint16_t canID;
-  float P_MIN = -40;
-  float P_MAX = 40;
-  float V_MIN = -50;
-  float V_MAX = 50;
-  float T_MIN = -25;
-  float T_MAX = 25;
-  float Kp_MIN = 0;
-  float Kp_MAX = 500;
-  float Kd_MIN = 0;
-  float Kd_MAX = 5;
+
+  // P/V/T/Kp/Kd ranges and bit widths are fixed at compile time (see MITCodec.h)
+  typedef AKMotorCodec Codec;
 
   float pOut = 0;
   float vOut = 0;
   float iOut = 0;
   int temperature = 0;         // Use a signed type for proper subtraction (e.g., int8_t or int)
   uint8_t errorCode = 0;
-  bool isStopped;
+  std::atomic<bool> isStopped{false};  // also read by the MotorScheduler timer
+  bool externallyDriven = false;
 
-  int floatToUInt(float x, float x_min, float x_max, unsigned int bits);
-  float uintToFloat(int x_int, float x_min, float x_max, int bits);
   void packCommand(CANMessage &msg, float p_des, float v_des, float kp, float kd, float t_ff);
   void unpackCommand(const CANMessage &msg);
 
   CANMessage latestFrame;  // Used for the outgoing command frame
+  ACAN_ESP32_Subscription feedbackSlot;  // Filled by the CAN RX interrupt
+  ACAN_ESP32_Subscription commandSlot;   // Filled by the CAN TX interrupt
+  uint32_t feedbackSequence = 0;         // Last feedback frame unpacked
+  uint32_t feedbackTime = 0;             // Its reception timestamp (µs)
   CANHandler &canHandler;
   uint32_t lastSendTime = 0;
-  int sendInterval = 1; // ms
+  uint32_t heartbeatInterval = 10; // ms
+  uint64_t lastSentData = 0;       // payload of the last command that left
+  bool commandPending = true;      // force the next send (creation / start)
+  uint32_t framesSent = 0;
+  uint32_t framesSuppressed = 0;
   RemoteDebug &Debug;
 };
 
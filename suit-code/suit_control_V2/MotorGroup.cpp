@@ -0,0 +1,93 @@
+#include "MotorGroup.h"
+
+MotorGroup::MotorGroup(CANHandler &canHandler) : canHandler(canHandler) {}
+
+bool MotorGroup::add(Motor &motor)
+{
+  if (count >= MAX_MOTORS) {
+    return false;
+  }
+  motor.setExternallyDriven(true);
+  motors[count++] = &motor;
+  return true;
+}
+
+uint8_t MotorGroup::size() const { return count; }
+
+// ------------------ Burst Transmit ------------------
+
+void MotorGroup::sendTorques(const float torques[], const float kds[])
+{
+  for (uint8_t i = 0; i < count; i++) {
+    const float kd = (kds != nullptr) ? kds[i] : 0.0f;
+    motors[i]->sendCommand(0.0f, 0.0f, 0.0f, kd, torques[i]);
+  }
+  flush();
+}
+
+bool MotorGroup::flush()
+{
+  CANMessage burst[MAX_MOTORS];
+  Motor *sources[MAX_MOTORS];
+  uint32_t frames = 0;
+  const uint32_t now = millis();
+  for (uint8_t i = 0; i < count; i++) {
+    if (!motors[i]->isActive()) {
+      continue;
+    }
+    if (motors[i]->isTransmitDue(now)) {
+      sources[frames] = motors[i];
+      burst[frames++] = motors[i]->getCommandFrame();
+    } else {
+      motors[i]->markSuppressed();
+    }
+  }
+  if (frames == 0) {
+    return true;
+  }
+
+  const uint32_t start = micros();
+  const uint32_t accepted = canHandler.trySendBurst(burst, frames, canHandler.commandPriority());
+  lastBurstLatency = micros() - start;
+
+  if (lastBurstLatency > maxBurstLatency) {
+    maxBurstLatency = lastBurstLatency;
+  }
+  burstCount++;
+  for (uint32_t i = 0; i < accepted; i++) {
+    sources[i]->markTransmitted(now);
+  }
+
+  if (accepted < frames) {
+    droppedFrames += frames - accepted;
+    debugW_every(100, "MOTORGROUP: CAN burst dropped %lu of %lu frames",
+                 (unsigned long)(frames - accepted), (unsigned long)frames);
+    return false;
+  }
+  return true;
+}
+
+// ------------------ Update ------------------
+
+void MotorGroup::update()
+{
+  for (uint8_t i = 0; i < count; i++) {
+    motors[i]->update();
+  }
+  flush();
+}
+
+// ------------------ Statistics ------------------
+
+uint32_t MotorGroup::getLastBurstLatency() const { return lastBurstLatency; }
+uint32_t MotorGroup::getMaxBurstLatency() const  { return maxBurstLatency; }
+uint32_t MotorGroup::getBurstCount() const       { return burstCount; }
+uint32_t MotorGroup::getDroppedFrames() const    { return droppedFrames; }
+
+void MotorGroup::resetBurstStats()
+{
+  lastBurstLatency = 0;
+  maxBurstLatency = 0;
+  burstCount = 0;
+  droppedFrames = 0;
+}
@@ -0,0 +1,59 @@
+#ifndef MOTOR_GROUP_H
+#define MOTOR_GROUP_H
+
+#include "Motor.h"
+
+/*
+ * MotorGroup — commands every joint of the suit as one burst
+ * ----------------------------------------------------------
+ * ‣ add() each Motor once from setup(); the group takes over transmission
+ *   for it, Motor::update() then only handles feedback.
+ * ‣ sendTorques() packs a frame per joint in one pass and enqueues them all
+ *   at once in the control priority class, so a full suit command leaves
+ *   back-to-back, ahead of any queued start / re-zero traffic. While a
+ *   MotorScheduler runs, the control class is its own and bursts go in
+ *   the normal class (CANHandler::commandPriority()).
+ * ‣ Only joints whose command changed, or whose heartbeat is due, are
+ *   put in a burst (same policy as Motor::update()).
+ * ‣ Call update() each loop(): it refreshes feedback and sends heartbeats.
+ */
+
+class MotorGroup
+{
+public:
+  static const uint8_t MAX_MOTORS = 8;
+
+  // Bursts go out through canHandler's transport
+  explicit MotorGroup(CANHandler &canHandler);
+
+  // Register a motor; torque vectors follow the order of registration.
+  bool add(Motor &motor);
+  uint8_t size() const;
+
+  // torques[i] / kds[i] go to the i-th registered motor (kds may be nullptr → 0).
+  void sendTorques(const float torques[], const float kds[] = nullptr);
+
+  // Enqueue, as one burst, every active motor whose command is due.
+  bool flush();
+
+  void update();
+
+  // Burst statistics (µs spent enqueueing one burst, frames the driver refused)
+  uint32_t getLastBurstLatency() const;
+  uint32_t getMaxBurstLatency() const;
+  uint32_t getBurstCount() const;
+  uint32_t getDroppedFrames() const;
+  void resetBurstStats();
+
+private:
+  CANHandler &canHandler;
+  Motor *motors[MAX_MOTORS] = {};
+  uint8_t count = 0;
+
+  uint32_t lastBurstLatency = 0;
+  uint32_t maxBurstLatency = 0;
+  uint32_t burstCount = 0;
+  uint32_t droppedFrames = 0;
+};
+
+#endif // MOTOR_GROUP_H
@@ -0,0 +1,209 @@
+#include "MotorScheduler.h"
+
+// esp_timer does not accept periodic timers shorter than this
+static const uint32_t MIN_SLOT_LENGTH_US = 50;
+
+MotorScheduler::MotorScheduler(CANHandler &canHandler) : canHandler(canHandler) {}
+
+MotorScheduler::~MotorScheduler() { end(); }
+
+// ------------------ Configuration ------------------
+
+bool MotorScheduler::configure(uint32_t majorCycleUs, uint8_t count)
+{
+  if (isRunning() || count == 0 || count > MAX_SLOTS || majorCycleUs / count < MIN_SLOT_LENGTH_US) {
+    return false;
+  }
+  for (uint8_t i = count; i < MAX_SLOTS; i++) {
+    if (slots[i].motor != nullptr) {
+      return false;  // would drop an assigned motor
+    }
+  }
+  majorCycle = majorCycleUs;
+  slotCount = count;
+  slotLength = majorCycleUs / count;
+  return true;
+}
+
+bool MotorScheduler::assign(uint8_t slot, Motor &motor)
+{
+  if (isRunning() || slot >= slotCount || slots[slot].motor != nullptr) {
+    return false;
+  }
+  motor.setExternallyDriven(true);
+  slots[slot].motor = &motor;
+  order[motorCount++] = slot;
+  return true;
+}
+
+// ------------------ Timer ------------------
+
+bool MotorScheduler::begin()
+{
+  if (isRunning() || motorCount == 0 || !canHandler.claimControlPriority()) {
+    return false;
+  }
+  esp_timer_create_args_t args = {};
+  args.callback = timerCallback;
+  args.arg = this;
+  args.dispatch_method = ESP_TIMER_TASK;
+  args.name = "motor_schedule";
+  args.skip_unhandled_events = true;  // a late slot is reported, not replayed
+  if (esp_timer_create(&args, &timer) != ESP_OK) {
+    timer = nullptr;
+    canHandler.releaseControlPriority();
+    return false;
+  }
+  for (uint8_t i = 0; i < motorCount; i++) {
+    slots[order[i]].lastSent = 0;
+  }
+  publish();
+  tickCount = 0;
+  startTime = uint64_t(esp_timer_get_time()) + slotLength;
+  if (esp_timer_start_periodic(timer, slotLength) != ESP_OK) {
+    esp_timer_delete(timer);
+    timer = nullptr;
+    canHandler.releaseControlPriority();
+    return false;
+  }
+  return true;
+}
+
+void MotorScheduler::end()
+{
+  if (timer != nullptr) {
+    esp_timer_stop(timer);
+    esp_timer_delete(timer);
+    timer = nullptr;
+    canHandler.releaseControlPriority();
+  }
+}
+
+bool MotorScheduler::isRunning() const { return timer != nullptr; }
+
+void MotorScheduler::timerCallback(void *scheduler)
+{
+  static_cast<MotorScheduler *>(scheduler)->tick();
+}
+
+void MotorScheduler::tick()
+{
+  const uint64_t now = esp_timer_get_time();
+  uint64_t ideal = startTime + uint64_t(tickCount) * slotLength;
+
+  // A whole slot late: the boundaries in between were missed
+  while (now >= ideal + slotLength) {
+    Slot &skipped = slots[tickCount % slotCount];
+    skipped.missed = skipped.missed + 1;
+    skipped.overruns = skipped.overruns + 1;
+    tickCount++;
+    ideal += slotLength;
+  }
+
+  Slot &slot = slots[tickCount % slotCount];
+  tickCount++;
+
+  const uint32_t jitter = uint32_t((now >= ideal) ? now - ideal : ideal - now);
+  slot.fired = slot.fired + 1;
+  slot.lastJitter = jitter;
+  slot.jitterSum = slot.jitterSum + jitter;
+  if (jitter > slot.maxJitter) {
+    slot.maxJitter = jitter;
+  }
+
+  if (slot.motor == nullptr || !slot.motor->isActive()) {
+    return;
+  }
+  // Only what the loop published since the last send: it already applied
+  // the motor's change / heartbeat check
+  CANMessage frame;
+  const uint32_t sequence = slot.mailbox.read(frame);
+  if (sequence == 0 || sequence == slot.lastSent) {
+    slot.unchanged = slot.unchanged + 1;
+    return;
+  }
+  if (canHandler.trySend(frame, CAN_PRIORITY_CONTROL)) {
+    slot.lastSent = sequence;
+    slot.sent = slot.sent + 1;
+  } else {
+    slot.overruns = slot.overruns + 1;
+  }
+}
+
+// ------------------ Loop Side ------------------
+
+void MotorScheduler::sendTorques(const float torques[], const float kds[])
+{
+  for (uint8_t i = 0; i < motorCount; i++) {
+    const float kd = (kds != nullptr) ? kds[i] : 0.0f;
+    slots[order[i]].motor->sendCommand(0.0f, 0.0f, 0.0f, kd, torques[i]);
+  }
+  publish();
+}
+
+void MotorScheduler::update()
+{
+  for (uint8_t i = 0; i < motorCount; i++) {
+    slots[order[i]].motor->update();
+  }
+  publish();
+}
+
+void MotorScheduler::publish()
+{
+  // Handing a command to the timer counts as sending it, as queuing it
+  // does for MotorGroup
+  const uint32_t now = millis();
+  for (uint8_t i = 0; i < motorCount; i++) {
+    Slot &slot = slots[order[i]];
+    Motor &motor = *slot.motor;
+    if (!motor.isActive()) {
+      continue;
+    }
+    if (motor.isTransmitDue(now)) {
+      slot.mailbox.publish(motor.getCommandFrame());
+      motor.markTransmitted(now);
+    } else {
+      motor.markSuppressed();
+    }
+  }
+}
+
+// ------------------ Statistics ------------------
+
+uint32_t MotorScheduler::getMajorCycle() const { return majorCycle; }
+uint8_t  MotorScheduler::getSlotCount() const  { return slotCount; }
+uint32_t MotorScheduler::getSlotLength() const { return slotLength; }
+
+bool MotorScheduler::getSlotStatistics(uint8_t index, SlotStatistics &out) const
+{
+  if (index >= slotCount) {
+    return false;
+  }
+  const Slot &slot = slots[index];
+  out.fired = slot.fired;
+  out.missed = slot.missed;
+  out.sent = slot.sent;
+  out.unchanged = slot.unchanged;
+  out.overruns = slot.overruns;
+  out.lastJitter = slot.lastJitter;
+  out.meanJitter = (out.fired > 0) ? slot.jitterSum / out.fired : 0;
+  out.maxJitter = slot.maxJitter;
+  return true;
+}
+
+void MotorScheduler::resetStatistics()
+{
+  // Counters are written by the timer; a reset racing a tick may keep one count
+  for (uint8_t i = 0; i < MAX_SLOTS; i++) {
+    Slot &slot = slots[i];
+    slot.fired = 0;
+    slot.missed = 0;
+    slot.sent = 0;
+    slot.unchanged = 0;
+    slot.overruns = 0;
+    slot.lastJitter = 0;
+    slot.jitterSum = 0;
+    slot.maxJitter = 0;
+  }
+}
@@ -0,0 +1,112 @@
+#ifndef MOTOR_SCHEDULER_H
+#define MOTOR_SCHEDULER_H
+
+#include <esp_timer.h>
+#include "Motor.h"
+
+/*
+ * MotorScheduler — time-triggered transmission of the joint commands
+ * ------------------------------------------------------------------
+ * ‣ A major cycle (e.g. 1000 µs) is split into equal slots; each slot owns
+ *   at most one Motor. A periodic esp_timer fires at every slot boundary
+ *   and sends that motor's command frame, so every joint gets its command
+ *   once per cycle at a fixed phase and the frames never pile up in the
+ *   driver transmit buffer.
+ * ‣ The loop only publishes commands: sendTorques() (or Motor::sendCommand()
+ *   followed by update()) copies each command into a per-slot mailbox; the
+ *   timer always sends the latest complete command.
+ * ‣ Motor's transmit policy still applies: the loop publishes a command only
+ *   when Motor::isTransmitDue() (changed, or heartbeat due), and the timer
+ *   sends a slot's frame only if it was published since the last one it sent.
+ *   An unchanged command therefore goes out once per heartbeat interval, not
+ *   every cycle; setHeartbeatInterval(0) on the motor sends it every cycle
+ *   the loop keeps up with. A refused frame is retried at the next cycle.
+ * ‣ Motor::stop() takes effect at the next slot boundary: the timer checks
+ *   Motor::isActive() itself before every send.
+ * ‣ The control class's transmit queue takes a single producer, so begin()
+ *   claims CAN_PRIORITY_CONTROL on the CANHandler (and fails if another
+ *   scheduler holds it) and end() releases it. Meanwhile motors outside
+ *   the schedule, sent by Motor::update() or a MotorGroup, use the normal
+ *   class instead.
+ * ‣ Per slot it records the jitter of the timer (actual − ideal slot start)
+ *   over the boundaries it fired at, the boundaries it missed (the timer
+ *   came more than a slot late) and overruns: missed boundaries, and slots
+ *   whose frame the transmit queue refused.
+ * ‣ On a host build the timer runs in the virtual time of the HostCANBus.
+ */
+
+class MotorScheduler
+{
+public:
+  static const uint8_t MAX_SLOTS = 8;
+
+  struct SlotStatistics {
+    uint32_t fired = 0;        // slot boundaries the timer fired at
+    uint32_t missed = 0;       // boundaries passed while the timer was late
+    uint32_t sent = 0;         // command frames queued
+    uint32_t unchanged = 0;    // nothing new published since the last send
+    uint32_t overruns = 0;     // missed, or frame refused
+    uint32_t lastJitter = 0;   // µs, actual − ideal start
+    uint32_t meanJitter = 0;   // µs, over the fired boundaries
+    uint32_t maxJitter = 0;    // µs
+  };
+
+  explicit MotorScheduler(CANHandler &canHandler);
+  ~MotorScheduler();
+
+  // Major cycle (µs) split into slotCount equal slots; before begin()
+  bool configure(uint32_t majorCycleUs, uint8_t slotCount);
+  // Give a motor a slot; torque vectors follow the order of assignment
+  bool assign(uint8_t slot, Motor &motor);
+
+  // Start / stop the slot timer
+  bool begin();
+  void end();
+  bool isRunning() const;
+
+  // Loop side: set and publish the commands, refresh feedback
+  void sendTorques(const float torques[], const float kds[] = nullptr);
+  void update();
+
+  // Timer side: one slot boundary (called by the timer)
+  void tick();
+
+  uint32_t getMajorCycle() const;
+  uint8_t  getSlotCount() const;
+  uint32_t getSlotLength() const;
+  bool     getSlotStatistics(uint8_t slot, SlotStatistics &out) const;
+  void     resetStatistics();
+
+private:
+  struct Slot {
+    Motor *motor = nullptr;
+    ACAN_ESP32_Subscription mailbox{0};  // latest command (seqlock, not given to the driver)
+    uint32_t lastSent = 0;       // mailbox sequence of the last frame queued (timer side)
+    volatile uint32_t fired = 0;
+    volatile uint32_t missed = 0;
+    volatile uint32_t sent = 0;
+    volatile uint32_t unchanged = 0;
+    volatile uint32_t overruns = 0;
+    volatile uint32_t lastJitter = 0;
+    volatile uint32_t jitterSum = 0;
+    volatile uint32_t maxJitter = 0;
+  };
+
+  static void timerCallback(void *scheduler);
+  void publish();
+
+  CANHandler &canHandler;
+  Slot slots[MAX_SLOTS];
+  uint8_t order[MAX_SLOTS] = {};   // slot of the i-th assigned motor
+  uint8_t motorCount = 0;
+
+  uint32_t majorCycle = 1000;      // µs
+  uint8_t slotCount = 4;
+  uint32_t slotLength = 250;       // µs
+
+  esp_timer_handle_t timer = nullptr;
+  uint64_t startTime = 0;          // µs, ideal start of slot 0
+  uint32_t tickCount = 0;          // slot boundaries since begin()
+};
+
+#endif // MOTOR_SCHEDULER_H
@@ -8,17 +8,22 @@ RemoteDebug::RemoteDebug() {
 void RemoteDebug::begin(const char* hostname) {
   Serial.print("RemoteDebug started: ");
   Serial.println(hostname);
+  name = hostname;
+  logger.begin(Serial);
 }
 
-void RemoteDebug::println(const char* msg) {
-  // Serial.println(msg);
+bool RemoteDebug::beginUDP(const char* host, uint16_t port) {
+  if (udp.isRunning()) {
+    return false;  // Already an output of the logger
+  }
+  if (!udp.begin(host, port, name) || !logger.addOutput(udp)) {
+    udp.end();
+    return false;
+  }
+  printf("RemoteDebug: logging to %s:%u over UDP", host, (unsigned)port);
+  return true;
 }
 
-void RemoteDebug::printf(const char* fmt, ...) {
-  char buf[128];
-  va_list args;
-  va_start(args, fmt);
-  vsnprintf(buf, sizeof(buf), fmt, args);
-  va_end(args);
-  Serial.println(buf);
+void RemoteDebug::println(const char* msg) {
+  logger.logText(msg);
 }
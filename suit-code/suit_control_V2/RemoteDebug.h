@@ -3,6 +3,9 @@
 
 #include <Arduino.h>
 #include <stdarg.h>
+#include <atomic>
+#include "DeferredLogger.h"
+#include "UDPLogTransport.h"
 
 // A minimal RemoteDebug class implementation.
 class RemoteDebug {
@@ -10,20 +13,106 @@ public:
   RemoteDebug();
 
   // Call this to initialize the remote debug interface (for example, to print a startup message)
+  // and start the logger task that prints queued messages to Serial
   void begin(const char* hostname);
 
-  // Print a line (with newline appended)
+  // After begin(): also send the log to host:port (dotted IPv4) over UDP,
+  // batched by the logger task. The sketch connects WiFi; until it is up
+  // the messages wait in the transport's ring. Read with host/UDPLogReceiver.
+  bool beginUDP(const char* host, uint16_t port);
+
+  // Print a line (with newline appended). The text is copied (up to
+  // DeferredLogger::TEXT_LENGTH characters), so any buffer will do.
   void println(const char* msg);
 
-  // Print formatted output (like printf)
-  void printf(const char* fmt, ...);
+  // Print formatted output (like printf). Deferred: the arguments are queued and
+  // formatted by the logger task, so the call costs the same for any message;
+  // %s arguments must still exist then (literals, static buffers).
+  template <typename... Args>
+  void printf(const char* fmt, Args... args) { logger.log(fmt, args...); }
+
+  DeferredLogger& getLogger() { return logger; }
+  UDPLogTransport& getUDP() { return udp; }
+
+private:
+  DeferredLogger logger;
+  UDPLogTransport udp;
+  const char* name = "";
 };
 
 // Create a global instance so that the macros can use it.
 extern RemoteDebug Debug;
 
-// Define debug macros for informational and warning messages.
-#define debugI(fmt, ...) Debug.printf((fmt), ##__VA_ARGS__)
-#define debugW(fmt, ...) Debug.printf((fmt), ##__VA_ARGS__)
+// Log levels. Messages below LOG_LEVEL are compiled out, arguments included.
+// The sketch and its .cpp files are compiled separately, so set LOG_LEVEL
+// here or for the whole build (build_opt.h: -DLOG_LEVEL=LOG_LEVEL_WARN).
+#define LOG_LEVEL_TRACE 0
+#define LOG_LEVEL_DEBUG 1
+#define LOG_LEVEL_INFO  2
+#define LOG_LEVEL_WARN  3
+#define LOG_LEVEL_ERROR 4
+#define LOG_LEVEL_NONE  5
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+// At most one message every intervalMs; one per call site (a static in the
+// macro below), the others are counted and reported with the next one.
+// Constant-initialised and lock-free, so it may sit in any task.
+class LogRateLimiter {
+public:
+  constexpr LogRateLimiter() {}
+
+  // true → log now; suppressedOut = messages skipped since the last one
+  bool allow(uint32_t intervalMs, uint32_t& suppressedOut) {
+    const uint32_t now = millis();
+    uint32_t last = lastTime.load(std::memory_order_relaxed);
+    if ((started.load(std::memory_order_relaxed) && now - last < intervalMs) ||
+        !lastTime.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+      suppressed.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    started.store(true, std::memory_order_relaxed);
+    suppressedOut = suppressed.exchange(0, std::memory_order_relaxed);
+    return true;
+  }
+
+private:
+  std::atomic<uint32_t> lastTime{0};
+  std::atomic<uint32_t> suppressed{0};
+  std::atomic<bool> started{false};
+};
+
+// `if` on a constant: a disabled call, and its arguments, generate no code
+#define DEBUG_LOG(level, fmt, ...) \
+  do { if ((level) >= LOG_LEVEL) Debug.printf((fmt), ##__VA_ARGS__); } while (0)
+
+#define DEBUG_LOG_EVERY(level, intervalMs, fmt, ...) \
+  do { \
+    if ((level) >= LOG_LEVEL) { \
+      static LogRateLimiter debugLimiter_; \
+      uint32_t debugSuppressed_ = 0; \
+      if (debugLimiter_.allow((intervalMs), debugSuppressed_)) { \
+        Debug.printf((fmt), ##__VA_ARGS__); \
+        if (debugSuppressed_ > 0) { \
+          Debug.printf("  (%lu more like this in the last %lu ms)", \
+                       (unsigned long)debugSuppressed_, (unsigned long)(intervalMs)); \
+        } \
+      } \
+    } \
+  } while (0)
+
+// Define debug macros for trace, debug, informational, warning and error messages.
+#define debugT(fmt, ...) DEBUG_LOG(LOG_LEVEL_TRACE, fmt, ##__VA_ARGS__)
+#define debugD(fmt, ...) DEBUG_LOG(LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#define debugI(fmt, ...) DEBUG_LOG(LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#define debugW(fmt, ...) DEBUG_LOG(LOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#define debugE(fmt, ...) DEBUG_LOG(LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+
+// Rate-limited variants for the 1 kHz paths, e.g. debugW_every(100, "...")
+#define debugI_every(intervalMs, fmt, ...) DEBUG_LOG_EVERY(LOG_LEVEL_INFO, intervalMs, fmt, ##__VA_ARGS__)
+#define debugW_every(intervalMs, fmt, ...) DEBUG_LOG_EVERY(LOG_LEVEL_WARN, intervalMs, fmt, ##__VA_ARGS__)
+#define debugE_every(intervalMs, fmt, ...) DEBUG_LOG_EVERY(LOG_LEVEL_ERROR, intervalMs, fmt, ##__VA_ARGS__)
 
 #endif // REMOTE_DEBUG_H
@@ -0,0 +1,159 @@
+#include "Telemetry.h"
+
+// -------------------------------------------------------------
+// Sending
+// -------------------------------------------------------------
+void Telemetry::begin (Print &out) {
+    output = &out;
+}
+
+void Telemetry::end () {
+    output = nullptr;
+}
+
+bool Telemetry::send (const TelemetryRecord &record) {
+    const uint32_t number = sequence++;
+    if (output == nullptr || paused) {
+        ++dropped;
+        return false;
+    }
+    const size_t length = encodePacket (number, record, packet, sizeof (packet));
+    // Never block the loop: a packet goes out whole or not at all
+    if (length == 0 || output->availableForWrite () < int (length)) {
+        ++dropped;
+        return false;
+    }
+    output->write (packet, length);
+    ++sent;
+    return true;
+}
+
+void Telemetry::setPaused (bool pause) {
+    paused = pause;
+}
+
+uint32_t Telemetry::getSequence () const {
+    return sequence;
+}
+
+uint32_t Telemetry::getSentCount () const {
+    return sent;
+}
+
+uint32_t Telemetry::getDroppedCount () const {
+    return dropped;
+}
+
+// -------------------------------------------------------------
+// Packet: 0, COBS (header | record | CRC-32), 0
+// -------------------------------------------------------------
+size_t Telemetry::encodePacket (uint32_t number, const TelemetryRecord &record,
+                                uint8_t *out, size_t size) {
+    if (size < PACKET_SIZE) {
+        return 0;
+    }
+    TelemetryPacketHeader header;
+    header.type       = PACKET_RECORD;
+    header.version    = VERSION;
+    header.recordSize = sizeof (TelemetryRecord);
+    header.sequence   = number;
+
+    uint8_t payload[PAYLOAD_SIZE];
+    memcpy (payload, &header, sizeof (header));
+    memcpy (payload + sizeof (header), &record, sizeof (record));
+    const uint32_t crc = crc32 (payload, PAYLOAD_SIZE - 4);
+    memcpy (payload + PAYLOAD_SIZE - 4, &crc, 4);
+
+    size_t length = 0;
+    out[length++] = 0;
+    length += cobsEncode (payload, PAYLOAD_SIZE, out + length);
+    out[length++] = 0;
+    return length;
+}
+
+bool Telemetry::decodePacket (const uint8_t *frame, size_t length,
+                              uint32_t &number, TelemetryRecord &out) {
+    uint8_t payload[PAYLOAD_SIZE];
+    if (length > PACKET_SIZE ||
+        cobsDecode (frame, length, payload, sizeof (payload)) != PAYLOAD_SIZE) {
+        return false;
+    }
+    uint32_t crc;
+    memcpy (&crc, payload + PAYLOAD_SIZE - 4, 4);
+    if (crc != crc32 (payload, PAYLOAD_SIZE - 4)) {
+        return false;
+    }
+    TelemetryPacketHeader header;
+    memcpy (&header, payload, sizeof (header));
+    if (header.type != PACKET_RECORD || header.version != VERSION ||
+        header.recordSize != sizeof (TelemetryRecord)) {
+        return false;
+    }
+    number = header.sequence;
+    memcpy (&out, payload + sizeof (header), sizeof (out));
+    return true;
+}
+
+// -------------------------------------------------------------
+// COBS: each zero becomes the distance to the next one, so the
+// encoded block has no zero byte (one code byte per 254 data)
+// -------------------------------------------------------------
+size_t Telemetry::cobsEncode (const uint8_t *in, size_t length, uint8_t *out) {
+    size_t code = 0;       // where the current block's code byte goes
+    size_t written = 1;
+    uint8_t distance = 1;
+    for (size_t i = 0; i < length; ++i) {
+        if (in[i] != 0) {
+            out[written++] = in[i];
+            ++distance;
+        }
+        if (in[i] == 0 || distance == 0xFF) {
+            out[code] = distance;
+            code      = written++;
+            distance  = 1;
+        }
+    }
+    out[code] = distance;
+    return written;
+}
+
+size_t Telemetry::cobsDecode (const uint8_t *in, size_t length, uint8_t *out, size_t size) {
+    size_t read = 0;
+    size_t written = 0;
+    while (read < length) {
+        const uint8_t code = in[read++];
+        if (code == 0 || read + code - 1 > length || written + code - 1 > size) {
+            return 0;
+        }
+        for (uint8_t i = 1; i < code; ++i) {
+            if (in[read] == 0) {
+                return 0;
+            }
+            out[written++] = in[read++];
+        }
+        if (code != 0xFF && read < length) {
+            if (written >= size) {
+                return 0;
+            }
+            out[written++] = 0;
+        }
+    }
+    return written;
+}
+
+// -------------------------------------------------------------
+// CRC-32 (IEEE 802.3, as zlib), four bits at a time
+// -------------------------------------------------------------
+uint32_t Telemetry::crc32 (const uint8_t *data, size_t length) {
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < length; ++i) {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+    }
+    return ~crc;
+}
@@ -0,0 +1,99 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <Arduino.h>
+
+/*
+ * Telemetry — one binary record per control cycle over the serial port
+ * --------------------------------------------------------------------
+ * ‣ The sketch fills a TelemetryRecord each loop (time, loop timing and,
+ *   per joint, omega, commanded torque and the motor feedback) and calls
+ *   send(). The record is written as raw floats, with nothing formatted.
+ * ‣ Packet: TelemetryPacketHeader, the record, then the CRC-32 of both.
+ *   The packet is COBS-encoded, so it contains no zero byte, and is written
+ *   between two zero delimiters. A reader resynchronises at the next zero.
+ *   Serial text in between (Debug output) fails the CRC and is skipped.
+ * ‣ send() never waits for the UART. If the port cannot take the whole
+ *   packet now (availableForWrite()), the packet is dropped and counted.
+ *   The sequence number still advances, so the reader sees the gap.
+ * ‣ Layout is little-endian, like the ESP32 and x86 hosts.
+ *   host/TelemetryDecode turns a capture into CSV.
+ */
+
+static const uint8_t TELEMETRY_JOINTS = 4;
+
+struct TelemetryJoint {
+    float omega;             // rad/s, IMU projected on the joint axis
+    float torqueCommand;     // N·m, sent this cycle
+    float position;          // rad, motor feedback
+    float velocity;          // rad/s, motor feedback
+    float torque;            // N·m, motor feedback
+};
+
+struct TelemetryRecord {
+    uint32_t timestamp;      // µs, micros() at the start of the cycle
+    uint32_t loopPeriod;     // µs since the start of the previous cycle
+    uint32_t loopTime;       // µs the previous cycle spent before waiting
+    uint8_t  online;         // bit j: joint j has live feedback
+    uint8_t  reserved[3];
+    TelemetryJoint joints[TELEMETRY_JOINTS];
+};
+
+struct TelemetryPacketHeader {
+    uint8_t  type;           // Telemetry::PACKET_RECORD
+    uint8_t  version;        // Telemetry::VERSION
+    uint16_t recordSize;     // sizeof (TelemetryRecord)
+    uint32_t sequence;       // one per send(), sent or not
+};
+
+static_assert(sizeof(TelemetryRecord) == 96, "TelemetryRecord is a wire format");
+static_assert(sizeof(TelemetryPacketHeader) == 8, "TelemetryPacketHeader is a wire format");
+
+class Telemetry {
+public:
+    static const uint8_t PACKET_RECORD = 1;
+    static const uint8_t VERSION       = 1;
+
+    // Header + record + CRC, before encoding
+    static const size_t PAYLOAD_SIZE = sizeof(TelemetryPacketHeader) + sizeof(TelemetryRecord) + 4;
+    // COBS adds one byte per 254, plus the two delimiters
+    static const size_t PACKET_SIZE  = PAYLOAD_SIZE + PAYLOAD_SIZE / 254 + 1 + 2;
+
+    Telemetry() = default;
+
+    Telemetry(const Telemetry&) = delete;
+    Telemetry& operator=(const Telemetry&) = delete;
+
+    void begin(Print& out);
+    void end();
+
+    // Encode and write one record; false → dropped (port busy, or paused)
+    bool send(const TelemetryRecord& record);
+
+    // While paused every record is dropped (e.g. while something else owns
+    // the serial port)
+    void setPaused(bool paused);
+
+    uint32_t getSequence() const;       // next sequence number
+    uint32_t getSentCount() const;
+    uint32_t getDroppedCount() const;
+
+    // Wire format, shared with the host decoder
+    static size_t   encodePacket(uint32_t sequence, const TelemetryRecord& record,
+                                 uint8_t* out, size_t size);   // framed, 0 → too small
+    static bool     decodePacket(const uint8_t* frame, size_t length,
+                                 uint32_t& sequence, TelemetryRecord& out);   // between delimiters
+    static size_t   cobsEncode(const uint8_t* in, size_t length, uint8_t* out);
+    static size_t   cobsDecode(const uint8_t* in, size_t length, uint8_t* out, size_t size);   // 0 → invalid
+    static uint32_t crc32(const uint8_t* data, size_t length);
+
+private:
+    Print*   output = nullptr;
+    bool     paused = false;
+    uint32_t sequence = 0;
+    uint32_t sent = 0;
+    uint32_t dropped = 0;
+    uint8_t  packet[PACKET_SIZE];
+};
+
+#endif  // TELEMETRY_H
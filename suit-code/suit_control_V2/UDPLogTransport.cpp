@@ -0,0 +1,163 @@
+#include "UDPLogTransport.h"
+
+#ifdef ARDUINO
+#include <lwip/sockets.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif
+#include <unistd.h>
+
+// -------------------------------------------------------------
+// Construction: ring size rounded up to a power of two
+// -------------------------------------------------------------
+UDPLogTransport::UDPLogTransport (uint16_t ringSize) {
+    uint16_t size = 256;
+    while (size < ringSize && size < 0x8000) {
+        size <<= 1;
+    }
+    ring = new uint8_t [size];
+    mask = size - 1;
+}
+
+UDPLogTransport::~UDPLogTransport () {
+    end ();
+    delete [] ring;
+}
+
+bool UDPLogTransport::begin (const char *host, uint16_t destinationPort, const char *name) {
+    end ();
+    in_addr parsed;
+    if (host == nullptr || inet_pton (AF_INET, host, &parsed) != 1) {
+        return false;
+    }
+    socketHandle = socket (AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (socketHandle < 0) {
+        return false;
+    }
+    address = parsed.s_addr;
+    port    = destinationPort;
+    strncpy (source, (name != nullptr) ? name : "", sizeof (source));
+    return true;
+}
+
+void UDPLogTransport::end () {
+    if (socketHandle >= 0) {
+        close (socketHandle);
+        socketHandle = -1;
+    }
+}
+
+bool UDPLogTransport::isRunning () const {
+    return socketHandle >= 0;
+}
+
+// -------------------------------------------------------------
+// Queueing: (uint16_t length, text) per record, oldest first
+// -------------------------------------------------------------
+uint8_t UDPLogTransport::peek (uint32_t position) const {
+    return ring[position & mask];
+}
+
+uint16_t UDPLogTransport::recordLength (uint32_t position) const {
+    return uint16_t (peek (position) | (peek (position + 1) << 8));
+}
+
+size_t UDPLogTransport::write (const uint8_t *buffer, size_t size) {
+    // A record must fit in the ring and in one datagram
+    const size_t limit = MAX_DATAGRAM - sizeof (UDPLogHeader) - 2;
+    const uint16_t length = uint16_t ((size < limit) ? size : limit);
+    if (length == 0 || size_t (length) + 2 > size_t (mask) + 1) {
+        return 0;
+    }
+    while (uint32_t (mask + 1) - (head - tail) < uint32_t (length) + 2) {
+        tail += 2 + recordLength (tail);   // Full: overwrite the oldest
+        ++tailRecord;
+        ++overwritten;
+    }
+    ring[head++ & mask] = uint8_t (length);
+    ring[head++ & mask] = uint8_t (length >> 8);
+    for (uint16_t i = 0; i < length; ++i) {
+        ring[head++ & mask] = buffer[i];
+    }
+    return size;
+}
+
+size_t UDPLogTransport::write (uint8_t byte) {
+    return write (&byte, 1);
+}
+
+int UDPLogTransport::availableForWrite () {
+    return int (mask + 1) - int (head - tail);
+}
+
+// -------------------------------------------------------------
+// Sending: whole records, as many as fit per datagram
+// -------------------------------------------------------------
+void UDPLogTransport::flush () {
+    if (socketHandle < 0) {
+        return;
+    }
+    sockaddr_in destination;
+    memset (&destination, 0, sizeof (destination));
+    destination.sin_family      = AF_INET;
+    destination.sin_port        = htons (port);
+    destination.sin_addr.s_addr = address;
+
+    while (tail != head) {
+        size_t size = sizeof (UDPLogHeader);
+        uint32_t position = tail;
+        uint16_t count = 0;
+        while (position != head) {
+            const uint16_t length = recordLength (position);
+            if (size + 2 + length > MAX_DATAGRAM) {
+                break;
+            }
+            for (uint16_t i = 0; i < 2 + length; ++i) {
+                datagram[size++] = peek (position++);
+            }
+            ++count;
+        }
+
+        UDPLogHeader header;
+        memcpy (header.magic, "SLOG", 4);
+        header.version     = VERSION;
+        header.recordCount = count;
+        header.sequence    = sequence;
+        header.firstRecord = tailRecord;
+        header.timestamp   = millis ();
+        memcpy (header.source, source, sizeof (header.source));
+        memcpy (datagram, &header, sizeof (header));
+
+        if (sendto (socketHandle, datagram, size, MSG_DONTWAIT,
+                    reinterpret_cast<const sockaddr *> (&destination), sizeof (destination)) < 0) {
+            ++sendFailures;   // Network down: keep the records, try on the next flush
+            return;
+        }
+        ++sequence;
+        tail         = position;
+        tailRecord  += count;
+        recordsSent += count;
+    }
+}
+
+uint32_t UDPLogTransport::getDatagramsSent () const {
+    return sequence;
+}
+
+uint32_t UDPLogTransport::getSendFailures () const {
+    return sendFailures;
+}
+
+uint32_t UDPLogTransport::getRecordsSent () const {
+    return recordsSent;
+}
+
+uint32_t UDPLogTransport::getRecordsOverwritten () const {
+    return overwritten;
+}
+
+uint16_t UDPLogTransport::getQueuedBytes () const {
+    return uint16_t (head - tail);
+}
@@ -0,0 +1,92 @@
+#ifndef UDP_LOG_TRANSPORT_H
+#define UDP_LOG_TRANSPORT_H
+
+#include <Arduino.h>
+
+/*
+ * UDPLogTransport — the debug log over WiFi, batched into UDP datagrams
+ * ---------------------------------------------------------------------
+ * ‣ A Print where each write() is one record (DeferredLogger writes one
+ *   message per call). Records are queued in a byte ring. flush() packs as
+ *   many whole records as fit into each datagram and sends them to
+ *   host:port.
+ * ‣ Meant as an extra DeferredLogger output (RemoteDebug::beginUDP()). The
+ *   logger task writes and flushes it once per drain pass, so the control
+ *   loop never pays for the radio and a datagram carries every message of
+ *   a pass. Not for use from several tasks.
+ * ‣ While the network is down (WiFi not connected yet, no route), sendto()
+ *   fails and the records stay queued until it is back. When the ring is
+ *   full, the oldest records are overwritten and counted.
+ * ‣ Datagram: UDPLogHeader, then header.recordCount × (uint16_t length,
+ *   text). sequence counts datagrams and firstRecord numbers records, so
+ *   host/UDPLogReceiver can tell datagrams lost on the network from
+ *   records overwritten here. Little-endian, like the ESP32 and x86 hosts.
+ * ‣ BSD sockets: lwIP on the ESP32, the kernel on Linux, where a host build
+ *   sends to a receiver on the loopback interface.
+ */
+
+struct UDPLogHeader {
+    char     magic[4];       // "SLOG"
+    uint16_t version;
+    uint16_t recordCount;
+    uint32_t sequence;       // datagrams sent before this one
+    uint32_t firstRecord;    // records queued before the first one here
+    uint32_t timestamp;      // ms, millis() when sent
+    char     source[12];     // sender name, NUL-padded
+};
+
+static_assert(sizeof(UDPLogHeader) == 32, "UDPLogHeader is a wire format");
+
+class UDPLogTransport : public Print {
+public:
+    static const uint16_t VERSION      = 1;
+    static const uint16_t MAX_DATAGRAM = 1400;    // under the WiFi MTU
+    static const uint16_t DEFAULT_RING = 4096;    // bytes
+
+    explicit UDPLogTransport(uint16_t ringSize = DEFAULT_RING);
+    ~UDPLogTransport();
+
+    UDPLogTransport(const UDPLogTransport&) = delete;
+    UDPLogTransport& operator=(const UDPLogTransport&) = delete;
+
+    // host is a dotted IPv4 address; source goes in every header
+    bool begin(const char* host, uint16_t port, const char* source = "");
+    void end();
+    bool isRunning() const;
+
+    // Print: queue one record; flush() sends everything queued
+    using Print::write;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    size_t write(uint8_t byte) override;
+    int    availableForWrite() override;
+    void   flush() override;
+
+    uint32_t getDatagramsSent() const;
+    uint32_t getSendFailures() const;       // sendto() refused, records kept
+    uint32_t getRecordsSent() const;
+    uint32_t getRecordsOverwritten() const; // ring full
+    uint16_t getQueuedBytes() const;
+
+private:
+    uint8_t  peek(uint32_t position) const;
+    uint16_t recordLength(uint32_t position) const;
+
+    uint8_t* ring;
+    uint16_t mask;                  // ring size − 1
+    uint32_t head = 0;              // next write, free-running
+    uint32_t tail = 0;              // oldest record
+    uint32_t tailRecord = 0;        // number of the oldest record
+
+    int      socketHandle = -1;
+    uint32_t address = 0;           // network order
+    uint16_t port = 0;              // host order
+    char     source[12] = {};
+
+    uint32_t sequence = 0;
+    uint32_t sendFailures = 0;
+    uint32_t recordsSent = 0;
+    uint32_t overwritten = 0;
+    uint8_t  datagram[MAX_DATAGRAM];
+};
+
+#endif  // UDP_LOG_TRANSPORT_H
@@ -0,0 +1,784 @@
+//------------------------------------------------------------------------------
+//   Include files
+//------------------------------------------------------------------------------
+
+#include <ACAN_ESP32_EmulatedTWAI.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//------------------------------------------------------------------------------
+//   Register offsets
+//------------------------------------------------------------------------------
+
+static const uint32_t kModeRegister              = 0x000 ;
+static const uint32_t kCommandRegister           = 0x004 ;
+static const uint32_t kStatusRegister            = 0x008 ;
+static const uint32_t kInterruptRegister         = 0x00C ;
+static const uint32_t kInterruptEnableRegister   = 0x010 ;
+static const uint32_t kBusTiming0Register        = 0x018 ;
+static const uint32_t kBusTiming1Register        = 0x01C ;
+static const uint32_t kArbitrationLostRegister   = 0x02C ;
+static const uint32_t kErrorCodeRegister         = 0x030 ;
+static const uint32_t kErrorWarningLimitRegister = 0x034 ;
+static const uint32_t kReceiveErrorRegister      = 0x038 ;
+static const uint32_t kTransmitErrorRegister     = 0x03C ;
+static const uint32_t kFrameWindowStart          = 0x040 ; // 13 registers
+static const uint32_t kFrameWindowEnd            = 0x074 ;
+static const uint32_t kAcceptanceMaskStart       = 0x050 ;
+static const uint32_t kMessageCounterRegister    = 0x074 ;
+static const uint32_t kClockDividerRegister      = 0x07C ;
+static const uint32_t kRegisterSpan              = 0x100 ;
+
+//--- Error code capture: error type (bits 7-6), direction (bit 5), segment (bits 4-0)
+static const uint32_t kECCBitError   = 0x00 ;
+static const uint32_t kECCOtherError = 0xC0 ;
+static const uint32_t kECCReceive    = 0x20 ;
+static const uint32_t kECCCRCSeq     = 0x08 ;
+static const uint32_t kECCAckSlot    = 0x19 ;
+static const uint32_t kECCAckDelim   = 0x1B ;
+
+static const uint32_t kBusOffRecoveryBits = 128 * 11 ;
+
+//------------------------------------------------------------------------------
+//   Controllers reachable through acanHostReadRegister / acanHostWriteRegister
+//------------------------------------------------------------------------------
+
+static const uint32_t kMaxControllers = 2 ;
+static ACAN_ESP32_EmulatedTWAI * gControllers [kMaxControllers] ;
+static std::mutex gControllersMutex ;
+
+//------------------------------------------------------------------------------
+
+ACAN_ESP32_EmulatedTWAI * ACAN_ESP32_EmulatedTWAI::controllerAt (const uint32_t inAddress) {
+  std::lock_guard <std::mutex> lock (gControllersMutex) ;
+  for (uint32_t i=0 ; i<kMaxControllers ; i++) {
+    ACAN_ESP32_EmulatedTWAI * controller = gControllers [i] ;
+    if ((controller != nullptr)
+     && (inAddress >= controller->mBaseAddress)
+     && (inAddress < (controller->mBaseAddress + kRegisterSpan))) {
+      return controller ;
+    }
+  }
+  return nullptr ;
+}
+
+//------------------------------------------------------------------------------
+
+static ACAN_ESP32_EmulatedTWAI & controllerOrDie (const uint32_t inAddress) {
+  ACAN_ESP32_EmulatedTWAI * controller = ACAN_ESP32_EmulatedTWAI::controllerAt (inAddress) ;
+  if (controller == nullptr) {
+    fprintf (stderr, "ACAN_ESP32 host: no emulated TWAI at 0x%08X "
+                     "(create an ACAN_ESP32_EmulatedTWAI before begin ())\n", unsigned (inAddress)) ;
+    abort () ;
+  }
+  return *controller ;
+}
+
+//------------------------------------------------------------------------------
+
+uint32_t acanHostReadRegister (const uint32_t inAddress) {
+  ACAN_ESP32_EmulatedTWAI & controller = controllerOrDie (inAddress) ;
+  return controller.readRegister (inAddress & (kRegisterSpan - 1)) ;
+}
+
+//------------------------------------------------------------------------------
+
+void acanHostWriteRegister (const uint32_t inAddress, const uint32_t inValue) {
+  ACAN_ESP32_EmulatedTWAI & controller = controllerOrDie (inAddress) ;
+  controller.writeRegister (inAddress & (kRegisterSpan - 1), inValue) ;
+}
+
+//------------------------------------------------------------------------------
+//   Constructor / destructor
+//------------------------------------------------------------------------------
+
+ACAN_ESP32_EmulatedTWAI::ACAN_ESP32_EmulatedTWAI (HostCANBus & inBus,
+                                                  const uint32_t inBaseAddress,
+                                                  const int inInterruptSource) :
+mMutex (),
+mBus (inBus),
+mBaseAddress (inBaseAddress),
+mInterruptSource (inInterruptSource),
+mMode (TWAI_RESET_MODE),
+mInterrupts (0),
+mInterruptEnable (0),
+mBusTiming0 (0),
+mBusTiming1 (0),
+mArbitrationLostCapture (0),
+mErrorCodeCapture (0),
+mErrorWarningLimit (96),
+mReceiveErrorCounter (0),
+mTransmitErrorCounter (0),
+mClockDivider (0),
+mAcceptanceCode (),
+mAcceptanceMask (),
+mTransmitBuffer (),
+mTransmitFrame (),
+mTransmitPending (false),
+mSelfReception (false),
+mTransmitBufferFree (true),
+mTransmissionComplete (true),
+mReceiveFifo (),
+mReceiveFifoBytes (0),
+mReceiveFifoSize (kDefaultReceiveFifoSize),
+mReceiveWindow (),
+mDataOverrun (false),
+mErrorWarning (false),
+mErrorPassive (false),
+mBusOff (false),
+mBusOnTime (UINT64_MAX),
+mInterruptLatency (0),
+mLineAssertedTime (UINT64_MAX),
+mInterruptCallCount (0),
+mReceivedFrameCount (0),
+mFilteredFrameCount (0),
+mReceiveOverrunCount (0),
+mTransmittedFrameCount (0),
+mBusOffCount (0),
+mReceiveFifoPeakCount (0) {
+  {
+    std::lock_guard <std::mutex> lock (gControllersMutex) ;
+    bool registered = false ;
+    for (uint32_t i=0 ; (i<kMaxControllers) && !registered ; i++) {
+      if (gControllers [i] == nullptr) {
+        gControllers [i] = this ;
+        registered = true ;
+      }
+    }
+    if (!registered) {
+      fprintf (stderr, "ACAN_ESP32 host: too many emulated TWAI controllers\n") ;
+      abort () ;
+    }
+  }
+  mBus.attach (*this) ;
+}
+
+//------------------------------------------------------------------------------
+
+ACAN_ESP32_EmulatedTWAI::~ ACAN_ESP32_EmulatedTWAI (void) {
+  mBus.detach (*this) ;
+  std::lock_guard <std::mutex> lock (gControllersMutex) ;
+  for (uint32_t i=0 ; i<kMaxControllers ; i++) {
+    if (gControllers [i] == this) {
+      gControllers [i] = nullptr ;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+//   Configuration
+//------------------------------------------------------------------------------
+
+void ACAN_ESP32_EmulatedTWAI::setReceiveFifoSize (const uint32_t inBytes) {
+  std::lock_guard <std::mutex> lock (mMutex) ;
+  mReceiveFifoSize = inBytes ;
+}
+
+//------------------------------------------------------------------------------
+
+void ACAN_ESP32_EmulatedTWAI::setInterruptLatency (const uint64_t inNanoseconds) {
+  std::lock_guard <std::mutex> lock (mMutex) ;
+  mInterruptLatency = inNanoseconds ;
+}
+
+//------------------------------------------------------------------------------
+
+void ACAN_ESP32_EmulatedTWAI::forceBusOff (void) {
+  std::lock_guard <std::mutex> lock (mMutex) ;
+  mTransmitErrorCounter = 256 ;
+  updateErrorState () ;
+}
+
+//------------------------------------------------------------------------------
+//   Register read
+//------------------------------------------------------------------------------
+
+uint32_t ACAN_ESP32_EmulatedTWAI::readRegister (const uint32_t inOffset) {
+  std::lock_guard <std::mutex> lock (mMutex) ;
+  uint32_t result = 0 ;
+  switch (inOffset) {
+  case kModeRegister :
+    result = mMode ;
+    break ;
+  case kCommandRegister : // Write only
+    break ;
+  case kStatusRegister :
+    if (!mReceiveFifo.empty ()) { result |= TWAI_RX_BUF_ST ; }
+    if (mDataOverrun) { result |= TWAI_OVERRUN_ST ; }
+    if (mTransmitBufferFree) { result |= TWAI_TX_BUF_ST ; }
+    if (mTransmissionComplete) { result |= TWAI_TX_COMPLETE ; }
+    if (mErrorWarning) { result |= TWAI_ERR_ST ; }
+    if (mBusOff) { result |= TWAI_BUS_OFF_ST ; }
+    break ;
+  case kInterruptRegister : //--- Reading clears every flag but RX
+    result = mInterrupts ;
+    if (((mInterruptEnable & TWAI_RX_INT_ENA) != 0) && !inResetMode () && !mReceiveFifo.empty ()) {
+      result |= TWAI_RX_INT_ST ;
+    }
+    mInterrupts = 0 ;
+    break ;
+  case kInterruptEnableRegister :
+    result = mInterruptEnable ;
+    break ;
+  case kBusTiming0Register :
+    result = mBusTiming0 ;
+    break ;
+  case kBusTiming1Register :
+    result = mBusTiming1 ;
+    break ;
+  case kArbitrationLostRegister :
+    result = mArbitrationLostCapture ;
+    break ;
+  case kErrorCodeRegister :
+    result = mErrorCodeCapture ;
+    break ;
+  case kErrorWarningLimitRegister :
+    result = mErrorWarningLimit ;
+    break ;
+  case kReceiveErrorRegister :
+    result = (mReceiveErrorCounter > 255) ? 255 : mReceiveErrorCounter ;
+    break ;
+  case kTransmitErrorRegister :
+    result = (mTransmitErrorCounter > 255) ? 255 : mTransmitErrorCounter ;
+    break ;
+  case kMessageCounterRegister :
+    result = uint32_t (mReceiveFifo.size ()) ;
+    break ;
+  case kClockDividerRegister :
+    result = mClockDivider ;
+    break ;
+  default :
+    if ((inOffset >= kFrameWindowStart) && (inOffset < kFrameWindowEnd) && ((inOffset & 3) == 0)) {
+      const uint32_t index = (inOffset - kFrameWindowStart) / 4 ;
+      if (inResetMode ()) {
+        if (inOffset < kAcceptanceMaskStart) {
+          result = mAcceptanceCode [index] ;
+        }else if (index < 8) {
+          result = mAcceptanceMask [index - 4] ;
+        }
+      }else{
+        result = mReceiveWindow [index] ;
+      }
+    }
+    break ;
+  }
+  return result ;
+}
+
+//------------------------------------------------------------------------------
+//   Register write
+//------------------------------------------------------------------------------
+
+void ACAN_ESP32_EmulatedTWAI::writeRegister (const uint32_t inOffset, const uint32_t inValue) {
+  std::lock_guard <std::mutex> lock (mMutex) ;
+  const uint32_t value = inValue & 0xFF ;
+  switch (inOffset) {
+  case kModeRegister :
+    if ((value & TWAI_RESET_MODE) != 0) {
+      if (!inResetMode ()) {
+        enterResetMode () ;
+      }
+      mMode = value & 0x0F ;
+    }else{
+      const bool leavingReset = inResetMode () ;
+      mMode = value & 0x0F ;
+      if (leavingReset && mBusOff) { //--- Bus-off recovery starts now
+        mBusOnTime = mBus.now () + mBus.bitTime (kBusOffRecoveryBits) ;
+      }
+    }
+    break ;
+  case kCommandRegister :
+    if (((value & TWAI_ABORT_TX) != 0) && mTransmitPending) {
+      mTransmitPending = false ;
+      mTransmitBufferFree = true ;
+      raise (TWAI_TX_INT_ST) ;
+    }
+    if (((value & (TWAI_TX_REQ | TWAI_SELF_RX_REQ)) != 0) && !inResetMode () && mTransmitBufferFree) {
+      mTransmitFrame = decodeFrame (mTransmitBuffer) ;
+      mSelfReception = (value & TWAI_SELF_RX_REQ) != 0 ;
+      mTransmitPending = true ;
+      mTransmitBufferFree = false ;
+      mTransmissionComplete = false ;
+    }
+    if ((value & TWAI_RELEASE_BUF) != 0) {
+      releaseReceiveBuffer () ;
+    }
+    if ((value & TWAI_CLR_OVERRUN) != 0) {
+      mDataOverrun = false ;
+    }
+    break ;
+  case kInterruptEnableRegister :
+    mInterruptEnable = value ;
+    break ;
+  case kBusTiming0Register :
+    if (inResetMode ()) { mBusTiming0 = value ; }
+    break ;
+  case kBusTiming1Register :
+    if (inResetMode ()) { mBusTiming1 = value ; }
+    break ;
+  case kErrorWarningLimitRegister :
+    if (inResetMode ()) { mErrorWarningLimit = value ; }
+    break ;
+  case kReceiveErrorRegister :
+    if (inResetMode ()) { mReceiveErrorCounter = value ; }
+    break ;
+  case kTransmitErrorRegister :
+    if (inResetMode ()) { mTransmitErrorCounter = value ; }
+    break ;
+  case kClockDividerRegister :
+    mClockDivider = value ;
+    break ;
+  default :
+    if ((inOffset >= kFrameWindowStart) && (inOffset < kFrameWindowEnd) && ((inOffset & 3) == 0)) {
+      const uint32_t index = (inOffset - kFrameWindowStart) / 4 ;
+      if (inResetMode ()) {
+        if (inOffset < kAcceptanceMaskStart) {
+          mAcceptanceCode [index] = uint8_t (value) ;
+        }else if (index < 8) {
+          mAcceptanceMask [index - 4] = uint8_t (value) ;
+        }
+      }else if (mTransmitBufferFree) { //--- TX buffer is locked while a frame is pending
+        mTransmitBuffer [index] = uint8_t (value) ;
+      }
+    }
+    break ;
+  }
+}
+
+//------------------------------------------------------------------------------
+//   Mode and interrupts
+//------------------------------------------------------------------------------
+
+bool ACAN_ESP32_EmulatedTWAI::inResetMode (void) const {
+  return (mMode & TWAI_RESET_MODE) != 0 ;
+}
+
+//------------------------------------------------------------------------------
+
+bool ACAN_ESP32_EmulatedTWAI::interruptLine (void) const {
+  const bool rxLevel = ((mInterruptEnable & TWAI_RX_INT_ENA) != 0)
+                    && !inResetMode () && !mReceiveFifo.empty () ;
+  return rxLevel || (mInterrupts != 0) ;
+}
+
+//------------------------------------------------------------------------------
+// TWAI_INT_RAW_REG and TWAI_INT_ENA_REG share bit positions; a flag is only
+// latched when its interrupt is enabled (SJA1000 behaviour)
+
+void ACAN_ESP32_EmulatedTWAI::raise (const uint32_t inInterrupt) {
+  mInterrupts |= inInterrupt & mInterruptEnable ;
+}
+
+//------------------------------------------------------------------------------
+
+void ACAN_ESP32_EmulatedTWAI::enterResetMode (void) {
+  mMode |= TWAI_RESET_MODE ;
+  mTransmitPending = false ;
+  mTransmitBufferFree = true ;
+  mReceiveFifo.clear () ;
+  mReceiveFifoBytes = 0 ;
+  memset (mReceiveWindow, 0, sizeof (mReceiveWindow)) ;
+}
+
+//------------------------------------------------------------------------------
+
+void ACAN_ESP32_EmulatedTWAI::deliverInterrupts (const uint64_t inNowNs) {
+  intr_handler_t handler = nullptr ;
+  void * argument = nullptr ;
+//--- Level triggered: call again while the handler leaves the line asserted
+  for (uint32_t i=0 ; i<8 ; i++) {
+    {
+      std::lock_guard <std::mutex> lock (mMutex) ;
+      if (!interruptLine ()) {
+        mLineAssertedTime = UINT64_MAX ;
+        return ;
+      }
+      if (mLineAssertedTime == UINT64_MAX) {
+        mLineAssertedTime = inNowNs ;
+      }
+      if (inNowNs < (mLineAssertedTime + mInterruptLatency)) {
+        return ;
+      }
+      mInterruptCallCount += 1 ;
+    }
+    if (!acanHostInterruptHandler (mInterruptSource, handler, argument)) {
+      return ;
+    }
+    handler (argument) ;
+  }
+}
+
+//------------------------------------------------------------------------------
+//   Reception
+//------------------------------------------------------------------------------
+
+uint32_t ACAN_ESP32_EmulatedTWAI::fifoBytes (const CANMessage & inFrame) {
+  const uint32_t len = (inFrame.len > 8) ? 8 : inFrame.len ;
+  return (inFrame.ext ? 5 : 3) + (inFrame.rtr ? 0 : len) ;
+}
+
+//------------------------------------------------------------------------------
+
+void ACAN_ESP32_EmulatedTWAI::storeReceivedFrame (const CANMessage & inFrame) {
+  if (!acceptanceFilterPasses (inFrame)) {
+    mFilteredFrameCount += 1 ;
+    return ;
+  }
+  const uint32_t bytes = fifoBytes (inFrame) ;
+  if ((mReceiveFifoBytes + bytes) > mReceiveFifoSize) {
+    mDataOverrun = true ;
+    mReceiveOverrunCount += 1 ;
+    raise (TWAI_OVERRUN_INT_ST) ;
+    return ;
+  }
+  if (mReceiveFifo.empty ()) {
+    encodeFrame (inFrame, mReceiveWindow) ;
+  }
+  mReceiveFifo.push_back (inFrame) ;
+  mReceiveFifoBytes += bytes ;
+  mReceivedFrameCount += 1 ;
+  if (mReceiveFifoPeakCount < mReceiveFifo.size ()) {
+    mReceiveFifoPeakCount = uint32_t (mReceiveFifo.size ()) ;
+  }
+}
+
+//------------------------------------------------------------------------------
+
+void ACAN_ESP32_EmulatedTWAI::releaseReceiveBuffer (void) {
+  if (!mReceiveFifo.empty ()) {
+    mReceiveFifoBytes -= fifoBytes (mReceiveFifo.front ()) ;
+    mReceiveFifo.pop_front () ;
+    if (mReceiveFifo.empty ()) {
+      memset (mReceiveWindow, 0, sizeof (mReceiveWindow)) ;
+    }else{
+      encodeFrame (mReceiveFifo.front (), mReceiveWindow) ;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Acceptance filter (SJA1000 datasheet, figures 9 to 12). A mask bit set to 1
+// means "don't care". Data bytes take part only if the frame carries them.
+
+static inline bool filterMatch (const uint32_t inValue, const uint8_t inCode, const uint8_t inMask) {
+  return ((inValue ^ inCode) & ~ inMask & 0xFF) == 0 ;
+}
+
+bool ACAN_ESP32_EmulatedTWAI::acceptanceFilterPasses (const CANMessage & inFrame) const {
+  const uint8_t * code = mAcceptanceCode ;
+  const uint8_t * mask = mAcceptanceMask ;
+  const bool single = (mMode & TWAI_RX_FILTER_MODE) != 0 ;
+  const uint32_t dataCount = inFrame.rtr ? 0 : inFrame.len ;
+  bool accepted ;
+  if (!inFrame.ext) {
+    const uint32_t id0 = (inFrame.id >> 3) & 0xFF ;
+    const uint32_t id1 = ((inFrame.id << 5) | (inFrame.rtr ? 0x10 : 0)) & 0xF0 ;
+    if (single) {
+      accepted = filterMatch (id0, code [0], mask [0])
+              && filterMatch (id1, code [1], mask [1] | 0x0F)
+              && ((dataCount < 1) || filterMatch (inFrame.data [0], code [2], mask [2]))
+              && ((dataCount < 2) || filterMatch (inFrame.data [1], code [3], mask [3])) ;
+    }else{
+      const bool filter1 = filterMatch (id0, code [0], mask [0])
+                        && filterMatch (id1, code [1], mask [1] | 0x0F)
+                        && ((dataCount < 1)
+                         || (filterMatch (inFrame.data [0] >> 4, code [1] & 0x0F, mask [1] | 0xF0)
+                          && filterMatch (inFrame.data [0] & 0x0F, code [3] & 0x0F, mask [3] | 0xF0))) ;
+      const bool filter2 = filterMatch (id0, code [2], mask [2])
+                        && filterMatch (id1, code [3], mask [3] | 0x0F) ;
+      accepted = filter1 || filter2 ;
+    }
+  }else{
+    const uint32_t id0 = (inFrame.id >> 21) & 0xFF ;
+    const uint32_t id1 = (inFrame.id >> 13) & 0xFF ;
+    if (single) {
+      const uint32_t id2 = (inFrame.id >> 5) & 0xFF ;
+      const uint32_t id3 = ((inFrame.id << 3) | (inFrame.rtr ? 0x04 : 0)) & 0xFC ;
+      accepted = filterMatch (id0, code [0], mask [0])
+              && filterMatch (id1, code [1], mask [1])
+              && filterMatch (id2, code [2], mask [2])
+              && filterMatch (id3, code [3], mask [3] | 0x03) ;
+    }else{
+      accepted = (filterMatch (id0, code [0], mask [0]) && filterMatch (id1, code [1], mask [1]))
+              || (filterMatch (id0, code [2], mask [2]) && filterMatch (id1, code [3], mask [3])) ;
+    }
+  }
+  return accepted ;
+}
+
+//------------------------------------------------------------------------------
+//   Frame layout in the 13 byte RX / TX buffer (PeliCAN)
+//------------------------------------------------------------------------------
+
+void ACAN_ESP32_EmulatedTWAI::encodeFrame (const CANMessage & inFrame, uint8_t outBytes [13]) {
+  memset (outBytes, 0, 13) ;
+  const uint8_t len = (inFrame.len > 8) ? 8 : inFrame.len ;
+  outBytes [0] = uint8_t ((inFrame.ext ? TWAI_FRAME_FORMAT_EFF : TWAI_FRAME_FORMAT_SFF)
+                        | (inFrame.rtr ? TWAI_RTR : 0) | len) ;
+  uint8_t * data ;
+  if (!inFrame.ext) {
+    outBytes [1] = uint8_t (inFrame.id >> 3) ;
+    outBytes [2] = uint8_t (inFrame.id << 5) ;
+    data = & outBytes [3] ;
+  }else{
+    outBytes [1] = uint8_t (inFrame.id >> 21) ;
+    outBytes [2] = uint8_t (inFrame.id >> 13) ;
+    outBytes [3] = uint8_t (inFrame.id >> 5) ;
+    outBytes [4] = uint8_t (inFrame.id << 3) ;
+    data = & outBytes [5] ;
+  }
+  if (!inFrame.rtr) {
+    for (uint8_t i=0 ; i<len ; i++) {
+      data [i] = inFrame.data [i] ;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+
+CANMessage ACAN_ESP32_EmulatedTWAI::decodeFrame (const uint8_t inBytes [13]) {
+  CANMessage frame ;
+  frame.ext = (inBytes [0] & TWAI_FRAME_FORMAT_EFF) != 0 ;
+  frame.rtr = (inBytes [0] & TWAI_RTR) != 0 ;
+  frame.len = inBytes [0] & 0x0F ;
+  if (frame.len > 8) {
+    frame.len = 8 ;
+  }
+  const uint8_t * data ;
+  if (!frame.ext) {
+    frame.id = (uint32_t (inBytes [1]) << 3) | (inBytes [2] >> 5) ;
+    data = & inBytes [3] ;
+  }else{
+    frame.id = (uint32_t (inBytes [1]) << 21) | (uint32_t (inBytes [2]) << 13)
+             | (uint32_t (inBytes [3]) << 5) | (inBytes [4] >> 3) ;
+    data = & inBytes [5] ;
+  }
+  if (!frame.rtr) {
+    for (uint8_t i=0 ; i<frame.len ; i++) {
+      frame.data [i] = data [i] ;
+    }
+  }
+  return frame ;
+}
+
+//------------------------------------------------------------------------------
+//   Error confinement (ISO 11898-1)
+//------------------------------------------------------------------------------
+
+void ACAN_ESP32_EmulatedTWAI::updateErrorState (void) {
+//--- Bus-off: controller enters reset mode, TEC reads 127 until bus-on
+  if (!mBusOff && (mTransmitErrorCounter > 255)) {
+    mBusOff = true ;
+    mBusOffCount += 1 ;
+    mBusOnTime = UINT64_MAX ;
+    enterResetMode () ;
+    mTransmitErrorCounter = 127 ;
+    mReceiveErrorCounter = 0 ;
+    mErrorWarning = true ;
+    raise (TWAI_ERR_WARN_INT_ST) ;
+    return ;
+  }
+  if (mBusOff) {
+    return ;
+  }
+  const bool warning = (mTransmitErrorCounter >= mErrorWarningLimit)
+                    || (mReceiveErrorCounter >= mErrorWarningLimit) ;
+  if (warning != mErrorWarning) {
+    mErrorWarning = warning ;
+    raise (TWAI_ERR_WARN_INT_ST) ;
+  }
+  const bool passive = (mTransmitErrorCounter > 127) || (mReceiveErrorCounter > 127) ;
+  if (passive != mErrorPassive) {
+    mErrorPassive = passive ;
+    raise (TWAI_ERR_PASSIVE_INT_ST) ;
+  }
+}
+
+//------------------------------------------------------------------------------
+//   HostCANNode
+//------------------------------------------------------------------------------
+
+bool ACAN_ESP32_EmulatedTWAI::pendingFrame (uint64_t /* inNowNs */, CANMessage & outFrame) {
+  std::lock_guard <std::mutex> lock (mMutex) ;
+  const bool send = mTransmitPending && !inResetMode () && !mBusOff
+                 && ((mMode & TWAI_LISTEN_ONLY_MODE) == 0) ;
+  if (send) {
+    outFrame = mTransmitFrame ;
+  }
+  return send ;
+}
+
+//------------------------------------------------------------------------------
+
+uint64_t ACAN_ESP32_EmulatedTWAI::nextEventTime (void) const {
+  std::lock_guard <std::mutex> lock (mMutex) ;
+  uint64_t result = mBusOnTime ;
+  if ((mLineAssertedTime != UINT64_MAX) && ((mLineAssertedTime + mInterruptLatency) < result)) {
+    result = mLineAssertedTime + mInterruptLatency ;
+  }
+  return result ;
+}
+
+//------------------------------------------------------------------------------
+
+void ACAN_ESP32_EmulatedTWAI::wake (uint64_t inNowNs) {
+  {
+    std::lock_guard <std::mutex> lock (mMutex) ;
+    if (mBusOff && (inNowNs >= mBusOnTime)) {
+      if (inResetMode ()) { //--- Reset mode entered again: recovery restarts when it is left
+        mBusOnTime = UINT64_MAX ;
+      }else{
+        mBusOff = false ;
+        mBusOnTime = UINT64_MAX ;
+        mTransmitErrorCounter = 0 ;
+        mReceiveErrorCounter = 0 ;
+        mErrorWarning = false ;
+        mErrorPassive = false ;
+        raise (TWAI_ERR_WARN_INT_ST) ;
+      }
+    }
+  }
+  deliverInterrupts (inNowNs) ;
+}
+
+//------------------------------------------------------------------------------
+
+void ACAN_ESP32_EmulatedTWAI::frameSent (const CANMessage & inFrame, uint64_t /* inEndNs */) {
+  std::lock_guard <std::mutex> lock (mMutex) ;
+  mTransmitPending = false ;
+  mTransmitBufferFree = true ;
+  mTransmissionComplete = true ;
+  mTransmittedFrameCount += 1 ;
+  if (mTransmitErrorCounter > 0) {
+    mTransmitErrorCounter -= 1 ;
+  }
+  if (mSelfReception) {
+    storeReceivedFrame (inFrame) ;
+  }
+  updateErrorState () ;
+  raise (TWAI_TX_INT_ST) ;
+}
+
+//------------------------------------------------------------------------------
+
+void ACAN_ESP32_EmulatedTWAI::frameReceived (const CANMessage & inFrame, uint64_t /* inEndNs */) {
+  std::lock_guard <std::mutex> lock (mMutex) ;
+  if (mReceiveErrorCounter > 127) {
+    mReceiveErrorCounter = 120 ;
+  }else if (mReceiveErrorCounter > 0) {
+    mReceiveErrorCounter -= 1 ;
+  }
+  storeReceivedFrame (inFrame) ;
+  updateErrorState () ;
+}
+
+//------------------------------------------------------------------------------
+
+void ACAN_ESP32_EmulatedTWAI::arbitrationLost (const CANMessage & /* inFrame */, uint8_t inBitPosition) {
+  std::lock_guard <std::mutex> lock (mMutex) ;
+  mArbitrationLostCapture = inBitPosition ;
+  raise (TWAI_ARB_LOST_INT_ST) ;
+}
+
+//------------------------------------------------------------------------------
+
+void ACAN_ESP32_EmulatedTWAI::busError (bool inTransmitter, bool inAckError) {
+  std::lock_guard <std::mutex> lock (mMutex) ;
+  if (inTransmitter) {
+  //--- An error passive transmitter does not count ACK errors
+    if (!(inAckError && mErrorPassive)) {
+      mTransmitErrorCounter += 8 ;
+    }
+    mErrorCodeCapture = inAckError ? (kECCOtherError | kECCAckSlot) : (kECCBitError | kECCCRCSeq) ;
+  }else{
+    if (mReceiveErrorCounter < 255) {
+      mReceiveErrorCounter += 1 ;
+    }
+    mErrorCodeCapture = kECCOtherError | kECCReceive | kECCAckDelim ;
+  }
+  raise (TWAI_BUS_ERR_INT_ST) ;
+  updateErrorState () ;
+}
+
+//------------------------------------------------------------------------------
+
+bool ACAN_ESP32_EmulatedTWAI::isActive (void) const {
+  std::lock_guard <std::mutex> lock (mMutex) ;
+  return !inResetMode () && !mBusOff ;
+}
+
+//------------------------------------------------------------------------------
+
+bool ACAN_ESP32_EmulatedTWAI::acknowledges (void) const {
+  std::lock_guard <std::mutex> lock (mMutex) ;
+  return !inResetMode () && !mBusOff && ((mMode & TWAI_LISTEN_ONLY_MODE) == 0) ;
+}
+
+//------------------------------------------------------------------------------
+
+bool ACAN_ESP32_EmulatedTWAI::needsAck (void) const {
+  std::lock_guard <std::mutex> lock (mMutex) ;
+  return (mMode & TWAI_SELF_TEST_MODE) == 0 ;
+}
+
+//------------------------------------------------------------------------------
+// ESP32: BTR0 bits 0-5 BRP - 1, BTR1 bits 0-3 TSEG1 - 1, bits 4-6 TSEG2 - 1
+
+uint32_t ACAN_ESP32_EmulatedTWAI::bitRate (void) const {
+  std::lock_guard <std::mutex> lock (mMutex) ;
+  const uint32_t prescaler = (mBusTiming0 & 0x3F) + 1 ;
+  const uint32_t timeQuanta = 1 + ((mBusTiming1 & 0x0F) + 1) + (((mBusTiming1 >> 4) & 0x07) + 1) ;
+  return CAN_CLOCK () / (prescaler * timeQuanta) ;
+}
+
+//------------------------------------------------------------------------------
+//   Statistics
+//------------------------------------------------------------------------------
+
+uint32_t ACAN_ESP32_EmulatedTWAI::interruptCallCount (void) const {
+  std::lock_guard <std::mutex> lock (mMutex) ;
+  return mInterruptCallCount ;
+}
+
+uint32_t ACAN_ESP32_EmulatedTWAI::receivedFrameCount (void) const {
+  std::lock_guard <std::mutex> lock (mMutex) ;
+  return mReceivedFrameCount ;
+}
+
+uint32_t ACAN_ESP32_EmulatedTWAI::filteredFrameCount (void) const {
+  std::lock_guard <std::mutex> lock (mMutex) ;
+  return mFilteredFrameCount ;
+}
+
+uint32_t ACAN_ESP32_EmulatedTWAI::receiveOverrunCount (void) const {
+  std::lock_guard <std::mutex> lock (mMutex) ;
+  return mReceiveOverrunCount ;
+}
+
+uint32_t ACAN_ESP32_EmulatedTWAI::transmittedFrameCount (void) const {
+  std::lock_guard <std::mutex> lock (mMutex) ;
+  return mTransmittedFrameCount ;
+}
+
+uint32_t ACAN_ESP32_EmulatedTWAI::busOffCount (void) const {
+  std::lock_guard <std::mutex> lock (mMutex) ;
+  return mBusOffCount ;
+}
+
+uint32_t ACAN_ESP32_EmulatedTWAI::receiveFifoCount (void) const {
+  std::lock_guard <std::mutex> lock (mMutex) ;
+  return uint32_t (mReceiveFifo.size ()) ;
+}
+
+uint32_t ACAN_ESP32_EmulatedTWAI::receiveFifoPeakCount (void) const {
+  std::lock_guard <std::mutex> lock (mMutex) ;
+  return mReceiveFifoPeakCount ;
+}
+
+bool ACAN_ESP32_EmulatedTWAI::isBusOff (void) const {
+  std::lock_guard <std::mutex> lock (mMutex) ;
+  return mBusOff ;
+}
+
+//------------------------------------------------------------------------------
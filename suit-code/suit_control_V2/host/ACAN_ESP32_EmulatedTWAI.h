@@ -0,0 +1,190 @@
+//------------------------------------------------------------------------------
+//   REGISTER-LEVEL MODEL OF THE ESP32 TWAI (SJA1000 PeliCAN) CONTROLLER
+//   Host builds only. Every TWAI_xxx () register access made by ACAN_ESP32
+//   lands in readRegister () / writeRegister (), and the controller talks to
+//   the other nodes of a HostCANBus. Modelled behaviour:
+//     - reset / operating / listen-only / self-test modes, with the 0x40..0x70
+//       window mapping the acceptance filter in reset mode and the RX / TX
+//       buffers in operating mode;
+//     - single and dual acceptance filters for standard and extended frames;
+//     - an RX FIFO counted in bytes like the SJA1000 (64 bytes: 3 + DLC per
+//       standard frame, 5 + DLC per extended frame), with data overrun;
+//     - the transmit buffer, TX_REQ, SELF_RX_REQ and ABORT_TX;
+//     - interrupts latched only when enabled, cleared by reading
+//       TWAI_INT_RAW_REG, except RX which stays set while the FIFO is not
+//       empty; the handler given to esp_intr_alloc () is called once the line
+//       has been asserted for the configured interrupt latency (taken at bus
+//       event boundaries, so a frame in progress completes first);
+//     - transmit / receive error counters, error warning, error passive and
+//       bus-off (reset mode is entered, leaving it starts the 128 x 11
+//       recessive bits recovery).
+//   Entering reset mode empties the RX FIFO and drops a pending transmission.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+//------------------------------------------------------------------------------
+//   Include files
+//------------------------------------------------------------------------------
+
+#include <ACAN_ESP32.h>
+#include <HostCANBus.h>
+#include <deque>
+#include <mutex>
+
+//------------------------------------------------------------------------------
+
+class ACAN_ESP32_EmulatedTWAI : public HostCANNode {
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+  //   Constructor: the controller answers at inBaseAddress and raises
+  //   inInterruptSource; it is attached to inBus
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  public: explicit ACAN_ESP32_EmulatedTWAI (HostCANBus & inBus,
+                                            const uint32_t inBaseAddress = twaiBaseAddress,
+                                            const int inInterruptSource = twaiInterruptSource) ;
+
+  public: virtual ~ ACAN_ESP32_EmulatedTWAI (void) ;
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+  //   Configuration
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  public: static const uint32_t kDefaultReceiveFifoSize = 64 ; // Bytes
+
+  public: void setReceiveFifoSize (const uint32_t inBytes) ;
+
+  //--- Delay between the interrupt line going up and the handler running
+  //    (interrupts masked by other code, flash cache misses...)
+  public: void setInterruptLatency (const uint64_t inNanoseconds) ;
+
+  //--- Push the transmit error counter past 255
+  public: void forceBusOff (void) ;
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+  //   Register file (inOffset from the base address)
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  public: uint32_t readRegister (const uint32_t inOffset) ;
+  public: void writeRegister (const uint32_t inOffset, const uint32_t inValue) ;
+
+  public: static ACAN_ESP32_EmulatedTWAI * controllerAt (const uint32_t inAddress) ;
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+  //   Statistics
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  public: uint32_t interruptCallCount (void) const ;
+  public: uint32_t receivedFrameCount (void) const ;    // Stored in the RX FIFO
+  public: uint32_t filteredFrameCount (void) const ;    // Rejected by the acceptance filter
+  public: uint32_t receiveOverrunCount (void) const ;   // Lost on a full RX FIFO
+  public: uint32_t transmittedFrameCount (void) const ;
+  public: uint32_t busOffCount (void) const ;
+  public: uint32_t receiveFifoCount (void) const ;      // Frames waiting in the RX FIFO
+  public: uint32_t receiveFifoPeakCount (void) const ;
+  public: bool isBusOff (void) const ;
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+  //   HostCANNode
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  public: virtual bool pendingFrame (uint64_t inNowNs, CANMessage & outFrame) override ;
+  public: virtual uint64_t nextEventTime (void) const override ;
+  public: virtual void wake (uint64_t inNowNs) override ;
+  public: virtual void frameSent (const CANMessage & inFrame, uint64_t inEndNs) override ;
+  public: virtual void frameReceived (const CANMessage & inFrame, uint64_t inEndNs) override ;
+  public: virtual void arbitrationLost (const CANMessage & inFrame, uint8_t inBitPosition) override ;
+  public: virtual void busError (bool inTransmitter, bool inAckError) override ;
+  public: virtual bool isActive (void) const override ;
+  public: virtual bool acknowledges (void) const override ;
+  public: virtual bool needsAck (void) const override ;
+  public: virtual uint32_t bitRate (void) const override ;
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+  //   Private methods (called with mMutex held)
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  private: bool inResetMode (void) const ;
+  private: bool interruptLine (void) const ;
+  private: void raise (const uint32_t inInterrupt) ;
+  private: void enterResetMode (void) ;
+  private: void storeReceivedFrame (const CANMessage & inFrame) ;
+  private: void releaseReceiveBuffer (void) ;
+  private: void updateErrorState (void) ;
+  private: bool acceptanceFilterPasses (const CANMessage & inFrame) const ;
+  private: static void encodeFrame (const CANMessage & inFrame, uint8_t outBytes [13]) ;
+  private: static CANMessage decodeFrame (const uint8_t inBytes [13]) ;
+  private: static uint32_t fifoBytes (const CANMessage & inFrame) ;
+
+  //--- Call the interrupt handler while the line is asserted (mMutex not held)
+  private: void deliverInterrupts (const uint64_t inNowNs) ;
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+  //   Properties
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  private: mutable std::mutex mMutex ;
+  private: HostCANBus & mBus ;
+  private: const uint32_t mBaseAddress ;
+  private: const int mInterruptSource ;
+
+  //--- Registers
+  private: uint32_t mMode ;
+  private: uint32_t mInterrupts ;          // Latched, except RX (level)
+  private: uint32_t mInterruptEnable ;
+  private: uint32_t mBusTiming0 ;
+  private: uint32_t mBusTiming1 ;
+  private: uint32_t mArbitrationLostCapture ;
+  private: uint32_t mErrorCodeCapture ;
+  private: uint32_t mErrorWarningLimit ;
+  private: uint32_t mReceiveErrorCounter ;
+  private: uint32_t mTransmitErrorCounter ;
+  private: uint32_t mClockDivider ;
+  private: uint8_t mAcceptanceCode [4] ;
+  private: uint8_t mAcceptanceMask [4] ;
+
+  //--- Transmission
+  private: uint8_t mTransmitBuffer [13] ;
+  private: CANMessage mTransmitFrame ;
+  private: bool mTransmitPending ;
+  private: bool mSelfReception ;
+  private: bool mTransmitBufferFree ;      // TBS
+  private: bool mTransmissionComplete ;    // TCS
+
+  //--- Reception
+  private: std::deque <CANMessage> mReceiveFifo ;
+  private: uint32_t mReceiveFifoBytes ;
+  private: uint32_t mReceiveFifoSize ;
+  private: uint8_t mReceiveWindow [13] ;   // Head of the FIFO as seen at 0x40..0x70
+  private: bool mDataOverrun ;
+
+  //--- Error state
+  private: bool mErrorWarning ;
+  private: bool mErrorPassive ;
+  private: bool mBusOff ;
+  private: uint64_t mBusOnTime ;           // End of bus-off recovery, UINT64_MAX if none
+
+  //--- Interrupt delivery
+  private: uint64_t mInterruptLatency ;
+  private: uint64_t mLineAssertedTime ;    // UINT64_MAX while the line is low
+
+  //--- Statistics
+  private: uint32_t mInterruptCallCount ;
+  private: uint32_t mReceivedFrameCount ;
+  private: uint32_t mFilteredFrameCount ;
+  private: uint32_t mReceiveOverrunCount ;
+  private: uint32_t mTransmittedFrameCount ;
+  private: uint32_t mBusOffCount ;
+  private: uint32_t mReceiveFifoPeakCount ;
+
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+  //    No copy
+  // - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+
+  private: ACAN_ESP32_EmulatedTWAI (const ACAN_ESP32_EmulatedTWAI &) = delete ;
+  private: ACAN_ESP32_EmulatedTWAI & operator = (const ACAN_ESP32_EmulatedTWAI &) = delete ;
+
+} ;
+
+//------------------------------------------------------------------------------
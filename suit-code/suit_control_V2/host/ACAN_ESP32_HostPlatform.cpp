@@ -0,0 +1,245 @@
+//------------------------------------------------------------------------------
+//   Include files
+//------------------------------------------------------------------------------
+
+#include <ACAN_ESP32_HostPlatform.h>
+#include <chrono>
+
+//------------------------------------------------------------------------------
+//   Interrupt allocation
+//------------------------------------------------------------------------------
+
+struct ACAN_ESP32_HostInterrupt {
+  int mSource ;
+  intr_handler_t mHandler ;
+  void * mArgument ;
+} ;
+
+static const uint32_t kHostInterruptCount = 4 ;
+static ACAN_ESP32_HostInterrupt gInterrupts [kHostInterruptCount] ;
+static std::mutex gInterruptMutex ;
+
+//------------------------------------------------------------------------------
+
+esp_err_t esp_intr_alloc (const int inSource,
+                          const int /* inFlags */,
+                          intr_handler_t inHandler,
+                          void * inArgument,
+                          intr_handle_t * outHandle) {
+  std::lock_guard <std::mutex> lock (gInterruptMutex) ;
+  for (uint32_t i=0 ; i<kHostInterruptCount ; i++) {
+    ACAN_ESP32_HostInterrupt & entry = gInterrupts [i] ;
+    if (entry.mHandler == nullptr) {
+      entry.mSource = inSource ;
+      entry.mHandler = inHandler ;
+      entry.mArgument = inArgument ;
+      if (outHandle != nullptr) {
+        *outHandle = & entry ;
+      }
+      return ESP_OK ;
+    }
+  }
+  return ESP_ERR_NOT_FOUND ;
+}
+
+//------------------------------------------------------------------------------
+
+esp_err_t esp_intr_free (intr_handle_t inHandle) {
+  std::lock_guard <std::mutex> lock (gInterruptMutex) ;
+  if (inHandle == nullptr) {
+    return ESP_ERR_NOT_FOUND ;
+  }
+  inHandle->mHandler = nullptr ;
+  inHandle->mArgument = nullptr ;
+  return ESP_OK ;
+}
+
+//------------------------------------------------------------------------------
+
+bool acanHostInterruptHandler (const int inSource,
+                               intr_handler_t & outHandler,
+                               void * & outArgument) {
+  std::lock_guard <std::mutex> lock (gInterruptMutex) ;
+  for (uint32_t i=0 ; i<kHostInterruptCount ; i++) {
+    const ACAN_ESP32_HostInterrupt & entry = gInterrupts [i] ;
+    if ((entry.mHandler != nullptr) && (entry.mSource == inSource)) {
+      outHandler = entry.mHandler ;
+      outArgument = entry.mArgument ;
+      return true ;
+    }
+  }
+  return false ;
+}
+
+//------------------------------------------------------------------------------
+//   Clock
+//------------------------------------------------------------------------------
+
+static uint64_t steadyClock (void * /* inContext */) {
+  static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now () ;
+  return uint64_t (std::chrono::duration_cast <std::chrono::nanoseconds> (
+    std::chrono::steady_clock::now () - start).count ()) ;
+}
+
+static ACAN_ESP32_HostClock gClock = steadyClock ;
+static void * gClockContext = nullptr ;
+
+//------------------------------------------------------------------------------
+
+void acanHostSetClock (ACAN_ESP32_HostClock inClock, void * inContext) {
+  gClock = (inClock != nullptr) ? inClock : steadyClock ;
+  gClockContext = (inClock != nullptr) ? inContext : nullptr ;
+}
+
+//------------------------------------------------------------------------------
+
+uint64_t acanHostClockNanoseconds (void) {
+  return gClock (gClockContext) ;
+}
+
+//------------------------------------------------------------------------------
+//   esp_timer
+//------------------------------------------------------------------------------
+
+struct ACAN_ESP32_HostTimer {
+  esp_timer_cb_t mCallback ;
+  void * mArgument ;
+  bool mSkipUnhandledEvents ;
+  bool mAllocated ;
+  bool mArmed ;
+  uint64_t mExpiry ; // ns
+  uint64_t mPeriod ; // ns, 0 for one-shot
+} ;
+
+static const uint32_t kHostTimerCount = 8 ;
+static ACAN_ESP32_HostTimer gTimers [kHostTimerCount] ;
+static std::recursive_mutex gTimerMutex ;
+
+//------------------------------------------------------------------------------
+
+esp_err_t esp_timer_create (const esp_timer_create_args_t * inArgs,
+                            esp_timer_handle_t * outHandle) {
+  if ((inArgs == nullptr) || (inArgs->callback == nullptr) || (outHandle == nullptr)) {
+    return ESP_ERR_INVALID_ARG ;
+  }
+  std::lock_guard <std::recursive_mutex> lock (gTimerMutex) ;
+  for (uint32_t i=0 ; i<kHostTimerCount ; i++) {
+    ACAN_ESP32_HostTimer & timer = gTimers [i] ;
+    if (!timer.mAllocated) {
+      timer = ACAN_ESP32_HostTimer () ;
+      timer.mCallback = inArgs->callback ;
+      timer.mArgument = inArgs->arg ;
+      timer.mSkipUnhandledEvents = inArgs->skip_unhandled_events ;
+      timer.mAllocated = true ;
+      *outHandle = & timer ;
+      return ESP_OK ;
+    }
+  }
+  return ESP_ERR_NO_MEM ;
+}
+
+//------------------------------------------------------------------------------
+
+static esp_err_t startTimer (esp_timer_handle_t inTimer,
+                             const uint64_t inDelayMicroseconds,
+                             const uint64_t inPeriodMicroseconds) {
+  std::lock_guard <std::recursive_mutex> lock (gTimerMutex) ;
+  if ((inTimer == nullptr) || !inTimer->mAllocated) {
+    return ESP_ERR_INVALID_ARG ;
+  }
+  if (inTimer->mArmed) {
+    return ESP_ERR_INVALID_STATE ;
+  }
+  inTimer->mArmed = true ;
+  inTimer->mExpiry = acanHostClockNanoseconds () + inDelayMicroseconds * 1000 ;
+  inTimer->mPeriod = inPeriodMicroseconds * 1000 ;
+  return ESP_OK ;
+}
+
+//------------------------------------------------------------------------------
+
+esp_err_t esp_timer_start_once (esp_timer_handle_t inTimer, const uint64_t inTimeoutMicroseconds) {
+  return startTimer (inTimer, inTimeoutMicroseconds, 0) ;
+}
+
+//------------------------------------------------------------------------------
+
+esp_err_t esp_timer_start_periodic (esp_timer_handle_t inTimer, const uint64_t inPeriodMicroseconds) {
+  if (inPeriodMicroseconds == 0) {
+    return ESP_ERR_INVALID_ARG ;
+  }
+  return startTimer (inTimer, inPeriodMicroseconds, inPeriodMicroseconds) ;
+}
+
+//------------------------------------------------------------------------------
+
+esp_err_t esp_timer_stop (esp_timer_handle_t inTimer) {
+  std::lock_guard <std::recursive_mutex> lock (gTimerMutex) ;
+  if ((inTimer == nullptr) || !inTimer->mArmed) {
+    return ESP_ERR_INVALID_STATE ;
+  }
+  inTimer->mArmed = false ;
+  return ESP_OK ;
+}
+
+//------------------------------------------------------------------------------
+
+esp_err_t esp_timer_delete (esp_timer_handle_t inTimer) {
+  std::lock_guard <std::recursive_mutex> lock (gTimerMutex) ;
+  if ((inTimer == nullptr) || !inTimer->mAllocated) {
+    return ESP_ERR_INVALID_ARG ;
+  }
+  if (inTimer->mArmed) {
+    return ESP_ERR_INVALID_STATE ;
+  }
+  inTimer->mAllocated = false ;
+  return ESP_OK ;
+}
+
+//------------------------------------------------------------------------------
+
+uint64_t acanHostNextTimerEvent (void) {
+  std::lock_guard <std::recursive_mutex> lock (gTimerMutex) ;
+  uint64_t next = UINT64_MAX ;
+  for (uint32_t i=0 ; i<kHostTimerCount ; i++) {
+    const ACAN_ESP32_HostTimer & timer = gTimers [i] ;
+    if (timer.mArmed && (timer.mExpiry < next)) {
+      next = timer.mExpiry ;
+    }
+  }
+  return next ;
+}
+
+//------------------------------------------------------------------------------
+// Earliest expiry first; a callback may start, stop or delete timers
+
+void acanHostRunTimers (const uint64_t inNowNanoseconds) {
+  std::lock_guard <std::recursive_mutex> lock (gTimerMutex) ;
+  bool ran = true ;
+  while (ran) {
+    ACAN_ESP32_HostTimer * expired = nullptr ;
+    for (uint32_t i=0 ; i<kHostTimerCount ; i++) {
+      ACAN_ESP32_HostTimer & timer = gTimers [i] ;
+      if (timer.mArmed && (timer.mExpiry <= inNowNanoseconds)
+       && ((expired == nullptr) || (timer.mExpiry < expired->mExpiry))) {
+        expired = & timer ;
+      }
+    }
+    ran = expired != nullptr ;
+    if (ran) {
+      if (expired->mPeriod == 0) {
+        expired->mArmed = false ;
+      }else{
+        expired->mExpiry += expired->mPeriod ;
+        if (expired->mSkipUnhandledEvents) {
+          while (expired->mExpiry <= inNowNanoseconds) {
+            expired->mExpiry += expired->mPeriod ;
+          }
+        }
+      }
+      expired->mCallback (expired->mArgument) ;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
@@ -0,0 +1,173 @@
+//------------------------------------------------------------------------------
+//   HOST PLATFORM FOR ACAN_ESP32
+//   Included by ACAN_ESP32_TWAI_base_address.h when ARDUINO is not defined.
+//   Provides the handful of ESP-IDF services the driver uses (critical
+//   sections, interrupt allocation, esp_timer) and turns every TWAI register
+//   access into a call to the register-level emulator
+//   (ACAN_ESP32_EmulatedTWAI), so the unmodified driver runs on Linux.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+//------------------------------------------------------------------------------
+//   Include files
+//------------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <mutex>
+
+//------------------------------------------------------------------------------
+//   Emulated target: ESP32 (one TWAI controller)
+//------------------------------------------------------------------------------
+
+#if !defined (CONFIG_IDF_TARGET_ESP32) && !defined (CONFIG_IDF_TARGET_ESP32S2) \
+ && !defined (CONFIG_IDF_TARGET_ESP32S3) && !defined (CONFIG_IDF_TARGET_ESP32C3) \
+ && !defined (CONFIG_IDF_TARGET_ESP32C6)
+  #define CONFIG_IDF_TARGET_ESP32
+#endif
+
+#ifndef CONFIG_IDF_TARGET_ESP32
+  #error "The host emulator only models the ESP32 TWAI controller"
+#endif
+
+static const uint32_t DR_REG_CAN_BASE = 0x3FF6B000 ;
+static const uint32_t TWAI_TX_IDX = 123 ;
+static const uint32_t TWAI_RX_IDX = 94 ;
+
+typedef enum { PERIPH_TWAI_MODULE } periph_module_t ;
+typedef int periph_interrupt_t ;
+static const periph_interrupt_t ETS_TWAI_INTR_SOURCE = 45 ;
+
+typedef int gpio_num_t ;
+
+inline void periph_module_enable (const periph_module_t) {}
+
+//------------------------------------------------------------------------------
+//   Interrupt allocation: the emulator calls the registered handler when its
+//   interrupt line is asserted
+//------------------------------------------------------------------------------
+
+#define IRAM_ATTR
+
+typedef int esp_err_t ;
+static const esp_err_t ESP_OK = 0 ;
+static const esp_err_t ESP_ERR_NOT_FOUND = 0x105 ;
+
+typedef void (*intr_handler_t) (void * inArgument) ;
+typedef struct ACAN_ESP32_HostInterrupt * intr_handle_t ;
+
+esp_err_t esp_intr_alloc (const int inSource,
+                          const int inFlags,
+                          intr_handler_t inHandler,
+                          void * inArgument,
+                          intr_handle_t * outHandle) ;
+
+esp_err_t esp_intr_free (intr_handle_t inHandle) ;
+
+//--- Handler currently allocated for inSource (false if none)
+bool acanHostInterruptHandler (const int inSource,
+                               intr_handler_t & outHandler,
+                               void * & outArgument) ;
+
+//------------------------------------------------------------------------------
+//   Critical sections (recursive, like portMUX on one core)
+//------------------------------------------------------------------------------
+
+typedef struct { std::recursive_mutex mMutex ; } portMUX_TYPE ;
+
+#define portMUX_INITIALIZER_UNLOCKED {}
+#define portENTER_CRITICAL(mux)      ((mux)->mMutex.lock ())
+#define portEXIT_CRITICAL(mux)       ((mux)->mMutex.unlock ())
+#define portENTER_CRITICAL_ISR(mux)  ((mux)->mMutex.lock ())
+#define portEXIT_CRITICAL_ISR(mux)   ((mux)->mMutex.unlock ())
+#define portYIELD_FROM_ISR()         ((void) 0)
+
+//------------------------------------------------------------------------------
+//   Clock: esp_timer_get_time () follows the host clock, which a simulated
+//   bus replaces with its virtual time (see HostCANBus)
+//------------------------------------------------------------------------------
+
+typedef uint64_t (*ACAN_ESP32_HostClock) (void * inContext) ; // Nanoseconds
+
+void acanHostSetClock (ACAN_ESP32_HostClock inClock, void * inContext) ;
+uint64_t acanHostClockNanoseconds (void) ;
+
+inline int64_t esp_timer_get_time (void) {
+  return int64_t (acanHostClockNanoseconds () / 1000) ;
+}
+
+//------------------------------------------------------------------------------
+//   esp_timer callbacks (one-shot and periodic), run against the host clock:
+//   a HostCANBus runs each one at its exact virtual time, even in the
+//   middle of a frame. Without a bus, call acanHostRunTimers () yourself.
+//------------------------------------------------------------------------------
+
+static const esp_err_t ESP_ERR_NO_MEM = 0x101 ;
+static const esp_err_t ESP_ERR_INVALID_ARG = 0x102 ;
+static const esp_err_t ESP_ERR_INVALID_STATE = 0x103 ;
+
+typedef struct ACAN_ESP32_HostTimer * esp_timer_handle_t ;
+typedef void (*esp_timer_cb_t) (void * inArgument) ;
+typedef enum { ESP_TIMER_TASK, ESP_TIMER_ISR } esp_timer_dispatch_t ;
+
+typedef struct {
+  esp_timer_cb_t callback ;
+  void * arg ;
+  esp_timer_dispatch_t dispatch_method ;
+  const char * name ;
+  bool skip_unhandled_events ;
+} esp_timer_create_args_t ;
+
+esp_err_t esp_timer_create (const esp_timer_create_args_t * inArgs,
+                            esp_timer_handle_t * outHandle) ;
+esp_err_t esp_timer_start_once (esp_timer_handle_t inTimer, const uint64_t inTimeoutMicroseconds) ;
+esp_err_t esp_timer_start_periodic (esp_timer_handle_t inTimer, const uint64_t inPeriodMicroseconds) ;
+esp_err_t esp_timer_stop (esp_timer_handle_t inTimer) ;
+esp_err_t esp_timer_delete (esp_timer_handle_t inTimer) ;
+
+//--- Host clock time (ns) of the next expiry, UINT64_MAX if no timer runs
+uint64_t acanHostNextTimerEvent (void) ;
+//--- Run the callbacks of every timer expired at inNowNanoseconds
+void acanHostRunTimers (const uint64_t inNowNanoseconds) ;
+
+//------------------------------------------------------------------------------
+//   Register access, implemented by ACAN_ESP32_EmulatedTWAI
+//------------------------------------------------------------------------------
+
+uint32_t acanHostReadRegister (const uint32_t inAddress) ;
+void acanHostWriteRegister (const uint32_t inAddress, const uint32_t inValue) ;
+
+//------------------------------------------------------------------------------
+// Stands in for "volatile uint32_t &": reads and writes reach the emulator,
+// which applies the side effects of the real register (read-to-clear
+// interrupt flags, RX FIFO window, command bits...)
+//------------------------------------------------------------------------------
+
+class ACAN_ESP32_EmulatedRegister {
+
+  public: inline explicit ACAN_ESP32_EmulatedRegister (const uint32_t inAddress) :
+  mAddress (inAddress) {
+  }
+
+  public: inline operator uint32_t (void) const {
+    return acanHostReadRegister (mAddress) ;
+  }
+
+  public: inline ACAN_ESP32_EmulatedRegister & operator = (const uint32_t inValue) {
+    acanHostWriteRegister (mAddress, inValue) ;
+    return *this ;
+  }
+
+  public: inline ACAN_ESP32_EmulatedRegister & operator |= (const uint32_t inValue) {
+    return *this = acanHostReadRegister (mAddress) | inValue ;
+  }
+
+  public: inline ACAN_ESP32_EmulatedRegister & operator &= (const uint32_t inValue) {
+    return *this = acanHostReadRegister (mAddress) & inValue ;
+  }
+
+  private: const uint32_t mAddress ;
+
+} ;
+
+//------------------------------------------------------------------------------
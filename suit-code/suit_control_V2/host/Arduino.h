@@ -0,0 +1,56 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+
+/*
+ * Arduino.h — the part of the Arduino core used by the CAN layer, for host builds
+ * ------------------------------------------------------------------------------
+ * ‣ Lets CANHandler, Motor, MotorGroup and RemoteDebug compile unchanged on
+ *   Linux (found first because host builds pass -Ihost).
+ * ‣ millis() / micros() follow the host clock, i.e. the virtual time of a
+ *   HostCANBus while one exists, wall-clock time otherwise.
+ * ‣ delay() sleeps in real time; it does not advance a simulated bus.
+ * ‣ Serial writes to stdout. Print is the byte sink part of the Arduino
+ *   class: derive from it to send a dump to a file or a buffer.
+ */
+
+#define PI 3.1415926535897932384626433832795
+
+uint32_t millis();
+uint32_t micros();
+void     delay(uint32_t ms);
+void     delayMicroseconds(uint32_t us);
+
+class Print {
+public:
+    virtual ~Print() = default;
+    virtual size_t write(const uint8_t* buffer, size_t size) = 0;
+    virtual size_t write(uint8_t byte) { return write(&byte, 1); }
+    virtual int availableForWrite() { return 0; }   // 0 → unknown, as on the ESP32
+    virtual void flush() {}
+};
+
+class HardwareSerial : public Print {
+public:
+    using Print::write;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    int    availableForWrite() override { return 4096; }   // stdout never fills up
+    void   begin(unsigned long /*baud*/) {}
+    void   setTxBufferSize(size_t /*size*/) {}
+    void   flush() override;
+    size_t print(const char* text);
+    size_t println(const char* text = "");
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+    operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+#endif  // HOST_ARDUINO_H
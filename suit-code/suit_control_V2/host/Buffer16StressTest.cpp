@@ -0,0 +1,228 @@
+/*
+ * Buffer16StressTest — ACAN_ESP32_Buffer16 between two threads, and its throughput
+ *
+ * A producer thread appends numbered frames (retrying while the ring is
+ * full) and a consumer thread takes them out with remove(), removeBatch(),
+ * consumeAll(), or removeSuperseded() followed by remove(), as the driver's
+ * task / ISR sides do. The consumer checks every frame: sequence numbers
+ * strictly increasing, payload intact, and (without removeSuperseded) none
+ * missing. With removeSuperseded a frame may only be missing if the next
+ * one with its identifier had been queued before the compaction, and the
+ * last frame always arrives. Identifiers are scattered, so compaction has
+ * to move the frames it keeps. Rings of 4 and 64 frames, so both full and
+ * wrapping are exercised; a run that stalls for a second fails. Exits with
+ * status 1 on any failed check, then reports frames per second through each
+ * consumer call.
+ *
+ * Build from suit_control_V2/:
+ *   g++ -std=gnu++17 -O2 -I. host/Buffer16StressTest.cpp -lpthread -o buffer16_stress_test
+ * Under ThreadSanitizer:
+ *   g++ -std=gnu++17 -O1 -g -fsanitize=thread -I. host/Buffer16StressTest.cpp \
+ *       -lpthread -o buffer16_stress_test_tsan
+ *
+ * Usage: buffer16_stress_test [frames]   (default 2 000 000 per run)
+ */
+
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+#include <ACAN_ESP32_Buffer16.h>
+
+enum ConsumerKind { REMOVE, REMOVE_BATCH, CONSUME_ALL, REMOVE_SUPERSEDED };
+
+static const char *const KIND_NAMES[] = { "remove", "removeBatch", "consumeAll", "removeSuperseded" };
+
+// Identifier of frame n: scattered over 0 … 31 (the superseded range), so
+// compaction keeps frames spread through the ring and has to move them
+static uint32_t frameId (uint32_t n) {
+    return uint32_t (n * 2654435761u) >> 27;
+}
+
+// Next frame after n with the same identifier
+static uint32_t nextTwin (uint32_t n) {
+    uint32_t twin = n + 1;
+    while (frameId (twin) != frameId (n)) {
+        ++twin;
+    }
+    return twin;
+}
+
+// Frame n: identifier frameId (n), payload n and its complement
+static CANMessage numberedFrame (uint32_t n) {
+    CANMessage frame;
+    frame.id  = frameId (n);
+    frame.len = 8;
+    for (uint8_t i = 0; i < 4; ++i) {
+        frame.data[i]     = uint8_t (n >> (8 * i));
+        frame.data[4 + i] = uint8_t (~n >> (8 * i));
+    }
+    return frame;
+}
+
+static bool frameNumber (const CANMessage &frame, uint32_t &n) {
+    n = 0;
+    uint32_t complement = 0;
+    for (uint8_t i = 0; i < 4; ++i) {
+        n          |= uint32_t (frame.data[i]) << (8 * i);
+        complement |= uint32_t (frame.data[4 + i]) << (8 * i);
+    }
+    return frame.len == 8 && !frame.ext && complement == ~n && frame.id == frameId (n);
+}
+
+// -------------------------------------------------------------
+// Consumer-side checks
+// -------------------------------------------------------------
+struct Checker {
+    uint32_t next = 0;          // lowest number still expected
+    uint32_t received = 0;
+    uint32_t superseded = 0;    // skipped, legitimately
+    uint32_t errors = 0;
+
+    // appended: frames the producer had queued when the ring was last
+    // compacted (0 → no compaction, nothing may be missing)
+    void frame (const CANMessage &frame, uint32_t appended) {
+        uint32_t n;
+        if (!frameNumber (frame, n)) {
+            report ("corrupted frame");
+            return;
+        }
+        if (n < next) {
+            report ("frame out of order or duplicated");
+            return;
+        }
+        // A skipped frame is only superseded if the next one with its
+        // identifier had been queued
+        for (uint32_t m = next; m < n; ++m) {
+            if (nextTwin (m) >= appended) {
+                report ("frame lost");
+                break;
+            }
+        }
+        superseded += n - next;
+        next = n + 1;
+        ++received;
+    }
+
+    void report (const char *what) {
+        if (errors < 5) {
+            printf ("  %s (after frame %u)\n", what, next);
+        }
+        ++errors;
+    }
+};
+
+// -------------------------------------------------------------
+// One producer / consumer run
+// -------------------------------------------------------------
+static bool run (ConsumerKind kind, uint16_t ringSize, uint32_t frames, double &framesPerSecond) {
+    ACAN_ESP32_Buffer16 ring;
+    ring.initWithSize (ringSize);
+    std::atomic<bool> producerDone{false};
+    std::atomic<uint32_t> appended{0};
+    std::atomic<bool> stopProducer{false};
+
+    const auto start = std::chrono::steady_clock::now ();
+    std::thread producer ([&] {
+        for (uint32_t n = 0; n < frames && !stopProducer.load (std::memory_order_relaxed); ) {
+            if (ring.append (numberedFrame (n))) {
+                appended.store (++n, std::memory_order_release);
+            } else {
+                std::this_thread::yield ();
+            }
+        }
+        producerDone.store (true, std::memory_order_release);
+    });
+
+    Checker checker;
+    const bool supersede = (kind == REMOVE_SUPERSEDED);
+    uint32_t appendedAtCompaction = 0;
+    CANMessage batch[16];
+    auto lastProgress = std::chrono::steady_clock::now ();
+    for (;;) {
+        // Read the flag first, so a last look at the ring after it is set
+        // cannot miss anything
+        const bool done = producerDone.load (std::memory_order_acquire);
+        uint32_t taken = 0;
+        switch (kind) {
+        case REMOVE:
+            while (ring.remove (batch[0])) {
+                checker.frame (batch[0], 0);
+                ++taken;
+            }
+            break;
+        case REMOVE_BATCH:
+            for (uint16_t n; (n = ring.removeBatch (batch, 16)) > 0; ) {
+                for (uint16_t i = 0; i < n; ++i) {
+                    checker.frame (batch[i], 0);
+                }
+                taken += n;
+            }
+            break;
+        case CONSUME_ALL:
+            taken = ring.consumeAll ([&checker] (const CANMessage &frame) {
+                checker.frame (frame, 0);
+            });
+            break;
+        case REMOVE_SUPERSEDED:
+            ring.removeSuperseded ();
+            appendedAtCompaction = appended.load (std::memory_order_acquire);
+            // Take one at a time, so frames pile up for the next compaction
+            if (ring.remove (batch[0])) {
+                checker.frame (batch[0], appendedAtCompaction);
+                ++taken;
+            }
+            break;
+        }
+        if (done && taken == 0 && ring.count () == 0) {
+            break;
+        }
+        if (taken > 0) {
+            lastProgress = std::chrono::steady_clock::now ();
+        } else if (std::chrono::steady_clock::now () - lastProgress > std::chrono::seconds (1)) {
+            checker.report ("stalled");
+            stopProducer.store (true, std::memory_order_relaxed);
+            break;
+        } else {
+            std::this_thread::yield ();
+        }
+    }
+    producer.join ();
+    const double seconds = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+    framesPerSecond = frames / seconds;
+
+    // The newest frame always survives
+    if (checker.next != frames) {
+        checker.report ("last frame missing");
+    }
+    printf ("%-16s ring %2u: %u received", KIND_NAMES[kind], ringSize, checker.received);
+    if (supersede) {
+        printf (", %u superseded", checker.superseded);
+    }
+    printf (", %s\n", (checker.errors == 0) ? "ok" : "FAILED");
+    return checker.errors == 0;
+}
+
+int main (int argc, char *argv[]) {
+    const uint32_t frames = (argc > 1) ? strtoul (argv[1], nullptr, 0) : 2000000;
+    bool ok = true;
+    double throughput[4][2];
+    const uint16_t sizes[2] = { 4, 64 };
+    for (int kind = REMOVE; kind <= REMOVE_SUPERSEDED; ++kind) {
+        for (int s = 0; s < 2; ++s) {
+            ok &= run (ConsumerKind (kind), sizes[s], frames, throughput[kind][s]);
+        }
+    }
+    if (!ok) {
+        printf ("FAILED\n");
+        return 1;
+    }
+    printf ("\nthroughput (frames/s, two threads):\n");
+    for (int kind = REMOVE; kind <= REMOVE_SUPERSEDED; ++kind) {
+        printf ("  %-16s ring 4: %6.2f M   ring 64: %6.2f M\n", KIND_NAMES[kind],
+                throughput[kind][0] / 1e6, throughput[kind][1] / 1e6);
+    }
+    printf ("OK\n");
+    return 0;
+}
@@ -0,0 +1,214 @@
+/*
+ * CANFilterPlannerTest — acceptance filters planned for ID sets, checked
+ *
+ * ‣ Hand-worked sets (the suit's motors among them): the exact set of
+ *   identifiers the plan accepts, single vs dual, and acceptedCount.
+ * ‣ Random sets of 1 … 10 IDs: every ID accepted, acceptedCount equal to
+ *   the identifiers the plan really lets through, and no single filter or
+ *   split over two filters that lets through fewer (found by enumerating
+ *   all 2048 identifiers, not with unionSize()).
+ * ‣ End to end: each hand-worked plan programmed into the emulated TWAI
+ *   controller through ESP32CANTransport, every standard data frame sent
+ *   on the bus, and what reaches drain() compared with plan.accepts().
+ * Prints every failed check and exits with status 1 if there was one.
+ *
+ * Build from suit_control_V2/:
+ *   g++ -std=gnu++17 -O2 -I. -Ihost host/CANFilterPlannerTest.cpp \
+ *       ESP32CANTransport.cpp ACAN_ESP32.cpp ACAN_ESP32_Settings.cpp \
+ *       host/HostArduino.cpp host/HostCANBus.cpp host/ACAN_ESP32_HostPlatform.cpp \
+ *       host/ACAN_ESP32_EmulatedTWAI.cpp -lpthread -o can_filter_planner_test
+ *
+ * Usage: can_filter_planner_test
+ */
+
+#include <Arduino.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "CANFilterPlanner.h"
+#include "ESP32CANTransport.h"
+#include "HostCANBus.h"
+#include "ACAN_ESP32_EmulatedTWAI.h"
+
+static const uint16_t ID_COUNT = 2048;
+
+static int failures = 0;
+
+static void check (bool condition, const char *what, const char *set) {
+    if (!condition) {
+        printf ("FAILED [%s]: %s\n", set, what);
+        ++failures;
+    }
+}
+
+// Identifiers a plan lets through, by enumeration
+static std::vector<uint16_t> acceptedIds (const CANFilterPlan &plan) {
+    std::vector<uint16_t> accepted;
+    for (uint16_t id = 0; id < ID_COUNT; ++id) {
+        if (plan.accepts (id)) {
+            accepted.push_back (id);
+        }
+    }
+    return accepted;
+}
+
+static uint32_t countAccepted (const CANFilterCube &a, const CANFilterCube *b) {
+    uint32_t count = 0;
+    for (uint16_t id = 0; id < ID_COUNT; ++id) {
+        if (a.accepts (id) || (b != nullptr && b->accepts (id))) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+// -------------------------------------------------------------
+// Hand-worked sets
+// -------------------------------------------------------------
+struct Case {
+    const char            *name;
+    std::vector<uint16_t>  ids;
+    bool                   dual;
+    std::vector<uint16_t>  accepted;    // empty with acceptAll
+};
+
+static const std::vector<Case> &cases () {
+    static const std::vector<Case> list = {
+        // Nothing subscribed: the filter stays open
+        { "none",            {},                    false, {} },
+        { "one motor",       { 1 },                 false, { 1 } },
+        { "neighbours",      { 6, 7 },              false, { 6, 7 } },
+        // Single cube 0…7 (8 IDs); {1,2,3} → 0…3 plus {4} exactly is 5
+        { "suit motors",     { 1, 2, 3, 4 },        true,  { 0, 1, 2, 3, 4 } },
+        // Far apart: one exact filter each instead of 1024 IDs
+        { "far pair",        { 0x100, 0x7FF },      true,  { 0x100, 0x7FF } },
+        { "low and high",    { 5, 0x600, 0x601 },   true,  { 5, 0x600, 0x601 } },
+        // Already a cube: single wins the tie with any split
+        { "aligned block",   { 8, 9, 10, 11 },      false, { 8, 9, 10, 11 } },
+        { "two blocks",      { 0x10, 0x11, 0x20, 0x21 }, true, { 0x10, 0x11, 0x20, 0x21 } },
+    };
+    return list;
+}
+
+static void checkCase (const Case &c, const CANFilterPlan &plan) {
+    if (c.ids.empty ()) {
+        check (plan.acceptAll, "empty set accepts all", c.name);
+        check (plan.acceptedCount == ID_COUNT, "acceptedCount is 2048", c.name);
+        check (acceptedIds (plan).size () == ID_COUNT, "all 2048 pass", c.name);
+        return;
+    }
+    check (!plan.acceptAll, "acceptAll clear", c.name);
+    check (plan.dual == c.dual, c.dual ? "dual filter" : "single filter", c.name);
+    check (acceptedIds (plan) == c.accepted, "accepted identifiers", c.name);
+    check (plan.acceptedCount == c.accepted.size (), "acceptedCount", c.name);
+}
+
+// -------------------------------------------------------------
+// Random sets against an exhaustive search
+// -------------------------------------------------------------
+static void checkRandomSets () {
+    std::mt19937 random (6);
+    for (int round = 0; round < 300; ++round) {
+        const uint8_t count = 1 + random () % 10;
+        std::vector<uint16_t> ids;
+        // Mostly nearby IDs, as on the suit, sometimes anywhere
+        const uint16_t base  = random () % ID_COUNT;
+        const uint16_t range = (round % 3 == 0) ? ID_COUNT : 64;
+        while (ids.size () < count) {
+            const uint16_t id = (base + random () % range) % ID_COUNT;
+            if (std::find (ids.begin (), ids.end (), id) == ids.end ()) {
+                ids.push_back (id);
+            }
+        }
+        char name[32];
+        snprintf (name, sizeof (name), "random %d", round);
+
+        const CANFilterPlan plan = planStandardFilter (ids.data (), count);
+        for (uint16_t id : ids) {
+            check (plan.accepts (id), "every ID accepted", name);
+        }
+        check (plan.acceptedCount == acceptedIds (plan).size (), "acceptedCount matches", name);
+
+        const uint32_t all = (1UL << count) - 1;
+        uint32_t best = countAccepted (coverStandardIds (ids.data (), count, all), nullptr);
+        for (uint32_t group1 = 1; group1 < all; ++group1) {
+            const CANFilterCube a = coverStandardIds (ids.data (), count, all & ~group1);
+            const CANFilterCube b = coverStandardIds (ids.data (), count, group1);
+            best = std::min (best, countAccepted (a, &b));
+        }
+        check (plan.acceptedCount == best, "no tighter filter exists", name);
+    }
+}
+
+// -------------------------------------------------------------
+// On the emulated controller
+// -------------------------------------------------------------
+class Sender : public HostCANNode {
+public:
+    bool pendingFrame (uint64_t, CANMessage &frame) override {
+        if (!hasFrame) {
+            return false;
+        }
+        frame = next;
+        return true;
+    }
+    void frameSent (const CANMessage &, uint64_t) override { hasFrame = false; }
+    void frameReceived (const CANMessage &, uint64_t) override {}
+
+    void queue (const CANMessage &frame) {
+        next = frame;
+        hasFrame = true;
+    }
+
+private:
+    CANMessage next;
+    bool       hasFrame = false;
+};
+
+static void countFrame (const CANMessage &message, void *seen) {
+    static_cast<std::vector<bool> *> (seen)->at (message.id) = true;
+}
+
+static void checkOnController () {
+    HostCANBus bus;
+    Sender sender;
+    bus.attach (sender);
+    ACAN_ESP32_EmulatedTWAI twai (bus);
+    ESP32CANTransport &transport = ESP32CANTransport::instance ();
+
+    for (const Case &c : cases ()) {
+        const CANFilterPlan plan = planStandardFilter (c.ids.data (), uint8_t (c.ids.size ()));
+        if (transport.begin (0, 0, 1000000, plan) != 0) {
+            check (false, "controller started", c.name);
+            continue;
+        }
+        std::vector<bool> seen (ID_COUNT, false);
+        CANMessage frame;
+        frame.len = 8;
+        for (uint16_t id = 0; id < ID_COUNT; ++id) {
+            frame.id = id;
+            sender.queue (frame);
+            bus.runUntilIdle ();
+            transport.drain (countFrame, &seen);
+        }
+        uint32_t mismatches = 0;
+        for (uint16_t id = 0; id < ID_COUNT; ++id) {
+            mismatches += (seen[id] != plan.accepts (id));
+        }
+        check (mismatches == 0, "controller passes exactly the planned IDs", c.name);
+    }
+}
+
+int main () {
+    for (const Case &c : cases ()) {
+        checkCase (c, planStandardFilter (c.ids.data (), uint8_t (c.ids.size ())));
+    }
+    checkRandomSets ();
+    checkOnController ();
+    if (failures > 0) {
+        printf ("%d checks failed\n", failures);
+        return 1;
+    }
+    printf ("OK\n");
+    return 0;
+}
@@ -0,0 +1,289 @@
+/*
+ * CANRecordTool — read CANFlightRecorder dumps on Linux
+ *
+ * A dump is what CANFlightRecorder::dump() writes: a CANFlightDumpHeader
+ * followed by its records. The tool looks for the header magic, so a raw
+ * capture of the serial port (text and dumps mixed) can be read directly:
+ *   stty -F /dev/ttyUSB0 921600 raw && cat /dev/ttyUSB0 > suit.log
+ *
+ * Build from suit_control_V2/:
+ *   g++ -std=gnu++17 -O2 -I. -Ihost host/CANRecordTool.cpp CANFlightRecorder.cpp \
+ *       host/ReplayCANNode.cpp ACAN_ESP32.cpp ACAN_ESP32_Settings.cpp \
+ *       host/HostArduino.cpp host/HostCANBus.cpp host/ACAN_ESP32_HostPlatform.cpp \
+ *       host/ACAN_ESP32_EmulatedTWAI.cpp host/SocketCANTransport.cpp \
+ *       -o can_record_tool -lpthread
+ *
+ * Usage:
+ *   can_record_tool candump <file> [interface] [rx|tx|all]
+ *     Every dump in the file as candump log lines, "(s.us) can0 123#0011…",
+ *     which canplayer and the can-utils tools read. Timestamps are driver
+ *     time, unwrapped. Dump headers go to stderr.
+ *   can_record_tool replay <file> <interface|bus> [speed] [rx|tx|all]
+ *     The last dump in the file, at its recorded timing divided by speed
+ *     (default 1, 0 → back to back), either written to a SocketCAN
+ *     interface (can0, vcan0) or onto an in-process HostCANBus at the
+ *     recorded bit rate ("bus"), which reports how closely the bus could
+ *     follow the recorded timing.
+ */
+
+#include <Arduino.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "CANFlightRecorder.h"
+#include "HostCANBus.h"
+#include "ReplayCANNode.h"
+
+#include "SocketCANTransport.h"
+
+struct Dump {
+    CANFlightDumpHeader          header;
+    std::vector<CANFlightRecord> records;
+};
+
+// -------------------------------------------------------------
+// Reading
+// -------------------------------------------------------------
+static bool readFile (const char *path, std::vector<uint8_t> &bytes) {
+    FILE *file = fopen (path, "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    uint8_t buffer[4096];
+    size_t count;
+    while ((count = fread (buffer, 1, sizeof (buffer), file)) > 0) {
+        bytes.insert (bytes.end (), buffer, buffer + count);
+    }
+    fclose (file);
+    return true;
+}
+
+static std::vector<Dump> findDumps (const std::vector<uint8_t> &bytes) {
+    std::vector<Dump> dumps;
+    size_t offset = 0;
+    while (offset + sizeof (CANFlightDumpHeader) <= bytes.size ()) {
+        Dump dump;
+        memcpy (&dump.header, &bytes[offset], sizeof (dump.header));
+        const size_t body = sizeof (CANFlightDumpHeader) +
+                            size_t (dump.header.count) * sizeof (CANFlightRecord);
+        if (memcmp (dump.header.magic, "CANR", 4) != 0 ||
+            dump.header.version != CANFlightRecorder::DUMP_VERSION ||
+            dump.header.recordSize != sizeof (CANFlightRecord) ||
+            offset + body > bytes.size ()) {
+            ++offset;   // Serial text, or a truncated dump
+            continue;
+        }
+        dump.records.resize (dump.header.count);
+        if (dump.header.count > 0) {
+            memcpy (dump.records.data (), &bytes[offset + sizeof (CANFlightDumpHeader)],
+                    size_t (dump.header.count) * sizeof (CANFlightRecord));
+        }
+        dumps.push_back (dump);
+        offset += body;
+    }
+    return dumps;
+}
+
+static bool directionArgument (const char *text, bool &received, bool &transmitted) {
+    received    = strcmp (text, "tx") != 0;
+    transmitted = strcmp (text, "rx") != 0;
+    return strcmp (text, "rx") == 0 || strcmp (text, "tx") == 0 || strcmp (text, "all") == 0;
+}
+
+static bool selected (const CANFlightRecord &record, bool received, bool transmitted) {
+    return (record.id & CAN_RECORD_TX_FLAG) ? transmitted : received;
+}
+
+// -------------------------------------------------------------
+// candump
+// -------------------------------------------------------------
+static void printFrame (const CANFlightRecord &record, uint64_t clock, const char *interfaceName) {
+    CANMessage frame;
+    CANFlightRecorder::toMessage (record, frame);
+    printf ("(%llu.%06llu) %s ", (unsigned long long) (clock / 1'000'000ULL),
+            (unsigned long long) (clock % 1'000'000ULL), interfaceName);
+    printf (frame.ext ? "%08lX#" : "%03lX#", (unsigned long) frame.id);
+    if (frame.rtr) {
+        printf ("R");
+    } else {
+        for (uint8_t i = 0; i < frame.len; ++i) {
+            printf ("%02X", frame.data[i]);
+        }
+    }
+    printf ("\n");
+}
+
+static int candump (const std::vector<Dump> &dumps, const char *interfaceName,
+                    bool received, bool transmitted) {
+    for (size_t i = 0; i < dumps.size (); ++i) {
+        const Dump &dump = dumps[i];
+        fprintf (stderr, "dump %zu: %lu records, %lu dropped, %lu bit/s\n", i,
+                 (unsigned long) dump.header.count, (unsigned long) dump.header.dropped,
+                 (unsigned long) dump.header.bitRate);
+        // Driver time, unwrapped from the first record of each dump
+        uint64_t clock = dump.records.empty () ? 0 : dump.records[0].timestamp;
+        for (size_t r = 0; r < dump.records.size (); ++r) {
+            if (r > 0) {
+                clock += uint32_t (dump.records[r].timestamp - dump.records[r - 1].timestamp);
+            }
+            if (selected (dump.records[r], received, transmitted)) {
+                printFrame (dump.records[r], clock, interfaceName);
+            }
+        }
+    }
+    return 0;
+}
+
+// -------------------------------------------------------------
+// Replay on an in-process bus
+// -------------------------------------------------------------
+class SniffingNode : public HostCANNode {
+public:
+    bool pendingFrame (uint64_t, CANMessage &) override { return false; }
+    void frameReceived (const CANMessage &, uint64_t) override { ++frames; }
+    uint32_t frames = 0;
+};
+
+static int replayOnBus (const Dump &dump, double speed, bool received, bool transmitted) {
+    HostCANBus bus (dump.header.bitRate > 0 ? dump.header.bitRate : 1'000'000UL);
+    ReplayCANNode replay (dump.records);
+    SniffingNode  sniffer;   // acknowledges, and counts what arrives
+    replay.setDirections (received, transmitted);
+    bus.attach (replay);
+    bus.attach (sniffer);
+
+    const uint64_t start = bus.now ();
+    replay.start (start, speed);
+    while (!replay.isFinished () && bus.runUntilIdle (60'000'000'000ULL)) {
+    }
+    bus.detach (sniffer);
+    bus.detach (replay);
+
+    uint64_t recorded = 0;
+    for (size_t i = 1; i < dump.records.size (); ++i) {
+        recorded += uint32_t (dump.records[i].timestamp - dump.records[i - 1].timestamp);
+    }
+    printf ("replayed %lu of %lu frames, received %lu\n",
+            (unsigned long) replay.getSentCount (), (unsigned long) replay.getScheduledCount (),
+            (unsigned long) sniffer.frames);
+    printf ("recorded span %.3f ms, replay took %.3f ms (bus time), bus load %.1f %%\n",
+            recorded / 1000.0, (bus.now () - start) / 1e6, bus.getBusLoad () * 100.0);
+    printf ("lateness (end of frame − scheduled): mean %.1f us, max %.1f us\n",
+            replay.getMeanLateness () / 1000.0, replay.getMaxLateness () / 1000.0);
+    return replay.isFinished () ? 0 : 1;
+}
+
+// -------------------------------------------------------------
+// Replay on SocketCAN
+// -------------------------------------------------------------
+#ifdef __linux__
+static void ignoreFrame (const CANMessage &, void *) {
+}
+#endif
+
+static int replayOnSocketCAN (const Dump &dump, const char *interfaceName, double speed,
+                              bool received, bool transmitted) {
+#ifdef __linux__
+    SocketCANTransport transport (interfaceName);
+    const uint32_t errorCode = transport.begin (0, 0, dump.header.bitRate, CANFilterPlan ());
+    if (errorCode != 0) {
+        fprintf (stderr, "cannot open %s (error 0x%lX)\n", interfaceName, (unsigned long) errorCode);
+        return 1;
+    }
+
+    typedef std::chrono::steady_clock Clock;
+    const Clock::time_point start = Clock::now ();
+    uint64_t offset = 0;      // µs since the first record
+    uint32_t sent = 0;
+    double   maxLate = 0.0;
+    double   totalLate = 0.0;
+    for (size_t i = 0; i < dump.records.size (); ++i) {
+        const CANFlightRecord &record = dump.records[i];
+        if (i > 0) {
+            offset += uint32_t (record.timestamp - dump.records[i - 1].timestamp);
+        }
+        if (!selected (record, received, transmitted)) {
+            continue;
+        }
+        const Clock::time_point due = start + std::chrono::microseconds (
+            speed > 0.0 ? uint64_t (double (offset) / speed) : 0);
+        std::this_thread::sleep_until (due);
+
+        CANMessage message;
+        CANFlightRecorder::toMessage (record, message);
+        // A full interface queue refuses the frame: wait and try again,
+        // unless the interface stays unusable
+        const Clock::time_point refusedSince = Clock::now ();
+        while (!transport.send (message)) {
+            if (Clock::now () - refusedSince > std::chrono::seconds (1)) {
+                fprintf (stderr, "%s refuses frames, stopping after %lu\n", interfaceName,
+                         (unsigned long) sent);
+                return 1;
+            }
+            std::this_thread::sleep_for (std::chrono::microseconds (100));
+        }
+        // Nothing to read: keep the receive queue from filling up
+        transport.drain (ignoreFrame, nullptr);
+
+        const double late = std::chrono::duration<double, std::micro> (Clock::now () - due).count ();
+        maxLate    = (late > maxLate) ? late : maxLate;
+        totalLate += late;
+        ++sent;
+    }
+    printf ("replayed %lu frames on %s (%lu refused and retried)\n", (unsigned long) sent,
+            interfaceName, (unsigned long) transport.getTransmitFailureCount ());
+    printf ("lateness (written − scheduled): mean %.1f us, max %.1f us\n",
+            sent > 0 ? totalLate / sent : 0.0, maxLate);
+    return 0;
+#else
+    (void) dump; (void) speed; (void) received; (void) transmitted;
+    fprintf (stderr, "SocketCAN needs Linux; %s is not available\n", interfaceName);
+    return 1;
+#endif
+}
+
+// -------------------------------------------------------------
+// Main
+// -------------------------------------------------------------
+static int usage () {
+    fprintf (stderr,
+             "usage: can_record_tool candump <file> [interface] [rx|tx|all]\n"
+             "       can_record_tool replay <file> <interface|bus> [speed] [rx|tx|all]\n");
+    return 2;
+}
+
+int main (int argc, char *argv[]) {
+    if (argc < 3) {
+        return usage ();
+    }
+    std::vector<uint8_t> bytes;
+    if (!readFile (argv[2], bytes)) {
+        fprintf (stderr, "cannot read %s\n", argv[2]);
+        return 1;
+    }
+    const std::vector<Dump> dumps = findDumps (bytes);
+    if (dumps.empty ()) {
+        fprintf (stderr, "no dump in %s\n", argv[2]);
+        return 1;
+    }
+
+    bool received = true;
+    bool transmitted = true;
+    if (strcmp (argv[1], "candump") == 0) {
+        if (argc > 4 && !directionArgument (argv[4], received, transmitted)) {
+            return usage ();
+        }
+        return candump (dumps, (argc > 3) ? argv[3] : "can0", received, transmitted);
+    }
+    if (strcmp (argv[1], "replay") == 0 && argc > 3) {
+        const double speed = (argc > 4) ? atof (argv[4]) : 1.0;
+        if (argc > 5 && !directionArgument (argv[5], received, transmitted)) {
+            return usage ();
+        }
+        const Dump &dump = dumps.back ();
+        return (strcmp (argv[3], "bus") == 0)
+             ? replayOnBus (dump, speed, received, transmitted)
+             : replayOnSocketCAN (dump, argv[3], speed, received, transmitted);
+    }
+    return usage ();
+}
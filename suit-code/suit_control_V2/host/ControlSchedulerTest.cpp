@@ -0,0 +1,219 @@
+/*
+ * ControlSchedulerTest — ControlScheduler on a simulated clock
+ *
+ * The host clock is replaced with acanHostSetClock(), so the schedule runs
+ * in simulated time: the test advances the clock in 10 µs steps, fires the
+ * due esp_timer callbacks (acanHostRunTimers()) and calls poll(), and each
+ * stage adds its execution time to the clock.
+ *   ‣ Configuration: stages and periods begin() / addStage() must refuse.
+ *   ‣ Period accuracy: 1 s at 2000 µs with 100 µs of work. Every release
+ *     on its ideal time, at most one step late, dt equal to the period,
+ *     and a ÷10 stage every 10th cycle with dt ten periods.
+ *   ‣ Overrun: one cycle that works 5 ms is a deadline miss, the release
+ *     it overran is skipped (not replayed), the late cycle's dt is the real
+ *     time since the previous one, and the next cycles keep the original
+ *     phase.
+ *   ‣ run(): blocks until the timer wakes it while another thread moves
+ *     the clock, one cycle per release.
+ * Prints every failed check and exits with status 1 if there was one.
+ *
+ * Build from suit_control_V2/:
+ *   g++ -std=gnu++17 -O2 -I. -Ihost host/ControlSchedulerTest.cpp ControlScheduler.cpp \
+ *       host/HostArduino.cpp host/ACAN_ESP32_HostPlatform.cpp -lpthread \
+ *       -o control_scheduler_test
+ *
+ * Usage: control_scheduler_test
+ */
+
+#include <Arduino.h>
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <vector>
+#include "ControlScheduler.h"
+
+static int failures = 0;
+
+#define CHECK(condition) check ((condition), #condition, __LINE__)
+
+static void check (bool condition, const char *what, int line) {
+    if (!condition) {
+        printf ("FAILED (line %d): %s\n", line, what);
+        ++failures;
+    }
+}
+
+// -------------------------------------------------------------
+// Simulated clock
+// -------------------------------------------------------------
+static const uint64_t STEP_US = 10;
+
+static std::atomic<uint64_t> simulatedNs{1000000000ULL};
+
+static uint64_t simulatedClock (void *) {
+    return simulatedNs.load ();
+}
+
+static void advanceUs (uint64_t us) {
+    acanHostRunTimers (simulatedNs.fetch_add (us * 1000) + us * 1000);
+}
+
+static uint64_t nowUs () {
+    return simulatedNs.load () / 1000;
+}
+
+// -------------------------------------------------------------
+// Stages
+// -------------------------------------------------------------
+struct Recorder {
+    std::vector<ControlTick> ticks;
+    uint32_t workUs = 0;      // simulated execution time of each run
+};
+
+static void recordStage (const ControlTick &tick, void *context) {
+    Recorder &recorder = *static_cast<Recorder *> (context);
+    recorder.ticks.push_back (tick);
+    simulatedNs.fetch_add (uint64_t (recorder.workUs) * 1000);
+}
+
+static bool near (float value, float expected, float tolerance) {
+    return fabsf (value - expected) <= tolerance;
+}
+
+// -------------------------------------------------------------
+// Checks
+// -------------------------------------------------------------
+static void checkConfiguration () {
+    Recorder recorder;
+    ControlScheduler scheduler;
+    CHECK (!scheduler.begin (2000));                                   // no stage
+    CHECK (!scheduler.addStage ("zero", recordStage, &recorder, 0));   // divider 0
+    CHECK (!scheduler.addStage ("null", nullptr));
+    CHECK (scheduler.addStage ("control", recordStage, &recorder));
+    CHECK (!scheduler.begin (10));                                     // below esp_timer's minimum
+    CHECK (scheduler.begin (2000));
+    CHECK (!scheduler.begin (2000));                                   // already running
+    CHECK (!scheduler.addStage ("late", recordStage, &recorder));
+    scheduler.end ();
+    CHECK (!scheduler.isRunning ());
+    CHECK (!scheduler.poll ());
+}
+
+static void checkPeriodAndOverrun () {
+    const uint32_t period = 2000;
+    Recorder control;
+    Recorder slow;
+    control.workUs = 100;
+    ControlScheduler scheduler;
+    CHECK (scheduler.addStage ("control", recordStage, &control));
+    CHECK (scheduler.addStage ("slow", recordStage, &slow, 10));
+    const uint64_t begin = nowUs ();
+    CHECK (scheduler.begin (period));
+
+    // One second (500 releases), polled every step
+    while (nowUs () < begin + 500 * period) {
+        advanceUs (STEP_US);
+        scheduler.poll ();
+    }
+    ControlScheduler::Statistics statistics;
+    scheduler.getStatistics (statistics);
+    CHECK (statistics.cycles == 500);
+    CHECK (statistics.deadlineMisses == 0);
+    CHECK (statistics.skippedReleases == 0);
+    CHECK (statistics.maxLateness <= STEP_US);
+    CHECK (control.ticks.size () == 500);
+    CHECK (slow.ticks.size () == 50);
+    uint32_t offPhase = 0;
+    uint32_t badDt = 0;
+    for (size_t i = 0; i < control.ticks.size (); ++i) {
+        const ControlTick &tick = control.ticks[i];
+        offPhase += (tick.cycle != i) || (tick.releaseTime != begin + (i + 1) * period);
+        badDt += !near (tick.dt, period * 1e-6f, STEP_US * 1e-6f);
+    }
+    CHECK (offPhase == 0);
+    CHECK (badDt == 0);
+    uint32_t badSlow = 0;
+    for (size_t i = 0; i < slow.ticks.size (); ++i) {
+        badSlow += (slow.ticks[i].cycle != i * 10) || !near (slow.ticks[i].dt, 10 * period * 1e-6f, 2 * STEP_US * 1e-6f);
+    }
+    CHECK (badSlow == 0);
+    ControlScheduler::StageStatistics stage;
+    CHECK (scheduler.getStageStatistics (1, stage) && stage.runs == 50 && strcmp (stage.name, "slow") == 0);
+    CHECK (!scheduler.getStageStatistics (2, stage));
+
+    // One cycle that works 5 ms: it ends after two more releases have passed
+    scheduler.resetStatistics ();
+    control.ticks.clear ();
+    control.workUs = 5000;
+    while (!scheduler.poll ()) {
+        advanceUs (STEP_US);
+    }
+    control.workUs = 100;
+    for (uint64_t t = 0; t < 20000; t += STEP_US) {
+        advanceUs (STEP_US);
+        scheduler.poll ();
+    }
+    scheduler.getStatistics (statistics);
+    CHECK (statistics.deadlineMisses == 1);
+    CHECK (statistics.skippedReleases == 1);
+    CHECK (statistics.maxExecution >= 5000);
+    CHECK (control.ticks.size () >= 3);
+    if (control.ticks.size () >= 3) {
+        const ControlTick &overrun = control.ticks[0];
+        const ControlTick &late    = control.ticks[1];
+        const ControlTick &next    = control.ticks[2];
+        // The release the 5 ms cycle ran through is skipped, not replayed
+        CHECK (late.cycle == overrun.cycle + 2);
+        CHECK (late.releaseTime == overrun.releaseTime + 2 * period);
+        CHECK (late.lateness >= 1000 - STEP_US && late.lateness <= 1000 + STEP_US);
+        // dt is the time since the overrun cycle started, not the period
+        CHECK (near (late.dt, (late.startTime - overrun.startTime) * 1e-6f, 1e-6f));
+        // And the phase is that of begin()
+        CHECK (next.cycle == late.cycle + 1);
+        CHECK ((next.releaseTime - begin) % period == 0);
+        CHECK (next.lateness <= STEP_US);
+    }
+    scheduler.end ();
+}
+
+static void checkRun () {
+    const uint32_t period = 2000;
+    Recorder control;
+    ControlScheduler scheduler;
+    CHECK (scheduler.addStage ("control", recordStage, &control));
+    CHECK (scheduler.begin (period));
+    // The clock moves in another thread; run() only returns once the timer fired
+    std::atomic<bool> stop{false};
+    std::thread clock ([&stop] {
+        while (!stop.load ()) {
+            std::this_thread::sleep_for (std::chrono::microseconds (20));
+            advanceUs (STEP_US);
+        }
+    });
+    for (int i = 0; i < 10; ++i) {
+        scheduler.run ();
+    }
+    stop.store (true);
+    clock.join ();
+    CHECK (control.ticks.size () == 10);
+    uint32_t badSpacing = 0;
+    for (size_t i = 1; i < control.ticks.size (); ++i) {
+        badSpacing += control.ticks[i].releaseTime - control.ticks[i - 1].releaseTime
+                      != uint64_t (period) * (control.ticks[i].cycle - control.ticks[i - 1].cycle);
+    }
+    CHECK (badSpacing == 0);
+    scheduler.end ();
+}
+
+int main () {
+    acanHostSetClock (simulatedClock, nullptr);
+    checkConfiguration ();
+    checkPeriodAndOverrun ();
+    checkRun ();
+    if (failures > 0) {
+        printf ("%d checks failed\n", failures);
+        return 1;
+    }
+    printf ("OK\n");
+    return 0;
+}
@@ -0,0 +1,174 @@
+/*
+ * DeferredLoggerTest — what DeferredLogger prints, and what log() costs
+ *
+ * ‣ Output: messages with every kind of argument (and logText()) drained
+ *   into a buffer and compared with snprintf of the same format.
+ * ‣ Cost: log() with a short and with a long (about 1000 characters)
+ *   format, the same three arguments each, timed over 1000-message
+ *   batches (best of 300, the ring drained between batches, untimed).
+ *   log() only stores the format pointer, so the two must cost the same:
+ *   a long format more than 1.5× the short one fails. snprintf of the
+ *   same formats is timed alongside, for what formatting at the call site
+ *   would cost.
+ * Exits with status 1 on any failed check.
+ *
+ * Build from suit_control_V2/:
+ *   g++ -std=gnu++17 -O2 -I. -Ihost host/DeferredLoggerTest.cpp DeferredLogger.cpp \
+ *       -lpthread -o deferred_logger_test
+ *
+ * Usage: deferred_logger_test
+ */
+
+#include <Arduino.h>
+#include <chrono>
+#include <string>
+#include "DeferredLogger.h"
+
+static int failures = 0;
+
+// -------------------------------------------------------------
+// Outputs
+// -------------------------------------------------------------
+class StringPrint : public Print {
+public:
+    using Print::write;
+    size_t write (const uint8_t *buffer, size_t size) override {
+        text.append (reinterpret_cast<const char *> (buffer), size);
+        return size;
+    }
+    std::string text;
+};
+
+class NullPrint : public Print {
+public:
+    using Print::write;
+    size_t write (const uint8_t *, size_t size) override { return size; }
+};
+
+// -------------------------------------------------------------
+// Output check
+// -------------------------------------------------------------
+static const char *const NAME = "right hip";
+
+template <typename... Args>
+static void expect (DeferredLogger &logger, std::string &expected, const char *format, Args... args) {
+    char line[DeferredLogger::MESSAGE_LENGTH];
+    snprintf (line, sizeof (line), format, args...);
+    expected += line;
+    if (expected.back () != '\n') {
+        expected += '\n';
+    }
+    logger.log (format, args...);
+}
+
+static void checkOutput () {
+    DeferredLogger logger (16);
+    std::string expected;
+    expect (logger, expected, "plain text\n");
+    expect (logger, expected, "%d %i %u %ld %llu", -7, 42, 3000000000u, -123456789L, 1ULL << 40);
+    expect (logger, expected, "%x %X %o %#x %c %%", 0xBEEFu, 0xBEEFu, 8u, 255u, 'A');
+    expect (logger, expected, "%f %.3f %e %g %8.2f|%-8.2f|", 1.5, -0.0625, 12345.678, 0.0001, 3.14159, 2.5);
+    expect (logger, expected, "%s: %5s|%-5s|%.3s", NAME, "ab", "cd", "truncated");
+    expect (logger, expected, "%*d|%-*d|%.*f", 6, 42, 6, 42, 2, 1.23456);
+    expect (logger, expected, "MOTOR: ID %d p=%.3f v=%.3f t=%.3f T=%d err=%u age=%lu %s",
+            1, 0.5, -1.25, 3.0, 31, 0u, 1200UL, NAME);
+    logger.logText ("copied text");
+    expected += "copied text\n";
+
+    StringPrint out;
+    logger.drain (out);
+    if (out.text != expected) {
+        printf ("FAILED: output differs\n--- expected\n%s--- printed\n%s", expected.c_str (), out.text.c_str ());
+        ++failures;
+    } else {
+        printf ("output: %u messages as snprintf prints them\n", unsigned (logger.getLoggedCount ()));
+    }
+}
+
+// -------------------------------------------------------------
+// Cost
+// -------------------------------------------------------------
+// The long one is far longer than a printed message (MESSAGE_LENGTH), so
+// that any per-character work at the call site would show
+#define LOG_TEST_SENTENCE "the joint reports a position far outside its calibrated range, "
+#define LOG_TEST_PARAGRAPH LOG_TEST_SENTENCE LOG_TEST_SENTENCE LOG_TEST_SENTENCE LOG_TEST_SENTENCE
+
+static const char *const SHORT_FORMAT = "%d %.2f %s";
+static const char *const LONG_FORMAT  =
+    "MOTOR: joint %d at %.2f rad, " LOG_TEST_PARAGRAPH LOG_TEST_PARAGRAPH LOG_TEST_PARAGRAPH
+    LOG_TEST_PARAGRAPH "commands are held until %s is re-zeroed";
+
+static const int BATCH  = 1000;
+static const int ROUNDS = 300;
+
+template <typename Function>
+static double bestNanosecondsPerCall (Function function, DeferredLogger *logger) {
+    NullPrint sink;
+    double best = 1e9;
+    for (int round = 0; round < ROUNDS; ++round) {
+        const auto start = std::chrono::steady_clock::now ();
+        for (int i = 0; i < BATCH; ++i) {
+            function (i);
+        }
+        const double elapsed = std::chrono::duration<double, std::nano> (std::chrono::steady_clock::now () - start).count ();
+        if (elapsed / BATCH < best) {
+            best = elapsed / BATCH;
+        }
+        if (logger != nullptr) {
+            logger->drain (sink);
+        }
+    }
+    return best;
+}
+
+static void checkCost () {
+    DeferredLogger logger (1024);
+    const uint32_t droppedBefore = logger.getDroppedCount ();
+    const double shortLog = bestNanosecondsPerCall ([&] (int i) {
+        logger.log (SHORT_FORMAT, i, i * 0.5, NAME);
+    }, &logger);
+    const double longLog = bestNanosecondsPerCall ([&] (int i) {
+        logger.log (LONG_FORMAT, i, i * 0.5, NAME);
+    }, &logger);
+    const double eightArguments = bestNanosecondsPerCall ([&] (int i) {
+        logger.log ("%d %d %d %d %f %f %s %s", i, i, i, i, i * 0.5, i * 0.25, NAME, NAME);
+    }, &logger);
+
+    char line[DeferredLogger::MESSAGE_LENGTH];
+    volatile char sink = 0;
+    const double shortFormat = bestNanosecondsPerCall ([&] (int i) {
+        snprintf (line, sizeof (line), SHORT_FORMAT, i, i * 0.5, NAME);
+        sink = sink + line[0];
+    }, nullptr);
+    // Truncated on purpose; read through a volatile pointer so the compiler
+    // does not see the literal and warn (-Wformat-truncation)
+    const char *volatile longFormatText = LONG_FORMAT;
+    const double longFormat = bestNanosecondsPerCall ([&] (int i) {
+        snprintf (line, sizeof (line), longFormatText, i, i * 0.5, NAME);
+        sink = sink + line[0];
+    }, nullptr);
+
+    printf ("log()   : short format %.1f ns, long format %.1f ns, 8 arguments %.1f ns\n",
+            shortLog, longLog, eightArguments);
+    printf ("snprintf: short format %.1f ns, long format %.1f ns\n", shortFormat, longFormat);
+
+    if (logger.getDroppedCount () != droppedBefore) {
+        printf ("FAILED: %u messages dropped while timing\n", unsigned (logger.getDroppedCount () - droppedBefore));
+        ++failures;
+    }
+    if (longLog > 1.5 * shortLog) {
+        printf ("FAILED: log() cost depends on the format length (%.1f vs %.1f ns)\n", longLog, shortLog);
+        ++failures;
+    }
+}
+
+int main () {
+    checkOutput ();
+    checkCost ();
+    if (failures > 0) {
+        printf ("%d checks failed\n", failures);
+        return 1;
+    }
+    printf ("OK\n");
+    return 0;
+}
@@ -0,0 +1,305 @@
+/*
+ * EmulatedTWAITest — ACAN_ESP32 on the emulated TWAI controller, checked and timed
+ *
+ * Drives the unmodified driver through the register-level emulator:
+ * ‣ begin (): controller started at the requested bit rate, ACAN_ESP32::isr
+ *   registered for the TWAI interrupt with the driver as its argument.
+ * ‣ tryToSend (): frames reach a peer node in order, with their payload; a
+ *   full queue refuses and accepts again once frames have left.
+ * ‣ Reception through isr (): the bus raises the interrupt and isr drains
+ *   the hardware FIFO; only filtered IDs arrive, timestamps increase.
+ * ‣ isr () and handleRXInterrupt () called directly on a FIFO that holds
+ *   frames (interrupt delayed), then a FIFO overrun under a long latency.
+ * ‣ Error counters: injected errors and the transmit error counter.
+ * ‣ Bus-off: suspendTransmission, discardSupersededFrames and
+ *   recoverFromBusOff, then resumeTransmission sends only the newest
+ *   control frame per motor.
+ * Exits with status 1 if any check failed, then reports transmit and
+ * receive throughput, on the simulated bus and in wall-clock time.
+ *
+ * Build from suit_control_V2/:
+ *   g++ -std=gnu++17 -O2 -I. -Ihost host/EmulatedTWAITest.cpp ACAN_ESP32.cpp \
+ *       ACAN_ESP32_Settings.cpp host/HostCANBus.cpp host/ACAN_ESP32_HostPlatform.cpp \
+ *       host/ACAN_ESP32_EmulatedTWAI.cpp -lpthread -o emulated_twai_test
+ *
+ * Usage: emulated_twai_test [frames]   (benchmark, default 200 000)
+ */
+
+#include <chrono>
+#include <deque>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include <ACAN_ESP32.h>
+#include "HostCANBus.h"
+#include "ACAN_ESP32_EmulatedTWAI.h"
+
+static int failures = 0;
+
+#define CHECK(condition) check ((condition), #condition, __LINE__)
+
+static void check (bool condition, const char *text, int line) {
+    if (!condition) {
+        printf ("FAILED line %d: %s\n", line, text);
+        ++failures;
+    }
+}
+
+// -------------------------------------------------------------
+// The other node on the bus: records what it receives and sends
+// frames at given times
+// -------------------------------------------------------------
+class Peer : public HostCANNode {
+public:
+    std::deque<std::pair<uint64_t, CANMessage>> outgoing;
+    std::vector<CANMessage>                      received;
+
+    bool pendingFrame (uint64_t nowNs, CANMessage &frame) override {
+        if (outgoing.empty () || outgoing.front ().first > nowNs) {
+            return false;
+        }
+        frame = outgoing.front ().second;
+        return true;
+    }
+    uint64_t nextEventTime () const override {
+        return outgoing.empty () ? UINT64_MAX : outgoing.front ().first;
+    }
+    void frameSent (const CANMessage &, uint64_t) override { outgoing.pop_front (); }
+    void frameReceived (const CANMessage &frame, uint64_t) override { received.push_back (frame); }
+
+    void send (uint64_t atNs, uint32_t id, uint8_t length = 8, uint8_t first = 0) {
+        CANMessage frame;
+        frame.id  = id;
+        frame.len = length;
+        frame.data[0] = first;
+        outgoing.push_back ({ atNs, frame });
+    }
+};
+
+static std::vector<CANMessage> drained;
+
+static void collect (const CANMessage &message) {
+    drained.push_back (message);
+}
+
+static CANMessage frameWith (uint32_t id, uint64_t payload) {
+    CANMessage frame;
+    frame.id     = id;
+    frame.len    = 8;
+    frame.data64 = payload;
+    return frame;
+}
+
+// -------------------------------------------------------------
+// Checks, in the order a sketch would use the driver
+// -------------------------------------------------------------
+static void checkBegin (ACAN_ESP32_EmulatedTWAI &twai) {
+    ACAN_ESP32_Settings settings (1000000);
+    // Filter: IDs 0…3 and 0x10
+    const uint32_t error = ACAN_ESP32::can.begin (settings,
+        ACAN_ESP32_Filter::dualStandardFilter (ACAN_ESP32_Filter::data, 0, 3,
+                                               ACAN_ESP32_Filter::data, 0x10, 0));
+    CHECK (error == 0);
+    CHECK (twai.bitRate () == 1000000);
+    intr_handler_t handler = nullptr;
+    void *argument = nullptr;
+    CHECK (acanHostInterruptHandler (twaiInterruptSource, handler, argument));
+    CHECK (handler == &ACAN_ESP32::isr);
+    CHECK (argument == &ACAN_ESP32::can);
+}
+
+static void checkTransmit (HostCANBus &bus, Peer &peer) {
+    peer.received.clear ();
+    uint32_t refused = 0;
+    for (uint32_t i = 0; i < 40; ) {
+        if (ACAN_ESP32::can.tryToSend (frameWith (0x100 + i, 0x0123456789ABCDEFULL * i))) {
+            ++i;
+        } else {
+            ++refused;
+            bus.runFor (130000);   // about one frame
+        }
+    }
+    CHECK (bus.runUntilIdle ());
+    CHECK (refused > 0);           // the queue filled up on the way
+    CHECK (peer.received.size () == 40);
+    for (size_t i = 0; i < peer.received.size (); ++i) {
+        CHECK (peer.received[i].id == 0x100 + i);
+        CHECK (peer.received[i].data64 == 0x0123456789ABCDEFULL * i);
+    }
+}
+
+static void checkReceive (HostCANBus &bus, Peer &peer, ACAN_ESP32_EmulatedTWAI &twai) {
+    const uint32_t interruptsBefore = ACAN_ESP32::can.interruptCount ();
+    const uint32_t filteredBefore   = twai.filteredFrameCount ();
+    const uint64_t now = bus.now ();
+    uint32_t accepted = 0;
+    for (uint8_t i = 0; i < 30; ++i) {
+        const uint32_t id = (i % 7 == 0) ? 0x10 : ((i % 5 == 4) ? 0x77 : (i % 4));
+        accepted += (id != 0x77);
+        peer.send (now, id, 8, i);
+    }
+    CHECK (bus.runUntilIdle ());
+    drained.clear ();
+    ACAN_ESP32::can.drain (collect);
+    CHECK (drained.size () == accepted);
+    CHECK (twai.filteredFrameCount () - filteredBefore == 30 - accepted);
+    CHECK (ACAN_ESP32::can.interruptCount () > interruptsBefore);
+    for (size_t i = 0; i < drained.size (); ++i) {
+        CHECK (drained[i].id < 4 || drained[i].id == 0x10);
+        CHECK (i == 0 || drained[i].timestamp > drained[i - 1].timestamp);
+    }
+}
+
+static void checkDirectInterrupt (HostCANBus &bus, Peer &peer, ACAN_ESP32_EmulatedTWAI &twai) {
+    // Hold the interrupt back so the frames wait in the hardware FIFO
+    twai.setInterruptLatency (50'000'000ULL);
+    const uint64_t now = bus.now ();
+    for (uint8_t i = 0; i < 3; ++i) {
+        peer.send (now, 1, 8, i);
+    }
+    bus.runFor (1'000'000ULL);
+    CHECK (twai.receiveFifoCount () == 3);
+    CHECK (ACAN_ESP32::can.driverReceiveBufferCount () == 0);
+
+    // One frame per handleRXInterrupt ()
+    ACAN_ESP32::can.handleRXInterrupt ();
+    CHECK (twai.receiveFifoCount () == 2);
+    CHECK (ACAN_ESP32::can.driverReceiveBufferCount () == 1);
+
+    // isr () empties the rest of the FIFO
+    const uint32_t interruptsBefore = ACAN_ESP32::can.interruptCount ();
+    ACAN_ESP32::isr (&ACAN_ESP32::can);
+    CHECK (ACAN_ESP32::can.interruptCount () == interruptsBefore + 1);
+    CHECK (twai.receiveFifoCount () == 0);
+    drained.clear ();
+    ACAN_ESP32::can.drain (collect);
+    CHECK (drained.size () == 3);
+    for (uint8_t i = 0; i < drained.size (); ++i) {
+        CHECK (drained[i].data[0] == i);
+    }
+
+    // Far too slow an interrupt: the 64-byte FIFO overruns
+    twai.setInterruptLatency (2'000'000ULL);
+    const uint64_t burst = bus.now ();
+    for (uint8_t i = 0; i < 30; ++i) {
+        peer.send (burst, 2, 8, i);
+    }
+    bus.runUntilIdle ();
+    CHECK (ACAN_ESP32::can.hardwareOverrunCount () > 0);
+    CHECK (twai.receiveOverrunCount () > 0);
+    CHECK (ACAN_ESP32::can.maxFramesPerInterrupt () > 1);
+    twai.setInterruptLatency (0);
+    ACAN_ESP32::can.drain (collect);
+}
+
+static void checkErrorCounters (HostCANBus &bus) {
+    // Each error +8, the successful retry −1
+    bus.injectErrors (3);
+    CHECK (ACAN_ESP32::can.tryToSend (frameWith (0x200, 0)));
+    CHECK (bus.runUntilIdle ());
+    CHECK (uint32_t (ACAN_ESP32::can.TWAI_TX_ERR_CNT_REG ()) == 23);
+}
+
+static void checkBusOff (HostCANBus &bus, Peer &peer, ACAN_ESP32_EmulatedTWAI &twai) {
+    twai.forceBusOff ();
+    CHECK ((ACAN_ESP32::can.statusFlags () & 4) != 0);
+    ACAN_ESP32::can.suspendTransmission ();
+    CHECK (ACAN_ESP32::can.transmissionSuspended ());
+
+    // Commands keep coming while the bus is off: two per motor
+    const uint32_t discardsBefore = ACAN_ESP32::can.transmitDiscardCount ();
+    for (uint32_t round = 0; round < 2; ++round) {
+        for (uint32_t motor = 1; motor <= 4; ++motor) {
+            CHECK (ACAN_ESP32::can.tryToSend (frameWith (motor, round), ACAN_ESP32::control));
+        }
+    }
+    CHECK (ACAN_ESP32::can.discardSupersededFrames () == 4);
+    CHECK (ACAN_ESP32::can.transmitDiscardCount () - discardsBefore == 4);
+
+    CHECK (ACAN_ESP32::can.recoverFromBusOff ());
+    bus.runFor (1'000'000ULL);          // 128 × 11 recessive bits: 1.41 ms
+    CHECK (twai.isBusOff ());
+    bus.runFor (500'000ULL);
+    CHECK (!twai.isBusOff ());
+
+    peer.received.clear ();
+    ACAN_ESP32::can.resumeTransmission ();
+    CHECK (!ACAN_ESP32::can.transmissionSuspended ());
+    CHECK (bus.runUntilIdle ());
+    CHECK (peer.received.size () == 4);
+    for (size_t i = 0; i < peer.received.size (); ++i) {
+        CHECK (peer.received[i].id == i + 1);
+        CHECK (peer.received[i].data64 == 1);   // the newest command
+    }
+}
+
+// -------------------------------------------------------------
+// Throughput
+// -------------------------------------------------------------
+static void benchmark (HostCANBus &bus, Peer &peer, uint32_t frames) {
+    peer.received.clear ();
+    bus.resetStatistics ();
+    auto wallStart = std::chrono::steady_clock::now ();
+    uint64_t busStart = bus.now ();
+    for (uint32_t sent = 0; sent < frames; ) {
+        if (ACAN_ESP32::can.tryToSend (frameWith (0x120, sent))) {
+            ++sent;
+        } else {
+            bus.runFor (100'000ULL);
+        }
+    }
+    bus.runUntilIdle ();
+    double wall    = std::chrono::duration<double> (std::chrono::steady_clock::now () - wallStart).count ();
+    double onBus = (bus.now () - busStart) / 1e9;
+    CHECK (peer.received.size () == frames);
+    printf ("transmit: %u frames, %.0f frames/s on the bus (load %.2f), %.0f frames/s wall\n",
+            frames, frames / onBus, bus.getBusLoad (), frames / wall);
+
+    drained.clear ();
+    bus.resetStatistics ();
+    ACAN_ESP32::can.resetInterruptStatistics ();
+    wallStart = std::chrono::steady_clock::now ();
+    busStart  = bus.now ();
+    for (uint32_t i = 0; i < frames; ++i) {
+        peer.send (busStart, 1);
+        // Keep the peer's backlog short, and the driver's buffer drained
+        if (peer.outgoing.size () >= 16) {
+            bus.runFor (1'000'000ULL);
+            ACAN_ESP32::can.drain (collect);
+        }
+    }
+    bus.runUntilIdle ();
+    ACAN_ESP32::can.drain (collect);
+    wall     = std::chrono::duration<double> (std::chrono::steady_clock::now () - wallStart).count ();
+    onBus = (bus.now () - busStart) / 1e9;
+    CHECK (drained.size () == frames);
+    printf ("receive : %u frames, %.0f frames/s on the bus (load %.2f), %.0f frames/s wall, "
+            "%u per interrupt at most\n", frames, frames / onBus, bus.getBusLoad (), frames / wall,
+            ACAN_ESP32::can.maxFramesPerInterrupt ());
+}
+
+int main (int argc, char *argv[]) {
+    const uint32_t frames = (argc > 1) ? strtoul (argv[1], nullptr, 0) : 200000;
+    HostCANBus bus (1000000);
+    ACAN_ESP32_EmulatedTWAI twai (bus);
+    Peer peer;
+    bus.attach (peer);
+
+    checkBegin (twai);
+    checkTransmit (bus, peer);
+    checkReceive (bus, peer, twai);
+    checkDirectInterrupt (bus, peer, twai);
+    checkErrorCounters (bus);
+    checkBusOff (bus, peer, twai);
+    if (failures > 0) {
+        printf ("%d checks failed\n", failures);
+        return 1;
+    }
+    benchmark (bus, peer, frames);
+    if (failures > 0) {
+        printf ("%d checks failed\n", failures);
+        return 1;
+    }
+    printf ("OK\n");
+    return 0;
+}
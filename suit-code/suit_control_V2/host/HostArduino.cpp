@@ -0,0 +1,52 @@
+#include <Arduino.h>
+#include <ACAN_ESP32_HostPlatform.h>
+#include <chrono>
+#include <thread>
+
+HardwareSerial Serial;
+
+// -------------------------------------------------------------
+// Time
+// -------------------------------------------------------------
+uint32_t millis () {
+    return uint32_t (acanHostClockNanoseconds () / 1'000'000ULL);
+}
+
+uint32_t micros () {
+    return uint32_t (acanHostClockNanoseconds () / 1'000ULL);
+}
+
+void delay (uint32_t ms) {
+    std::this_thread::sleep_for (std::chrono::milliseconds (ms));
+}
+
+void delayMicroseconds (uint32_t us) {
+    std::this_thread::sleep_for (std::chrono::microseconds (us));
+}
+
+// -------------------------------------------------------------
+// Serial → stdout
+// -------------------------------------------------------------
+void HardwareSerial::flush () {
+    fflush (stdout);
+}
+
+size_t HardwareSerial::write (const uint8_t *buffer, size_t size) {
+    return fwrite (buffer, 1, size, stdout);
+}
+
+size_t HardwareSerial::print (const char *text) {
+    return fputs (text, stdout) >= 0 ? strlen (text) : 0;
+}
+
+size_t HardwareSerial::println (const char *text) {
+    return print (text) + print ("\n");
+}
+
+size_t HardwareSerial::printf (const char *format, ...) {
+    va_list args;
+    va_start (args, format);
+    const int written = vprintf (format, args);
+    va_end (args);
+    return written > 0 ? size_t (written) : 0;
+}
@@ -0,0 +1,342 @@
+#include "HostCANBus.h"
+#include <ACAN_ESP32_HostPlatform.h>
+#include <algorithm>
+
+// Bits after the CRC field: CRC delimiter, ACK slot + delimiter, EOF, intermission
+static const uint32_t TRAILER_BITS     = 1 + 2 + 7 + 3;
+// Error flag, error delimiter and intermission that follow a detected error
+static const uint32_t ERROR_FRAME_BITS = 6 + 8 + 3;
+
+// -------------------------------------------------------------
+// Construction
+// -------------------------------------------------------------
+HostCANBus::HostCANBus (uint32_t bitRate) : bitRate (bitRate), random (1) {
+    acanHostSetClock (clock, this);
+}
+
+HostCANBus::~HostCANBus () {
+    acanHostSetClock (nullptr, nullptr);
+}
+
+uint64_t HostCANBus::clock (void *bus) {
+    return static_cast<HostCANBus *>(bus)->now ();
+}
+
+void HostCANBus::attach (HostCANNode &node) {
+    if (std::find (nodes.begin (), nodes.end (), &node) == nodes.end ()) {
+        nodes.push_back (&node);
+    }
+}
+
+void HostCANBus::detach (HostCANNode &node) {
+    nodes.erase (std::remove (nodes.begin (), nodes.end (), &node), nodes.end ());
+}
+
+uint32_t HostCANBus::getBitRate () const {
+    return bitRate;
+}
+
+uint64_t HostCANBus::now () const {
+    return time.load (std::memory_order_relaxed);
+}
+
+uint64_t HostCANBus::bitTime (uint32_t bits) const {
+    return uint64_t (bits) * 1'000'000'000ULL / bitRate;
+}
+
+// -------------------------------------------------------------
+// Frame timing
+// -------------------------------------------------------------
+uint32_t HostCANBus::frameBits (const CANMessage &frame) {
+    // Build the stuffed part of the frame (SOF … CRC) bit by bit
+    uint8_t  bits[128];
+    uint32_t count = 0;
+    auto push = [&] (uint32_t value, uint8_t width) {
+        while (width > 0) {
+            --width;
+            bits[count++] = (value >> width) & 1;
+        }
+    };
+    const uint8_t len = (frame.len > 8) ? 8 : frame.len;
+
+    push (0, 1);                                   // SOF
+    if (!frame.ext) {
+        push (frame.id & 0x7FF, 11);
+        push (frame.rtr, 1);
+        push (0, 2);                               // IDE, r0
+    } else {
+        push ((frame.id >> 18) & 0x7FF, 11);
+        push (3, 2);                               // SRR, IDE
+        push (frame.id & 0x3FFFF, 18);
+        push (frame.rtr, 1);
+        push (0, 2);                               // r1, r0
+    }
+    push (len, 4);
+    if (!frame.rtr) {
+        for (uint8_t i = 0; i < len; ++i) {
+            push (frame.data[i], 8);
+        }
+    }
+
+    // CRC-15, polynomial 0x4599
+    uint32_t crc = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        const uint32_t next = bits[i] ^ ((crc >> 14) & 1);
+        crc = (crc << 1) & 0x7FFF;
+        if (next) {
+            crc ^= 0x4599;
+        }
+    }
+    push (crc, 15);
+
+    // A stuff bit follows every run of five identical bits and starts the next run
+    uint32_t stuffBits = 0;
+    int      previous  = -1;
+    uint8_t  run       = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        if (bits[i] == previous) {
+            ++run;
+        } else {
+            previous = bits[i];
+            run = 1;
+        }
+        if (run == 5) {
+            ++stuffBits;
+            previous = !bits[i];
+            run = 1;
+        }
+    }
+    return count + stuffBits + TRAILER_BITS;
+}
+
+uint64_t HostCANBus::frameDuration (const CANMessage &frame) const {
+    return bitTime (frameBits (frame));
+}
+
+// -------------------------------------------------------------
+// Error injection
+// -------------------------------------------------------------
+void HostCANBus::injectErrors (uint32_t count) {
+    errorsToInject += count;
+}
+
+void HostCANBus::setErrorRate (double probability, uint32_t seed) {
+    errorRate = probability;
+    random.seed (seed);
+}
+
+bool HostCANBus::corruptNext () {
+    if (errorsToInject > 0) {
+        --errorsToInject;
+        return true;
+    }
+    return errorRate > 0.0 &&
+           std::uniform_real_distribution<double> (0.0, 1.0) (random) < errorRate;
+}
+
+// -------------------------------------------------------------
+// Simulation
+// -------------------------------------------------------------
+
+// Arbitration field, most significant bit first and left aligned, so a
+// smaller value wins and the first differing bit is where the loser drops out.
+static uint32_t arbitrationKey (const CANMessage &frame) {
+    if (!frame.ext) {   // ID28…18, RTR, IDE=0
+        return (((frame.id & 0x7FF) << 2) | (uint32_t (frame.rtr) << 1)) << 19;
+    }
+    // ID28…18, SRR=1, IDE=1, ID17…0, RTR
+    return (((frame.id >> 18) & 0x7FF) << 21) | (3UL << 19) |
+           ((frame.id & 0x3FFFF) << 1) | uint32_t (frame.rtr);
+}
+
+bool HostCANBus::sameRate (const HostCANNode &node) const {
+    const uint32_t rate = node.bitRate ();
+    if (rate == 0) {
+        return true;
+    }
+    const uint32_t error = (rate > bitRate) ? rate - bitRate : bitRate - rate;
+    return uint64_t (error) * 200 <= bitRate;   // within 0.5 %
+}
+
+void HostCANBus::advanceTo (uint64_t timeNs) {
+    // esp_timer callbacks run at their own expiry, even in the middle of a frame
+    for (uint64_t timer = acanHostNextTimerEvent (); timer <= timeNs;
+         timer = acanHostNextTimerEvent ()) {
+        if (timer > now ()) {
+            time.store (timer, std::memory_order_relaxed);
+        }
+        acanHostRunTimers (now ());
+    }
+    if (timeNs > now ()) {
+        time.store (timeNs, std::memory_order_relaxed);
+    }
+}
+
+uint64_t HostCANBus::nextEvent (uint64_t limitNs) const {
+    uint64_t next = std::min (limitNs, acanHostNextTimerEvent ());
+    for (HostCANNode *node : nodes) {
+        const uint64_t t = node->nextEventTime ();
+        if (t > now () && t < next) {
+            next = t;
+        }
+    }
+    return next;
+}
+
+void HostCANBus::wakeAll () {
+    for (HostCANNode *node : nodes) {
+        node->wake (now ());
+    }
+}
+
+// Start a frame on the idle bus and run it to its end; false if nobody sends
+bool HostCANBus::startFrame () {
+    struct Candidate { HostCANNode *node; CANMessage frame; uint32_t key; };
+    Candidate candidates[16];
+    uint32_t  candidateCount = 0;
+    bool      garbage = false;
+
+    for (HostCANNode *node : nodes) {
+        CANMessage frame;
+        if (candidateCount < 16 && node->pendingFrame (now (), frame)) {
+            if (!sameRate (*node)) {
+                // Wrong bit timing: the node only produces errors
+                garbage = true;
+                node->busError (true, false);
+                continue;
+            }
+            candidates[candidateCount++] = { node, frame, arbitrationKey (frame) };
+        }
+    }
+    if (garbage) {
+        for (HostCANNode *node : nodes) {
+            if (node->isActive () && sameRate (*node)) {
+                node->busError (false, false);
+            }
+        }
+        ++errorFrames;
+        const uint64_t duration = bitTime (ERROR_FRAME_BITS + 3);
+        busyTime += duration;
+        advanceTo (now () + duration);
+        wakeAll ();
+        return true;
+    }
+    if (candidateCount == 0) {
+        return false;
+    }
+
+    // Bitwise arbitration (same identifier from two nodes: first attached wins)
+    uint32_t winner = 0;
+    for (uint32_t i = 1; i < candidateCount; ++i) {
+        if (candidates[i].key < candidates[winner].key) {
+            winner = i;
+        }
+    }
+    if (candidateCount > 1) {
+        ++arbitrations;
+    }
+    for (uint32_t i = 0; i < candidateCount; ++i) {
+        if (i != winner) {
+            const uint32_t diff = candidates[i].key ^ candidates[winner].key;
+            const uint8_t bit = (diff != 0) ? __builtin_clz (diff) : 31;
+            candidates[i].node->arbitrationLost (candidates[i].frame, bit);
+        }
+    }
+    HostCANNode *sender = candidates[winner].node;
+    const CANMessage &frame = candidates[winner].frame;
+    const uint32_t bits = frameBits (frame);
+
+    bool acknowledged = !sender->needsAck ();
+    for (HostCANNode *node : nodes) {
+        if (node != sender && node->acknowledges () && sameRate (*node)) {
+            acknowledged = true;
+        }
+    }
+
+    uint64_t duration;
+    if (!acknowledged) {
+        // Error flag starts right after the ACK slot
+        duration = bitTime (bits - TRAILER_BITS + 2 + ERROR_FRAME_BITS);
+        advanceTo (now () + duration);
+        sender->busError (true, true);
+        ++errorFrames;
+    } else if (corruptNext ()) {
+        // Detected by the receivers at the end of the CRC field
+        duration = bitTime (bits - TRAILER_BITS + ERROR_FRAME_BITS);
+        advanceTo (now () + duration);
+        sender->busError (true, false);
+        for (HostCANNode *node : nodes) {
+            if (node != sender && node->isActive () && sameRate (*node)) {
+                node->busError (false, false);
+            }
+        }
+        ++errorFrames;
+    } else {
+        duration = bitTime (bits);
+        advanceTo (now () + duration);
+        sender->frameSent (frame, now ());
+        for (HostCANNode *node : nodes) {
+            if (node != sender && node->isActive () && sameRate (*node)) {
+                node->frameReceived (frame, now ());
+            }
+        }
+        ++frames;
+    }
+    busyTime += duration;
+    wakeAll ();
+    return true;
+}
+
+void HostCANBus::runUntil (uint64_t endNs) {
+    wakeAll ();
+    while (now () < endNs) {
+        if (startFrame ()) {
+            continue;
+        }
+        // Idle bus: jump to the next scheduled event
+        advanceTo (nextEvent (endNs));
+        wakeAll ();
+    }
+}
+
+void HostCANBus::runFor (uint64_t durationNs) {
+    runUntil (now () + durationNs);
+}
+
+bool HostCANBus::runUntilIdle (uint64_t maxNs) {
+    const uint64_t deadline = now () + maxNs;
+    wakeAll ();
+    while (now () < deadline) {
+        if (startFrame ()) {
+            continue;
+        }
+        const uint64_t next = nextEvent (UINT64_MAX);
+        if (next == UINT64_MAX) {
+            return true;
+        }
+        advanceTo (std::min (next, deadline));
+        wakeAll ();
+    }
+    return false;
+}
+
+// -------------------------------------------------------------
+// Statistics
+// -------------------------------------------------------------
+uint64_t HostCANBus::getFrameCount () const       { return frames; }
+uint64_t HostCANBus::getErrorFrameCount () const  { return errorFrames; }
+uint64_t HostCANBus::getArbitrationCount () const { return arbitrations; }
+uint64_t HostCANBus::getBusyTime () const         { return busyTime; }
+
+float HostCANBus::getBusLoad () const {
+    const uint64_t elapsed = now () - statsStart;
+    return (elapsed == 0) ? 0.0f : float (double (busyTime) / double (elapsed));
+}
+
+void HostCANBus::resetStatistics () {
+    statsStart   = now ();
+    frames       = 0;
+    errorFrames  = 0;
+    arbitrations = 0;
+    busyTime     = 0;
+}
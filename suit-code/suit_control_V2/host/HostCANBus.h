@@ -0,0 +1,130 @@
+#ifndef HOST_CAN_BUS_H
+#define HOST_CAN_BUS_H
+
+#include <stdint.h>
+#include <vector>
+#include <random>
+#include <atomic>
+#include <ACAN_ESP32_CANMessage.h>
+
+/*
+ * HostCANBus — simulated CAN bus for host (Linux) builds
+ * -------------------------------------------------------
+ * ‣ Not part of the sketch: the Arduino IDE does not compile host/.
+ * ‣ Nodes (HostCANNode) attached to a bus exchange CANMessage frames in
+ *   virtual time, counted in nanoseconds.
+ * ‣ A frame occupies the bus for its real length at the bus bit rate:
+ *   exact bit stuffing (computed over the frame and its CRC-15), the
+ *   delimiters, EOF and the 3-bit intermission.
+ * ‣ When several nodes have a frame ready as the bus goes idle, bitwise
+ *   arbitration on the identifier picks the winner; losers are told the
+ *   bit at which they lost and retry on the next idle bus.
+ * ‣ Error injection: injectErrors() destroys the next frames,
+ *   setErrorRate() destroys frames at random. A destroyed frame is followed
+ *   by an error frame and is retried by its sender. A frame nobody
+ *   acknowledges ends in an ACK error.
+ * ‣ The bus drives the host clock, so esp_timer_get_time() (and the RX
+ *   timestamps of ACAN_ESP32) follow virtual time while it exists, and it
+ *   runs esp_timer callbacks at their exact virtual expiry.
+ *
+ * Build from suit_control_V2/ (example):
+ *   g++ -std=gnu++17 -O2 -I. -Ihost my_bench.cpp ACAN_ESP32.cpp \
+ *       ACAN_ESP32_Settings.cpp host/HostCANBus.cpp \
+ *       host/ACAN_ESP32_HostPlatform.cpp host/ACAN_ESP32_EmulatedTWAI.cpp -o my_bench
+ */
+
+class HostCANNode {
+public:
+    virtual ~HostCANNode() = default;
+
+    // Frame this node would start sending at nowNs (false → nothing to send)
+    virtual bool pendingFrame(uint64_t nowNs, CANMessage& frame) = 0;
+
+    // Next time the node needs to run on its own (UINT64_MAX → never)
+    virtual uint64_t nextEventTime() const { return UINT64_MAX; }
+
+    // Called every time the bus clock reaches a new instant
+    virtual void wake(uint64_t /*nowNs*/) {}
+
+    // The pending frame went through (endNs = end of frame)
+    virtual void frameSent(const CANMessage& /*frame*/, uint64_t /*endNs*/) {}
+    virtual void frameReceived(const CANMessage& /*frame*/, uint64_t /*endNs*/) {}
+    virtual void arbitrationLost(const CANMessage& /*frame*/, uint8_t /*bitPosition*/) {}
+
+    // Error frame on the bus; transmitter → it was this node's frame
+    virtual void busError(bool /*transmitter*/, bool /*ackError*/) {}
+
+    // Takes part in the bus (acknowledges and receives); false when off
+    // the bus, in reset or listen-only
+    virtual bool isActive() const { return true; }
+    virtual bool acknowledges() const { return isActive(); }
+    // false for self-test transmissions, which need no acknowledge
+    virtual bool needsAck() const { return true; }
+    // Bit rate the node is configured for (0 → whatever the bus runs at)
+    virtual uint32_t bitRate() const { return 0; }
+};
+
+class HostCANBus {
+public:
+    explicit HostCANBus(uint32_t bitRate = 1'000'000UL);
+    ~HostCANBus();
+
+    HostCANBus(const HostCANBus&) = delete;
+    HostCANBus& operator=(const HostCANBus&) = delete;
+
+    void attach(HostCANNode& node);
+    void detach(HostCANNode& node);
+
+    uint32_t getBitRate() const;
+    uint64_t now() const;                     // ns of virtual time
+    uint64_t bitTime(uint32_t bits) const;    // ns for that many bits
+
+    // Advance virtual time; frames that start before endNs run to completion
+    void runUntil(uint64_t endNs);
+    void runFor(uint64_t durationNs);
+    // Run until no node has anything to send or schedule and no esp_timer
+    // is armed (bounded by maxNs)
+    bool runUntilIdle(uint64_t maxNs = 1'000'000'000ULL);
+
+    // Frame timing
+    static uint32_t frameBits(const CANMessage& frame);  // incl. stuffing and intermission
+    uint64_t frameDuration(const CANMessage& frame) const;
+
+    // Error injection
+    void injectErrors(uint32_t count);
+    void setErrorRate(double probability, uint32_t seed = 1);
+
+    // Statistics
+    uint64_t getFrameCount() const;        // frames delivered
+    uint64_t getErrorFrameCount() const;   // error frames (injected and ACK)
+    uint64_t getArbitrationCount() const;  // frames that won against another
+    uint64_t getBusyTime() const;          // ns the bus was not idle
+    float    getBusLoad() const;           // busy time / elapsed, since reset
+    void     resetStatistics();
+
+private:
+    bool  startFrame();
+    bool  sameRate(const HostCANNode& node) const;
+    bool  corruptNext();
+    void  wakeAll();
+    void  advanceTo(uint64_t timeNs);
+    uint64_t nextEvent(uint64_t limitNs) const;   // nodes and esp_timer
+
+    static uint64_t clock(void* bus);
+
+    uint32_t                  bitRate;
+    std::atomic<uint64_t>     time{0};
+    std::vector<HostCANNode*> nodes;
+
+    uint32_t                  errorsToInject = 0;
+    double                    errorRate = 0.0;
+    std::mt19937              random;
+
+    uint64_t                  statsStart = 0;
+    uint64_t                  frames = 0;
+    uint64_t                  errorFrames = 0;
+    uint64_t                  arbitrations = 0;
+    uint64_t                  busyTime = 0;
+};
+
+#endif  // HOST_CAN_BUS_H
@@ -0,0 +1,146 @@
+#include "LoopbackCANTransport.h"
+
+// -------------------------------------------------------------
+// Construction
+// -------------------------------------------------------------
+LoopbackCANTransport::LoopbackCANTransport (HostCANBus &bus,
+                                            uint16_t transmitQueueSize,
+                                            uint16_t receiveQueueSize) :
+    bus (bus),
+    transmitQueueSize (transmitQueueSize),
+    receiveQueueSize (receiveQueueSize) {
+}
+
+LoopbackCANTransport::~LoopbackCANTransport () {
+    bus.detach (*this);
+}
+
+// -------------------------------------------------------------
+// CANTransport
+// -------------------------------------------------------------
+uint32_t LoopbackCANTransport::begin (uint8_t txPin, uint8_t rxPin, uint32_t bitRate,
+                                      const CANFilterPlan &plan) {
+    (void) txPin;   // No pins on the simulated bus
+    (void) rxPin;
+    running = false;
+    bus.detach (*this);
+
+    hasCurrent = false;
+    bool ok = receiveQueue.initWithSize (receiveQueueSize);
+    for (ACAN_ESP32_Buffer16 &queue : transmitQueues) {
+        ok = queue.initWithSize (transmitQueueSize) && ok;
+    }
+    if (!ok) {
+        return kCannotAllocateQueues;
+    }
+    filter = plan;
+    rate   = bitRate;
+
+    bus.attach (*this);
+    running = true;
+    return 0;
+}
+
+bool LoopbackCANTransport::send (const CANMessage &message, CAN_PRIORITY priority) {
+    return running && priority < CAN_PRIORITY_COUNT && transmitQueues[priority].append (message);
+}
+
+uint32_t LoopbackCANTransport::drain (DrainRoutine routine, void *context) {
+    return receiveQueue.consumeAll ([routine, context] (const CANMessage &message) {
+        routine (message, context);
+    });
+}
+
+bool LoopbackCANTransport::subscribe (ACAN_ESP32_Subscription &slot) {
+    if (slot.mIdentifier >= kSubscribableIdCount) {
+        return false;
+    }
+    slots[slot.mIdentifier].store (&slot, std::memory_order_release);
+    return true;
+}
+
+bool LoopbackCANTransport::subscribeTransmit (ACAN_ESP32_Subscription &slot) {
+    if (slot.mIdentifier >= kSubscribableIdCount) {
+        return false;
+    }
+    transmitSlots[slot.mIdentifier].store (&slot, std::memory_order_release);
+    return true;
+}
+
+// The bus delivers frames on the thread that advances it, so nothing can
+// be writing into the slot while we clear it
+void LoopbackCANTransport::unsubscribe (const ACAN_ESP32_Subscription &slot) {
+    if (slot.mIdentifier < kSubscribableIdCount) {
+        ACAN_ESP32_Subscription *expected = const_cast<ACAN_ESP32_Subscription *> (&slot);
+        slots[slot.mIdentifier].compare_exchange_strong (expected, nullptr);
+    }
+}
+
+void LoopbackCANTransport::unsubscribeTransmit (const ACAN_ESP32_Subscription &slot) {
+    if (slot.mIdentifier < kSubscribableIdCount) {
+        ACAN_ESP32_Subscription *expected = const_cast<ACAN_ESP32_Subscription *> (&slot);
+        transmitSlots[slot.mIdentifier].compare_exchange_strong (expected, nullptr);
+    }
+}
+
+// -------------------------------------------------------------
+// HostCANNode
+// -------------------------------------------------------------
+bool LoopbackCANTransport::pendingFrame (uint64_t /*nowNs*/, CANMessage &frame) {
+    for (uint8_t i = 0; i < CAN_PRIORITY_COUNT && !hasCurrent; ++i) {
+        hasCurrent = transmitQueues[i].remove (current);
+    }
+    frame = current;
+    return hasCurrent;
+}
+
+void LoopbackCANTransport::frameSent (const CANMessage &frame, uint64_t endNs) {
+    hasCurrent = false;
+    transmitted.fetch_add (1, std::memory_order_relaxed);
+    if (!frame.ext && frame.id < kSubscribableIdCount) {
+        ACAN_ESP32_Subscription *slot = transmitSlots[frame.id].load (std::memory_order_acquire);
+        if (slot != nullptr) {
+            CANMessage delivered = frame;
+            delivered.timestamp = uint32_t (endNs / 1000);
+            slot->publish (delivered);
+        }
+    }
+}
+
+void LoopbackCANTransport::frameReceived (const CANMessage &frame, uint64_t endNs) {
+    // Same rule as the TWAI filter programmed by ESP32CANTransport:
+    // standard data frames whose ID the plan accepts
+    if (!filter.acceptAll && (frame.ext || frame.rtr || !filter.accepts (frame.id))) {
+        filtered.fetch_add (1, std::memory_order_relaxed);
+        return;
+    }
+    CANMessage message = frame;
+    message.timestamp = uint32_t (endNs / 1000);
+    received.fetch_add (1, std::memory_order_relaxed);
+
+    ACAN_ESP32_Subscription *slot = nullptr;
+    if (!message.ext && message.id < kSubscribableIdCount) {
+        slot = slots[message.id].load (std::memory_order_acquire);
+    }
+    if (slot != nullptr) {
+        slot->publish (message);
+    } else if (!receiveQueue.append (message)) {
+        overruns.fetch_add (1, std::memory_order_relaxed);
+    }
+}
+
+bool LoopbackCANTransport::isActive () const {
+    return running;
+}
+
+uint32_t LoopbackCANTransport::bitRate () const {
+    return rate;
+}
+
+// -------------------------------------------------------------
+// Statistics
+// -------------------------------------------------------------
+uint32_t LoopbackCANTransport::getTransmittedFrameCount () const { return transmitted; }
+uint32_t LoopbackCANTransport::getReceivedFrameCount () const    { return received; }
+uint32_t LoopbackCANTransport::getFilteredFrameCount () const    { return filtered; }
+uint32_t LoopbackCANTransport::getReceiveOverrunCount () const   { return overruns; }
@@ -0,0 +1,85 @@
+#ifndef LOOPBACK_CAN_TRANSPORT_H
+#define LOOPBACK_CAN_TRANSPORT_H
+
+#include <atomic>
+#include <ACAN_ESP32_Buffer16.h>
+#include "CANTransport.h"
+#include "HostCANBus.h"
+
+/*
+ * LoopbackCANTransport — CANTransport on an in-process HostCANBus
+ * ---------------------------------------------------------------
+ * ‣ An ideal controller: no registers, no interrupt latency, just a
+ *   transmit queue, the acceptance filter and a receive queue. Use it when
+ *   the ACAN_ESP32 emulation (ESP32CANTransport on ACAN_ESP32_EmulatedTWAI)
+ *   is more detail than a test needs.
+ * ‣ Frames are timed, arbitrated and acknowledged by the bus like any
+ *   other node's; RX timestamps and transmit completion times are the
+ *   virtual end-of-frame time (µs).
+ * ‣ One transmit queue per CAN_PRIORITY class; the bus takes the oldest
+ *   frame of the highest non-empty class.
+ * ‣ The transmit queues are filled by the caller and emptied by the bus,
+ *   the receive queue the other way round (single producer / single
+ *   consumer each), so the bus may run on its own thread.
+ * ‣ begin() attaches the node to the bus; bitRate is the node's own rate,
+ *   a mismatch with the bus ends in error frames as on real hardware.
+ */
+
+class LoopbackCANTransport : public CANTransport, public HostCANNode {
+public:
+    static const uint32_t kCannotAllocateQueues = 1UL << 20;
+    static const uint16_t kSubscribableIdCount  = 32;
+
+    explicit LoopbackCANTransport(HostCANBus& bus,
+                                  uint16_t transmitQueueSize = 16,
+                                  uint16_t receiveQueueSize  = 32);
+    ~LoopbackCANTransport() override;
+
+    LoopbackCANTransport(const LoopbackCANTransport&) = delete;
+    LoopbackCANTransport& operator=(const LoopbackCANTransport&) = delete;
+
+    // CANTransport
+    uint32_t begin(uint8_t txPin, uint8_t rxPin, uint32_t bitRate,
+                   const CANFilterPlan& filter) override;
+    bool     send(const CANMessage& message,
+                  CAN_PRIORITY priority = CAN_PRIORITY_NORMAL) override;
+    uint32_t drain(DrainRoutine routine, void* context) override;
+    bool     subscribe(ACAN_ESP32_Subscription& slot) override;
+    bool     subscribeTransmit(ACAN_ESP32_Subscription& slot) override;
+    void     unsubscribe(const ACAN_ESP32_Subscription& slot) override;
+    void     unsubscribeTransmit(const ACAN_ESP32_Subscription& slot) override;
+
+    // HostCANNode
+    bool     pendingFrame(uint64_t nowNs, CANMessage& frame) override;
+    void     frameSent(const CANMessage& frame, uint64_t endNs) override;
+    void     frameReceived(const CANMessage& frame, uint64_t endNs) override;
+    bool     isActive() const override;
+    uint32_t bitRate() const override;
+
+    // Statistics
+    uint32_t getTransmittedFrameCount() const;
+    uint32_t getReceivedFrameCount() const;   // accepted by the filter
+    uint32_t getFilteredFrameCount() const;   // rejected by the filter
+    uint32_t getReceiveOverrunCount() const;  // lost, receive queue full
+
+private:
+    HostCANBus&           bus;
+    uint16_t              transmitQueueSize;
+    uint16_t              receiveQueueSize;
+    ACAN_ESP32_Buffer16   transmitQueues[CAN_PRIORITY_COUNT];
+    ACAN_ESP32_Buffer16   receiveQueue;
+    CANMessage            current;                 // frame on its way to the bus
+    bool                  hasCurrent = false;
+    CANFilterPlan         filter;
+    uint32_t              rate = 0;
+    std::atomic<bool>     running{false};
+    std::atomic<ACAN_ESP32_Subscription*> slots[kSubscribableIdCount] = {};
+    std::atomic<ACAN_ESP32_Subscription*> transmitSlots[kSubscribableIdCount] = {};
+
+    std::atomic<uint32_t> transmitted{0};
+    std::atomic<uint32_t> received{0};
+    std::atomic<uint32_t> filtered{0};
+    std::atomic<uint32_t> overruns{0};
+};
+
+#endif  // LOOPBACK_CAN_TRANSPORT_H
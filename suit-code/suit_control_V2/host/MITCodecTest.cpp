@@ -0,0 +1,146 @@
+/*
+ * MITCodecTest — MITCodec against the original Motor conversions
+ *
+ * The oracle is the double-precision floatToUInt / uintToFloat that Motor
+ * used before MITCodec (copied unchanged below). For every field of
+ * AKMotorCodec the test checks:
+ *   ‣ decode() of every code (all 4096 or 65536) against uintToFloat,
+ *   ‣ the round trip encode (decode (code)) against the oracle's round
+ *     trip for every code (both truncate, so a code may come back one
+ *     lower, never further off),
+ *   ‣ encode() against floatToUInt for the floats around every code
+ *     boundary (where truncation decides), and for random in-range floats,
+ *   ‣ with "full": encode() for every float in the field's range.
+ * It exits with status 1 if any field has a mismatch. The two are timed
+ * on the ESP32 (MITCodecBenchmark.h), not here: x86 has double-precision
+ * hardware, which the ESP32 lacks, so a host timing says nothing about
+ * the target.
+ *
+ * Build from suit_control_V2/:
+ *   g++ -std=gnu++17 -O2 -I. host/MITCodecTest.cpp -o mit_codec_test
+ *
+ * Usage: mit_codec_test [full]
+ *   full also encodes every float in each range (about 9·10⁹, minutes).
+ */
+
+#include <random>
+#include <stdio.h>
+#include <string.h>
+#include "MITCodec.h"
+
+// -------------------------------------------------------------
+// Oracle: Motor::floatToUInt / Motor::uintToFloat before MITCodec
+// -------------------------------------------------------------
+static int floatToUInt (float x, float x_min, float x_max, unsigned int bits) {
+    float span = x_max - x_min;
+    float offset = x_min;
+    unsigned int result = 0;
+
+    if (bits == 12) {
+        result = static_cast<unsigned int>((x - offset) * 4095.0 / span);
+    }
+    else if (bits == 16) {
+        result = static_cast<unsigned int>((x - offset) * 65535.0 / span);
+    }
+    return result;
+}
+
+static float uintToFloat (int x_int, float x_min, float x_max, int bits) {
+    float span = x_max - x_min;
+    float offset = x_min;
+    float result = 0.0;
+
+    if (bits == 12) {
+        result = static_cast<float>(x_int) * span / 4095.0 + offset;
+    }
+    else if (bits == 16) {
+        result = static_cast<float>(x_int) * span / 65535.0 + offset;
+    }
+    return result;
+}
+
+// -------------------------------------------------------------
+// One field
+// -------------------------------------------------------------
+template <class Field>
+static uint64_t checkField (const char *name, unsigned bits, bool full) {
+    const float low  = Field::kLow;
+    const float high = Field::kHigh;
+    uint64_t mismatches = 0;
+    uint64_t checked = 0;
+
+    auto checkEncode = [&] (float x) {
+        if (x < low || x > high) {
+            return;
+        }
+        ++checked;
+        const uint32_t expected = uint32_t (floatToUInt (x, low, high, bits));
+        const uint32_t actual   = Field::encode (x);
+        if (actual != expected) {
+            if (mismatches < 5) {
+                printf ("  %s: encode(%.9g) = %u, expected %u\n", name, x, actual, expected);
+            }
+            ++mismatches;
+        }
+    };
+
+    for (uint32_t code = 0; code <= Field::kMaxCode; ++code) {
+        const float expected = uintToFloat (int (code), low, high, int (bits));
+        const float actual   = Field::decode (code);
+        if (memcmp (&expected, &actual, sizeof (float)) != 0) {
+            if (mismatches < 5) {
+                printf ("  %s: decode(%u) = %.9g, expected %.9g\n", name, code, actual, expected);
+            }
+            ++mismatches;
+        }
+        const uint32_t oracleTrip = uint32_t (floatToUInt (expected, low, high, bits));
+        const uint32_t roundTrip  = Field::encode (actual);
+        if (roundTrip != oracleTrip || roundTrip > code || code - roundTrip > 1) {
+            if (mismatches < 5) {
+                printf ("  %s: encode(decode(%u)) = %u, expected %u\n", name, code, roundTrip, oracleTrip);
+            }
+            ++mismatches;
+        }
+        // 64 floats either side of the exact boundary value
+        float x = float (double (code) * (double (high) - double (low)) / Field::kMaxCode + low);
+        for (int i = 0; i < 64; ++i) {
+            x = nextafterf (x, -INFINITY);
+        }
+        for (int i = 0; i < 129; ++i) {
+            checkEncode (x);
+            x = nextafterf (x, INFINITY);
+        }
+    }
+
+    std::mt19937 random (bits * 7919u + Field::kMaxCode);
+    std::uniform_real_distribution<float> inRange (low, high);
+    for (int i = 0; i < 20000000; ++i) {
+        checkEncode (inRange (random));
+    }
+
+    if (full) {
+        for (float x = low; x <= high; x = nextafterf (x, INFINITY)) {
+            checkEncode (x);
+        }
+    }
+
+    printf ("%-8s %2u bits [%g, %g]: %llu floats encoded, %llu mismatches\n", name, bits, low, high,
+            (unsigned long long) checked, (unsigned long long) mismatches);
+    return mismatches;
+}
+
+int main (int argc, char *argv[]) {
+    const bool full = (argc > 1) && strcmp (argv[1], "full") == 0;
+    uint64_t mismatches = 0;
+    mismatches += checkField<AKMotorCodec::PositionField> ("position", 16, full);
+    mismatches += checkField<AKMotorCodec::VelocityField> ("velocity", 12, full);
+    mismatches += checkField<AKMotorCodec::KpField>       ("kp",       12, full);
+    mismatches += checkField<AKMotorCodec::KdField>       ("kd",       12, full);
+    mismatches += checkField<AKMotorCodec::TorqueField>   ("torque",   12, full);
+    if (mismatches > 0) {
+        printf ("FAILED: %llu mismatches\n", (unsigned long long) mismatches);
+        return 1;
+    }
+    printf ("OK\n");
+    return 0;
+}
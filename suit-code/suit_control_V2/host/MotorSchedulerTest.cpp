@@ -0,0 +1,253 @@
+/*
+ * MotorSchedulerTest — a scheduled joint next to free-running ones
+ *
+ * Runs MotorScheduler on the emulated TWAI controller (ESP32CANTransport,
+ * the full driver path) with three simulated AK motors: motor 1 in a
+ * schedule slot, motor 2 sent by its own Motor::update() and motor 3 by a
+ * MotorGroup. The transport is wrapped so every queued frame is counted by
+ * ID and priority class.
+ * ‣ While the schedule runs it holds CAN_PRIORITY_CONTROL: only motor 1's
+ *   frames are queued in the control class, motors 2 and 3 go in the
+ *   normal class, and a second scheduler on the same CANHandler cannot
+ *   begin().
+ * ‣ Every command each motor queued reaches its simulated motor, and the
+ *   last one on the bus for each ID is its latest command.
+ * ‣ After end(), motors 2 and 3 are back in the control class and the
+ *   second scheduler can begin().
+ * ‣ A slot boundary reached more than three slots late counts the ones in
+ *   between as missed, not fired, so they do not dilute the mean jitter.
+ * Exits with status 1 if any check failed.
+ *
+ * Build from suit_control_V2/:
+ *   g++ -std=gnu++17 -O2 -I. -Ihost host/MotorSchedulerTest.cpp MotorScheduler.cpp \
+ *       CANHandler.cpp ESP32CANTransport.cpp Motor.cpp MotorGroup.cpp RemoteDebug.cpp \
+ *       DeferredLogger.cpp UDPLogTransport.cpp ACAN_ESP32.cpp ACAN_ESP32_Settings.cpp \
+ *       host/HostArduino.cpp host/HostCANBus.cpp host/ACAN_ESP32_HostPlatform.cpp \
+ *       host/ACAN_ESP32_EmulatedTWAI.cpp host/SimulatedAKMotor.cpp -lpthread \
+ *       -o motor_scheduler_test
+ *
+ * Usage: motor_scheduler_test
+ */
+
+#include <Arduino.h>
+#include "CANHandler.h"
+#include "ESP32CANTransport.h"
+#include "Motor.h"
+#include "MotorGroup.h"
+#include "MotorScheduler.h"
+#include "ACAN_ESP32_EmulatedTWAI.h"
+#include "SimulatedAKMotor.h"
+
+static int failures = 0;
+
+#define CHECK(condition) check ((condition), #condition, __LINE__)
+
+static void check (bool condition, const char *text, int line) {
+    if (!condition) {
+        printf ("FAILED line %d: %s\n", line, text);
+        ++failures;
+    }
+}
+
+// -------------------------------------------------------------
+// ESP32CANTransport, counting the frames queued per ID and class
+// -------------------------------------------------------------
+class CountingTransport : public CANTransport {
+public:
+    static const uint8_t IDS = 4;
+
+    explicit CountingTransport (CANTransport &inner) : inner (inner) {}
+
+    uint32_t begin (uint8_t txPin, uint8_t rxPin, uint32_t bitRate,
+                    const CANFilterPlan &filter) override {
+        return inner.begin (txPin, rxPin, bitRate, filter);
+    }
+    bool send (const CANMessage &message, CAN_PRIORITY priority) override {
+        const bool accepted = inner.send (message, priority);
+        if (accepted) {
+            count (message, priority);
+        }
+        return accepted;
+    }
+    uint32_t sendBurst (const CANMessage messages[], uint32_t n, CAN_PRIORITY priority) override {
+        const uint32_t accepted = inner.sendBurst (messages, n, priority);
+        for (uint32_t i = 0; i < accepted; ++i) {
+            count (messages[i], priority);
+        }
+        return accepted;
+    }
+    uint32_t drain (DrainRoutine routine, void *context) override { return inner.drain (routine, context); }
+    bool subscribe (ACAN_ESP32_Subscription &slot) override { return inner.subscribe (slot); }
+    bool subscribeTransmit (ACAN_ESP32_Subscription &slot) override { return inner.subscribeTransmit (slot); }
+    void unsubscribe (const ACAN_ESP32_Subscription &slot) override { inner.unsubscribe (slot); }
+    void unsubscribeTransmit (const ACAN_ESP32_Subscription &slot) override { inner.unsubscribeTransmit (slot); }
+
+    uint32_t frames[IDS][CAN_PRIORITY_COUNT] = {};
+
+private:
+    void count (const CANMessage &message, CAN_PRIORITY priority) {
+        if (message.id < IDS) {
+            ++frames[message.id][priority];
+        }
+    }
+
+    CANTransport &inner;
+};
+
+// -------------------------------------------------------------
+// Listens on the bus: the last frame seen per ID
+// -------------------------------------------------------------
+class Tap : public HostCANNode {
+public:
+    bool pendingFrame (uint64_t, CANMessage &) override { return false; }
+    uint64_t nextEventTime () const override { return UINT64_MAX; }
+    void frameSent (const CANMessage &, uint64_t) override {}
+    void frameReceived (const CANMessage &frame, uint64_t) override {
+        if (!frame.ext && frame.id < CountingTransport::IDS) {
+            last[frame.id] = frame;
+        }
+    }
+
+    CANMessage last[CountingTransport::IDS];
+};
+
+// Torque for motor m in cycle n: a step of several N·m every cycle, so
+// every due command is a new one
+static float torqueFor (uint8_t m, uint32_t n) {
+    return float ((7 * n + 3 * m) % 20) - 10.0f;
+}
+
+int main () {
+    HostCANBus bus;
+    SimulatedAKMotor plant1 (1), plant2 (2), plant3 (3);
+    // Replies on other IDs, so the tap only sees commands on 1 … 3
+    uint16_t replyId = 0x11;
+    for (SimulatedAKMotor *plant : { &plant1, &plant2, &plant3 }) {
+        plant->setReplyLatency (50000);
+        plant->setReplyId (replyId++);
+        bus.attach (*plant);
+    }
+    Tap tap;
+    bus.attach (tap);
+    ACAN_ESP32_EmulatedTWAI twai (bus);
+    CountingTransport transport (ESP32CANTransport::instance ());
+
+    CANHandler canHandler (transport);
+    Motor scheduled (1, canHandler, Debug);
+    Motor freeRunning (2, canHandler, Debug);
+    Motor grouped (3, canHandler, Debug);
+    canHandler.setupCAN ();
+    for (Motor *motor : { &scheduled, &freeRunning, &grouped }) {
+        motor->start ();
+    }
+    bus.runFor (2'000'000ULL);
+
+    MotorGroup group (canHandler);
+    group.add (grouped);
+    MotorScheduler schedule (canHandler);
+    CHECK (schedule.configure (1000, 2));
+    CHECK (schedule.assign (0, scheduled));
+
+    // A second schedule for the same bus; only one may own the control class
+    Motor spare (4, canHandler, Debug);
+    MotorScheduler second (canHandler);
+    CHECK (second.assign (0, spare));
+
+    CHECK (canHandler.commandPriority () == CAN_PRIORITY_CONTROL);
+    CHECK (schedule.begin ());
+    CHECK (canHandler.commandPriority () == CAN_PRIORITY_NORMAL);
+    CHECK (!second.begin ());
+
+    // -------------------------------------------------------------
+    // Scheduled and free-running side by side, 1 ms loop
+    // -------------------------------------------------------------
+    const uint32_t CYCLES = 2000;
+    float last[3] = {};
+    for (uint32_t n = 0; n < CYCLES; ++n) {
+        for (uint8_t m = 0; m < 3; ++m) {
+            last[m] = torqueFor (m, n);
+        }
+        schedule.sendTorques (&last[0]);
+        freeRunning.sendCommand (0.0f, 0.0f, 0.0f, 0.0f, last[1]);
+        group.sendTorques (&last[2]);
+
+        bus.runFor (1'000'000ULL);
+        canHandler.update ();
+        schedule.update ();
+        freeRunning.update ();
+        group.update ();
+    }
+    bus.runFor (5'000'000ULL);
+
+    MotorScheduler::SlotStatistics slot;
+    CHECK (schedule.getSlotStatistics (0, slot));
+    const uint32_t (&frames)[CountingTransport::IDS][CAN_PRIORITY_COUNT] = transport.frames;
+    printf ("motor 1 (scheduled)   : %lu control, %lu normal frames\n",
+            (unsigned long) frames[1][CAN_PRIORITY_CONTROL], (unsigned long) frames[1][CAN_PRIORITY_NORMAL]);
+    printf ("motor 2 (update)      : %lu control, %lu normal frames\n",
+            (unsigned long) frames[2][CAN_PRIORITY_CONTROL], (unsigned long) frames[2][CAN_PRIORITY_NORMAL]);
+    printf ("motor 3 (MotorGroup)  : %lu control, %lu normal frames\n",
+            (unsigned long) frames[3][CAN_PRIORITY_CONTROL], (unsigned long) frames[3][CAN_PRIORITY_NORMAL]);
+
+    CHECK (frames[1][CAN_PRIORITY_CONTROL] == slot.sent);
+    CHECK (slot.sent >= CYCLES - 1);
+    CHECK (slot.missed == 0);
+    CHECK (frames[1][CAN_PRIORITY_NORMAL] == 0);
+    CHECK (frames[2][CAN_PRIORITY_CONTROL] == 0);
+    CHECK (frames[3][CAN_PRIORITY_CONTROL] == 0);
+    CHECK (frames[2][CAN_PRIORITY_NORMAL] == freeRunning.getFramesSent ());
+    CHECK (frames[3][CAN_PRIORITY_NORMAL] == grouped.getFramesSent ());
+    CHECK (freeRunning.getFramesSent () >= CYCLES);
+    CHECK (grouped.getFramesSent () >= CYCLES);
+
+    // Nothing lost or mixed up on the way
+    CHECK (plant1.getCommandCount () == slot.sent);
+    CHECK (plant2.getCommandCount () == freeRunning.getFramesSent ());
+    CHECK (plant3.getCommandCount () == grouped.getFramesSent ());
+    CHECK (scheduled.getCommandsDelivered () == plant1.getCommandCount () + plant1.getSpecialCommandCount ());
+    CHECK (freeRunning.getCommandsDelivered () == plant2.getCommandCount () + plant2.getSpecialCommandCount ());
+    CHECK (tap.last[1].data64 == scheduled.getCommandFrame ().data64);
+    CHECK (tap.last[2].data64 == freeRunning.getCommandFrame ().data64);
+    CHECK (tap.last[3].data64 == grouped.getCommandFrame ().data64);
+
+    // -------------------------------------------------------------
+    // Schedule stopped: the control class is free again
+    // -------------------------------------------------------------
+    schedule.end ();
+    CHECK (canHandler.commandPriority () == CAN_PRIORITY_CONTROL);
+    for (uint32_t n = CYCLES; n < CYCLES + 10; ++n) {
+        freeRunning.sendCommand (0.0f, 0.0f, 0.0f, 0.0f, torqueFor (1, n));
+        const float torque = torqueFor (2, n);
+        group.sendTorques (&torque);
+        bus.runFor (1'000'000ULL);
+        canHandler.update ();
+        freeRunning.update ();
+        group.update ();
+    }
+    CHECK (frames[2][CAN_PRIORITY_CONTROL] == 10);
+    CHECK (frames[3][CAN_PRIORITY_CONTROL] == 10);
+
+    // A timer more than three slots late: the boundaries it passed are
+    // missed, not fired, and the mean jitter is that of the one it fired at
+    schedule.resetStatistics ();
+    bus.runFor (1'700'000ULL);
+    schedule.tick ();
+    MotorScheduler::SlotStatistics slots[2];
+    CHECK (schedule.getSlotStatistics (0, slots[0]) && schedule.getSlotStatistics (1, slots[1]));
+    CHECK (slots[0].fired + slots[1].fired == 1);
+    CHECK (slots[0].missed + slots[1].missed >= 3);
+    CHECK (slots[0].overruns + slots[1].overruns == slots[0].missed + slots[1].missed);
+    for (const MotorScheduler::SlotStatistics &late : slots) {
+        CHECK (late.meanJitter == late.lastJitter);
+        CHECK (late.lastJitter < schedule.getSlotLength ());
+    }
+    CHECK (second.begin ());
+    second.end ();
+
+    if (failures != 0) {
+        printf ("%d checks failed\n", failures);
+        return 1;
+    }
+    printf ("OK\n");
+    return 0;
+}
@@ -0,0 +1,106 @@
+#include "ReplayCANNode.h"
+
+// -------------------------------------------------------------
+// Construction
+// -------------------------------------------------------------
+ReplayCANNode::ReplayCANNode (const std::vector<CANFlightRecord> &records) :
+    records (records) {
+    offsets.reserve (records.size ());
+    uint64_t offset = 0;
+    for (size_t i = 0; i < records.size (); ++i) {
+        if (i > 0) {
+            // 32-bit µs difference: correct across the wrap
+            offset += uint32_t (records[i].timestamp - records[i - 1].timestamp);
+        }
+        offsets.push_back (offset);
+    }
+}
+
+void ReplayCANNode::setDirections (bool received, bool transmitted) {
+    playReceived    = received;
+    playTransmitted = transmitted;
+}
+
+void ReplayCANNode::start (uint64_t nowNs, double replaySpeed) {
+    startNs       = nowNs;
+    speed         = (replaySpeed > 0.0) ? replaySpeed : 0.0;
+    next          = 0;
+    sent          = 0;
+    maxLateness   = 0;
+    totalLateness = 0;
+    started       = true;
+    skipFiltered ();
+}
+
+// -------------------------------------------------------------
+// Schedule
+// -------------------------------------------------------------
+void ReplayCANNode::skipFiltered () {
+    while (next < records.size ()) {
+        const bool transmitted = (records[next].id & CAN_RECORD_TX_FLAG) != 0;
+        if (transmitted ? playTransmitted : playReceived) {
+            break;
+        }
+        ++next;
+    }
+}
+
+uint64_t ReplayCANNode::dueTime (size_t index) const {
+    if (speed == 0.0) {
+        return startNs;
+    }
+    return startNs + uint64_t (double (offsets[index]) * 1000.0 / speed);
+}
+
+bool ReplayCANNode::pendingFrame (uint64_t nowNs, CANMessage &frame) {
+    if (!started || next >= records.size () || dueTime (next) > nowNs) {
+        return false;
+    }
+    CANFlightRecorder::toMessage (records[next], frame);
+    return true;
+}
+
+uint64_t ReplayCANNode::nextEventTime () const {
+    return (started && next < records.size ()) ? dueTime (next) : UINT64_MAX;
+}
+
+void ReplayCANNode::frameSent (const CANMessage &frame, uint64_t endNs) {
+    (void) frame;
+    const uint64_t due      = dueTime (next);
+    const uint64_t lateness = (endNs > due) ? endNs - due : 0;
+    if (lateness > maxLateness) {
+        maxLateness = lateness;
+    }
+    totalLateness += lateness;
+    ++sent;
+    ++next;
+    skipFiltered ();
+}
+
+// -------------------------------------------------------------
+// Statistics
+// -------------------------------------------------------------
+bool ReplayCANNode::isFinished () const {
+    return started && next >= records.size ();
+}
+
+uint32_t ReplayCANNode::getSentCount () const {
+    return sent;
+}
+
+uint32_t ReplayCANNode::getScheduledCount () const {
+    uint32_t count = 0;
+    for (const CANFlightRecord &record : records) {
+        const bool transmitted = (record.id & CAN_RECORD_TX_FLAG) != 0;
+        count += (transmitted ? playTransmitted : playReceived) ? 1 : 0;
+    }
+    return count;
+}
+
+uint64_t ReplayCANNode::getMaxLateness () const {
+    return maxLateness;
+}
+
+uint64_t ReplayCANNode::getMeanLateness () const {
+    return (sent > 0) ? totalLateness / sent : 0;
+}
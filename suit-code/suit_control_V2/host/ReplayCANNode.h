@@ -0,0 +1,61 @@
+#ifndef REPLAY_CAN_NODE_H
+#define REPLAY_CAN_NODE_H
+
+#include <stdint.h>
+#include <vector>
+#include "HostCANBus.h"
+#include "CANFlightRecorder.h"
+
+/*
+ * ReplayCANNode — plays CANFlightRecorder records back onto a HostCANBus
+ * ----------------------------------------------------------------------
+ * ‣ Each record is offered to the bus at its recorded time relative to the
+ *   first one, divided by the speed (2 → twice as fast, 0 → back to back),
+ *   counted from start(). Timestamps are unwrapped, so a recording may span
+ *   the 32-bit µs wrap.
+ * ‣ Records are sent in order; a frame that loses arbitration or hits an
+ *   error is retried, and later frames wait for it, as on the real bus.
+ * ‣ setDirections() picks which records are played: received frames, our
+ *   own transmitted frames, or both (the default, i.e. the whole bus as
+ *   this node saw it).
+ * ‣ Lateness is the end of each replayed frame minus its scheduled time;
+ *   for frames that never had to wait it is their length on the bus.
+ */
+
+class ReplayCANNode : public HostCANNode {
+public:
+    explicit ReplayCANNode(const std::vector<CANFlightRecord>& records);
+
+    void setDirections(bool received, bool transmitted);
+    void start(uint64_t nowNs, double speed = 1.0);
+
+    bool     isFinished() const;
+    uint32_t getSentCount() const;
+    uint32_t getScheduledCount() const;
+    uint64_t getMaxLateness() const;      // ns
+    uint64_t getMeanLateness() const;     // ns
+
+    // HostCANNode
+    bool     pendingFrame(uint64_t nowNs, CANMessage& frame) override;
+    uint64_t nextEventTime() const override;
+    void     frameSent(const CANMessage& frame, uint64_t endNs) override;
+
+private:
+    void     skipFiltered();
+    uint64_t dueTime(size_t index) const;
+
+    std::vector<CANFlightRecord> records;
+    std::vector<uint64_t>        offsets;   // µs since the first record
+    bool     playReceived = true;
+    bool     playTransmitted = true;
+    bool     started = false;
+    uint64_t startNs = 0;
+    double   speed = 1.0;
+    size_t   next = 0;
+
+    uint32_t sent = 0;
+    uint64_t maxLateness = 0;
+    uint64_t totalLateness = 0;
+};
+
+#endif  // REPLAY_CAN_NODE_H
@@ -0,0 +1,145 @@
+#include "SimulatedAKMotor.h"
+
+// Special commands: seven 0xFF bytes followed by one of these
+static const uint8_t ENTER_MOTOR_MODE = 0xFC;
+static const uint8_t EXIT_MOTOR_MODE  = 0xFD;
+static const uint8_t SET_ZERO         = 0xFE;
+
+// -------------------------------------------------------------
+// Construction and configuration
+// -------------------------------------------------------------
+SimulatedAKMotor::SimulatedAKMotor (uint16_t canId) :
+    canId (canId), replyId (canId), random (1) {
+}
+
+void SimulatedAKMotor::setReplyId (uint16_t id)      { replyId = id; }
+void SimulatedAKMotor::setInertia (float kgm2)       { inertia = kgm2; }
+void SimulatedAKMotor::setDamping (float nmsPerRad)  { damping = nmsPerRad; }
+void SimulatedAKMotor::setTorqueLimit (float nm)     { torqueLimit = nm; }
+
+void SimulatedAKMotor::setUpdateRate (uint32_t hz) {
+    stepNs = (hz > 0) ? 1'000'000'000ULL / hz : 100'000;
+}
+
+void SimulatedAKMotor::setReplyLatency (uint64_t latencyNs, uint64_t jitterNs, uint32_t seed) {
+    latency = latencyNs;
+    jitter  = jitterNs;
+    random.seed (seed);
+}
+
+void SimulatedAKMotor::setState (float newPosition, float newVelocity) {
+    position = newPosition + zeroOffset;
+    velocity = newVelocity;
+}
+
+// -------------------------------------------------------------
+// Plant: fixed-step semi-implicit Euler up to timeNs
+// -------------------------------------------------------------
+void SimulatedAKMotor::advanceTo (uint64_t timeNs) {
+    if (!enabled && velocity == 0.0f) {
+        // At rest with no torque: skip ahead, staying on the step grid
+        if (timeNs > simTime) {
+            simTime = timeNs - (timeNs - simTime) % stepNs;
+        }
+        return;
+    }
+    const float dt = float (stepNs) * 1e-9f;
+    while (simTime + stepNs <= timeNs) {
+        float t = 0.0f;
+        if (enabled) {
+            t = kp * (pDes - (position - zeroOffset)) + kd * (vDes - velocity) + tFf;
+            t = (t > torqueLimit) ? torqueLimit : ((t < -torqueLimit) ? -torqueLimit : t);
+        }
+        torque    = t;
+        velocity += (t - damping * velocity) / inertia * dt;
+        position += velocity * dt;
+        simTime  += stepNs;
+    }
+}
+
+// -------------------------------------------------------------
+// Commands
+// -------------------------------------------------------------
+void SimulatedAKMotor::frameReceived (const CANMessage &frame, uint64_t endNs) {
+    if (frame.ext || frame.rtr || frame.id != canId || frame.len < 8) {
+        return;
+    }
+    advanceTo (endNs);
+
+    bool special = true;
+    for (uint8_t i = 0; i < 7; ++i) {
+        special = special && (frame.data[i] == 0xFF);
+    }
+    const uint8_t code = frame.data[7];
+    if (special && (code == ENTER_MOTOR_MODE || code == EXIT_MOTOR_MODE || code == SET_ZERO)) {
+        ++specialCommands;
+        if (code == ENTER_MOTOR_MODE) {
+            enabled = true;
+        } else if (code == EXIT_MOTOR_MODE) {
+            enabled = false;
+        } else {
+            zeroOffset = position;
+        }
+    } else {
+        ++commands;
+        Codec::unpackCommand (frame.data, pDes, vDes, kp, kd, tFf);
+    }
+    scheduleReply (endNs);
+}
+
+void SimulatedAKMotor::scheduleReply (uint64_t timeNs) {
+    if (replyCount >= MAX_PENDING_REPLIES) {
+        ++droppedReplies;
+        return;
+    }
+    uint64_t due = timeNs + latency;
+    if (jitter > 0) {
+        due += std::uniform_int_distribution<uint64_t> (0, jitter) (random);
+    }
+    // Never overtake an earlier reply
+    if (replyCount > 0) {
+        const uint64_t last = replyTimes[(replyHead + replyCount - 1) % MAX_PENDING_REPLIES];
+        due = (due < last) ? last : due;
+    }
+    replyTimes[(replyHead + replyCount) % MAX_PENDING_REPLIES] = due;
+    ++replyCount;
+}
+
+// -------------------------------------------------------------
+// Feedback
+// -------------------------------------------------------------
+bool SimulatedAKMotor::pendingFrame (uint64_t nowNs, CANMessage &frame) {
+    if (replyCount == 0 || replyTimes[replyHead] > nowNs) {
+        return false;
+    }
+    advanceTo (nowNs);
+    frame.id  = replyId;
+    frame.ext = false;
+    frame.rtr = false;
+    frame.len = 8;
+    Codec::packFeedback (frame.data, position - zeroOffset, velocity, torque);
+    return true;
+}
+
+uint64_t SimulatedAKMotor::nextEventTime () const {
+    return (replyCount > 0) ? replyTimes[replyHead] : UINT64_MAX;
+}
+
+void SimulatedAKMotor::frameSent (const CANMessage &/*frame*/, uint64_t /*endNs*/) {
+    replyHead = (replyHead + 1) % MAX_PENDING_REPLIES;
+    --replyCount;
+    ++replies;
+}
+
+// -------------------------------------------------------------
+// State and statistics
+// -------------------------------------------------------------
+bool  SimulatedAKMotor::isEnabled () const   { return enabled; }
+float SimulatedAKMotor::getPosition () const { return position - zeroOffset; }
+float SimulatedAKMotor::getVelocity () const { return velocity; }
+float SimulatedAKMotor::getTorque () const   { return torque; }
+
+uint32_t SimulatedAKMotor::getCommandCount () const        { return commands; }
+uint32_t SimulatedAKMotor::getSpecialCommandCount () const { return specialCommands; }
+uint32_t SimulatedAKMotor::getReplyCount () const          { return replies; }
+uint32_t SimulatedAKMotor::getDroppedReplyCount () const   { return droppedReplies; }
@@ -0,0 +1,98 @@
+#ifndef SIMULATED_AK_MOTOR_H
+#define SIMULATED_AK_MOTOR_H
+
+#include <stdint.h>
+#include <random>
+#include "HostCANBus.h"
+#include "MITCodec.h"
+
+/*
+ * SimulatedAKMotor — an AK-series actuator in MIT mode, on a HostCANBus
+ * ---------------------------------------------------------------------
+ * ‣ Listens to its CAN ID and understands what Motor sends:
+ *     FF…FF FC → enter motor mode, FF…FF FD → exit, FF…FF FE → set zero,
+ *     any other 8-byte frame → MIT command (p_des, v_des, kp, kd, t_ff),
+ *   decoded with the same AKMotorCodec as Motor.
+ * ‣ The joint is a rigid body: J·dω/dt = τ − b·ω, with
+ *     τ = kp·(p_des − p) + kd·(v_des − ω) + t_ff   (clamped to the torque limit)
+ *   while in motor mode, τ = 0 otherwise. It is integrated at a fixed
+ *   internal rate (default 10 kHz) up to the bus time whenever the node runs.
+ * ‣ Every frame it accepts is answered with a feedback frame (position,
+ *   velocity, torque in the layout Motor::unpackCommand reads) after the
+ *   reply latency plus a uniformly distributed jitter. Replies keep their
+ *   order and carry the state at the moment they go on the bus.
+ * ‣ Replies use the motor's own ID unless setReplyId() says otherwise.
+ */
+
+class SimulatedAKMotor : public HostCANNode {
+public:
+    typedef AKMotorCodec Codec;
+
+    static const uint8_t MAX_PENDING_REPLIES = 8;
+
+    explicit SimulatedAKMotor(uint16_t canId);
+
+    // Configuration
+    void setReplyId(uint16_t id);
+    void setInertia(float kgm2);                 // default 0.01 kg·m²
+    void setDamping(float nmsPerRad);            // default 0.05 N·m·s/rad
+    void setTorqueLimit(float nm);               // default 25 N·m (codec range)
+    void setUpdateRate(uint32_t hz);             // default 10 kHz
+    void setReplyLatency(uint64_t latencyNs, uint64_t jitterNs = 0, uint32_t seed = 1);
+    void setState(float position, float velocity);
+
+    // State
+    bool  isEnabled() const;
+    float getPosition() const;                   // relative to the last zero
+    float getVelocity() const;
+    float getTorque() const;                     // last applied torque
+
+    // Statistics
+    uint32_t getCommandCount() const;            // MIT commands received
+    uint32_t getSpecialCommandCount() const;     // FC / FD / FE
+    uint32_t getReplyCount() const;
+    uint32_t getDroppedReplyCount() const;       // reply queue full
+
+    // HostCANNode
+    bool     pendingFrame(uint64_t nowNs, CANMessage& frame) override;
+    uint64_t nextEventTime() const override;
+    void     frameSent(const CANMessage& frame, uint64_t endNs) override;
+    void     frameReceived(const CANMessage& frame, uint64_t endNs) override;
+
+private:
+    void  advanceTo(uint64_t timeNs);
+    void  scheduleReply(uint64_t timeNs);
+
+    uint16_t canId;
+    uint16_t replyId;
+
+    // Plant
+    float    inertia     = 0.01f;
+    float    damping     = 0.05f;
+    float    torqueLimit = 25.0f;
+    uint64_t stepNs      = 100'000;
+    uint64_t simTime     = 0;
+    float    position    = 0.0f;                 // absolute
+    float    velocity    = 0.0f;
+    float    torque      = 0.0f;
+    float    zeroOffset  = 0.0f;
+    bool     enabled     = false;
+
+    // Last MIT command
+    float    pDes = 0.0f, vDes = 0.0f, kp = 0.0f, kd = 0.0f, tFf = 0.0f;
+
+    // Replies, in order (ring of send times)
+    uint64_t replyTimes[MAX_PENDING_REPLIES];
+    uint8_t  replyHead  = 0;
+    uint8_t  replyCount = 0;
+    uint64_t latency    = 0;
+    uint64_t jitter     = 0;
+    std::mt19937 random;
+
+    uint32_t commands        = 0;
+    uint32_t specialCommands = 0;
+    uint32_t replies         = 0;
+    uint32_t droppedReplies  = 0;
+};
+
+#endif  // SIMULATED_AK_MOTOR_H
@@ -0,0 +1,261 @@
+#ifdef __linux__
+
+#include "SocketCANTransport.h"
+#include <ACAN_ESP32_HostPlatform.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+
+// How often the reader thread checks whether it should stop
+static const int READER_POLL_MS = 20;
+
+// SO_PRIORITY per CAN_PRIORITY class; the default priomap of the prio
+// qdisc puts 6 (interactive) in band 0, 0 (best effort) in band 1 and
+// 2 (bulk) in band 2
+static const int SOCKET_PRIORITY[CAN_PRIORITY_COUNT] = { 6, 0, 2 };
+
+// -------------------------------------------------------------
+// Construction
+// -------------------------------------------------------------
+SocketCANTransport::SocketCANTransport (const char *name, uint16_t receiveQueueSize) :
+    receiveQueueSize (receiveQueueSize) {
+    strncpy (interfaceName, name, sizeof (interfaceName) - 1);
+    interfaceName[sizeof (interfaceName) - 1] = '\0';
+}
+
+SocketCANTransport::~SocketCANTransport () {
+    end ();
+}
+
+// -------------------------------------------------------------
+// Open, filter and bind the socket, start the reader
+// -------------------------------------------------------------
+uint32_t SocketCANTransport::begin (uint8_t txPin, uint8_t rxPin, uint32_t bitRate,
+                                    const CANFilterPlan &plan) {
+    (void) txPin;     // Set on the interface, not here
+    (void) rxPin;
+    (void) bitRate;
+    end ();
+
+    if (!receiveQueue.initWithSize (receiveQueueSize)) {
+        return kCannotAllocateQueue;
+    }
+    socketFd = socket (PF_CAN, SOCK_RAW, CAN_RAW);
+    if (socketFd < 0) {
+        return kCannotOpenSocket;
+    }
+
+    uint32_t errorCode = 0;
+    struct ifreq request;
+    memset (&request, 0, sizeof (request));
+    snprintf (request.ifr_name, IFNAMSIZ, "%s", interfaceName);
+    if (ioctl (socketFd, SIOCGIFINDEX, &request) < 0) {
+        errorCode |= kUnknownInterface;
+    }
+
+    // Standard data frames only, as the TWAI filter in ESP32CANTransport
+    if (errorCode == 0 && !plan.acceptAll) {
+        struct can_filter filters[2];
+        const int count = plan.dual ? 2 : 1;
+        for (int i = 0; i < count; ++i) {
+            filters[i].can_id   = plan.filter[i].code;
+            filters[i].can_mask = (~plan.filter[i].dontCare & CAN_SFF_MASK) |
+                                  CAN_EFF_FLAG | CAN_RTR_FLAG;
+        }
+        if (setsockopt (socketFd, SOL_CAN_RAW, CAN_RAW_FILTER,
+                        filters, count * sizeof (filters[0])) < 0) {
+            errorCode |= kCannotSetFilter;
+        }
+    }
+
+    // Echo our own frames back once sent, for subscribeTransmit()
+    if (errorCode == 0) {
+        const int enable = 1;
+        setsockopt (socketFd, SOL_CAN_RAW, CAN_RAW_RECV_OWN_MSGS, &enable, sizeof (enable));
+    }
+
+    if (errorCode == 0) {
+        struct sockaddr_can address;
+        memset (&address, 0, sizeof (address));
+        address.can_family  = AF_CAN;
+        address.can_ifindex = request.ifr_ifindex;
+        if (bind (socketFd, reinterpret_cast<struct sockaddr *>(&address), sizeof (address)) < 0) {
+            errorCode |= kCannotBind;
+        }
+    }
+
+    if (errorCode != 0) {
+        close (socketFd);
+        socketFd = -1;
+        return errorCode;
+    }
+
+    socketPriority = CAN_PRIORITY_NORMAL;
+    running = true;
+    reader = std::thread (&SocketCANTransport::readLoop, this);
+    return 0;
+}
+
+void SocketCANTransport::end () {
+    running = false;
+    if (reader.joinable ()) {
+        reader.join ();
+    }
+    if (socketFd >= 0) {
+        close (socketFd);
+        socketFd = -1;
+    }
+}
+
+// -------------------------------------------------------------
+// Transmit
+// -------------------------------------------------------------
+bool SocketCANTransport::send (const CANMessage &message, CAN_PRIORITY priority) {
+    if (!running || priority >= CAN_PRIORITY_COUNT) {
+        return false;
+    }
+    if (priority != socketPriority) {
+        setsockopt (socketFd, SOL_SOCKET, SO_PRIORITY,
+                    &SOCKET_PRIORITY[priority], sizeof (SOCKET_PRIORITY[priority]));
+        socketPriority = priority;
+    }
+    struct can_frame frame;
+    memset (&frame, 0, sizeof (frame));
+    frame.can_id = message.ext ? ((message.id & CAN_EFF_MASK) | CAN_EFF_FLAG)
+                               : (message.id & CAN_SFF_MASK);
+    if (message.rtr) {
+        frame.can_id |= CAN_RTR_FLAG;
+    }
+    frame.can_dlc = (message.len > 8) ? 8 : message.len;
+    memcpy (frame.data, message.data, frame.can_dlc);
+
+    const bool ok = ::send (socketFd, &frame, sizeof (frame), MSG_DONTWAIT) == sizeof (frame);
+    (ok ? transmitted : transmitFailures).fetch_add (1, std::memory_order_relaxed);
+    return ok;
+}
+
+// -------------------------------------------------------------
+// Receive: reader thread → slots / queue → drain()
+// -------------------------------------------------------------
+void SocketCANTransport::readLoop () {
+    struct pollfd descriptor;
+    descriptor.fd     = socketFd;
+    descriptor.events = POLLIN;
+
+    while (running) {
+        if (poll (&descriptor, 1, READER_POLL_MS) <= 0) {
+            continue;
+        }
+        // Empty the socket before going back to sleep
+        struct can_frame frame;
+        struct iovec buffer;
+        buffer.iov_base = &frame;
+        buffer.iov_len  = sizeof (frame);
+        struct msghdr header;
+        memset (&header, 0, sizeof (header));
+        header.msg_iov    = &buffer;
+        header.msg_iovlen = 1;
+        while (recvmsg (socketFd, &header, MSG_DONTWAIT) == sizeof (frame)) {
+            if ((frame.can_id & CAN_ERR_FLAG) != 0) {
+                continue;
+            }
+            // MSG_CONFIRM marks the echo of a frame this socket sent
+            const bool own = (header.msg_flags & MSG_CONFIRM) != 0;
+            CANMessage message;
+            message.ext = (frame.can_id & CAN_EFF_FLAG) != 0;
+            message.rtr = (frame.can_id & CAN_RTR_FLAG) != 0;
+            message.id  = frame.can_id & (message.ext ? CAN_EFF_MASK : CAN_SFF_MASK);
+            message.len = (frame.can_dlc > 8) ? 8 : frame.can_dlc;
+            memcpy (message.data, frame.data, message.len);
+            message.timestamp = uint32_t (esp_timer_get_time ());
+
+            if (own) {
+                publish (transmitSlots, message);
+                continue;
+            }
+            received.fetch_add (1, std::memory_order_relaxed);
+
+            if (!publish (slots, message) && !receiveQueue.append (message)) {
+                overruns.fetch_add (1, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+uint32_t SocketCANTransport::drain (DrainRoutine routine, void *context) {
+    return receiveQueue.consumeAll ([routine, context] (const CANMessage &message) {
+        routine (message, context);
+    });
+}
+
+bool SocketCANTransport::subscribe (ACAN_ESP32_Subscription &slot) {
+    if (slot.mIdentifier >= kSubscribableIdCount) {
+        return false;
+    }
+    slots[slot.mIdentifier].store (&slot, std::memory_order_release);
+    return true;
+}
+
+bool SocketCANTransport::subscribeTransmit (ACAN_ESP32_Subscription &slot) {
+    if (slot.mIdentifier >= kSubscribableIdCount) {
+        return false;
+    }
+    transmitSlots[slot.mIdentifier].store (&slot, std::memory_order_release);
+    return true;
+}
+
+void SocketCANTransport::unsubscribe (const ACAN_ESP32_Subscription &slot) {
+    release (slots, slot);
+}
+
+void SocketCANTransport::unsubscribeTransmit (const ACAN_ESP32_Subscription &slot) {
+    release (transmitSlots, slot);
+}
+
+// -------------------------------------------------------------
+// Slots: the reader counts itself in while it writes one, and
+// release() waits it out, so a released slot can be destroyed.
+// Sequentially consistent: either the reader sees the slot gone,
+// or release() sees the reader inside.
+// -------------------------------------------------------------
+bool SocketCANTransport::publish (std::atomic<ACAN_ESP32_Subscription *> table[],
+                                  const CANMessage &message) {
+    if (message.ext || message.id >= kSubscribableIdCount) {
+        return false;
+    }
+    publishing.fetch_add (1);
+    ACAN_ESP32_Subscription *slot = table[message.id].load ();
+    if (slot != nullptr) {
+        slot->publish (message);
+    }
+    publishing.fetch_sub (1);
+    return slot != nullptr;
+}
+
+void SocketCANTransport::release (std::atomic<ACAN_ESP32_Subscription *> table[],
+                                  const ACAN_ESP32_Subscription &slot) {
+    if (slot.mIdentifier >= kSubscribableIdCount) {
+        return;
+    }
+    ACAN_ESP32_Subscription *expected = const_cast<ACAN_ESP32_Subscription *> (&slot);
+    table[slot.mIdentifier].compare_exchange_strong (expected, nullptr);
+    while (publishing.load () != 0) {
+        std::this_thread::yield ();
+    }
+}
+
+// -------------------------------------------------------------
+// Statistics
+// -------------------------------------------------------------
+uint32_t SocketCANTransport::getTransmittedFrameCount () const { return transmitted; }
+uint32_t SocketCANTransport::getTransmitFailureCount () const  { return transmitFailures; }
+uint32_t SocketCANTransport::getReceivedFrameCount () const    { return received; }
+uint32_t SocketCANTransport::getReceiveOverrunCount () const   { return overruns; }
+
+#endif  // __linux__
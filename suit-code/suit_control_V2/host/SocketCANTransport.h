@@ -0,0 +1,93 @@
+#ifndef SOCKET_CAN_TRANSPORT_H
+#define SOCKET_CAN_TRANSPORT_H
+
+#ifdef __linux__
+
+#include <atomic>
+#include <thread>
+#include <ACAN_ESP32_Buffer16.h>
+#include "CANTransport.h"
+
+/*
+ * SocketCANTransport — CANTransport on a Linux SocketCAN interface
+ * ----------------------------------------------------------------
+ * ‣ Works with real adapters (can0) and with the virtual vcan driver:
+ *     sudo modprobe vcan
+ *     sudo ip link add dev vcan0 type vcan && sudo ip link set up vcan0
+ *   Every socket on vcan0 sees the others' frames, so a simulated motor in
+ *   another process (or thread) can sit on the other end.
+ * ‣ The bit rate is a property of the interface (ip link ... bitrate N);
+ *   begin() ignores it, and the pins.
+ * ‣ The acceptance filter becomes a CAN_RAW_FILTER on the socket.
+ * ‣ A reader thread plays the part of the RX interrupt: it timestamps each
+ *   frame with esp_timer_get_time(), writes subscribed IDs into their slot
+ *   and queues the rest for drain().
+ * ‣ Own frames are echoed back (CAN_RAW_RECV_OWN_MSGS) once the interface
+ *   has sent them; the reader writes them into their transmit slot, stamped
+ *   with the time it saw the echo. Only IDs the filter accepts are echoed.
+ * ‣ send() is a non-blocking write; a full interface queue refuses the frame.
+ *   The priority class is passed on as the socket priority (SO_PRIORITY),
+ *   which orders frames only if the interface has a prio qdisc
+ *   (tc qdisc add dev can0 root handle 1: prio).
+ */
+
+class SocketCANTransport : public CANTransport {
+public:
+    static const uint32_t kCannotOpenSocket     = 1UL << 0;
+    static const uint32_t kUnknownInterface     = 1UL << 1;
+    static const uint32_t kCannotSetFilter      = 1UL << 2;
+    static const uint32_t kCannotBind           = 1UL << 3;
+    static const uint32_t kCannotAllocateQueue  = 1UL << 20;
+    static const uint16_t kSubscribableIdCount  = 32;
+
+    explicit SocketCANTransport(const char* interfaceName = "vcan0",
+                                uint16_t receiveQueueSize = 64);
+    ~SocketCANTransport() override;
+
+    SocketCANTransport(const SocketCANTransport&) = delete;
+    SocketCANTransport& operator=(const SocketCANTransport&) = delete;
+
+    uint32_t begin(uint8_t txPin, uint8_t rxPin, uint32_t bitRate,
+                   const CANFilterPlan& filter) override;
+    bool     send(const CANMessage& message,
+                  CAN_PRIORITY priority = CAN_PRIORITY_NORMAL) override;
+    uint32_t drain(DrainRoutine routine, void* context) override;
+    bool     subscribe(ACAN_ESP32_Subscription& slot) override;
+    bool     subscribeTransmit(ACAN_ESP32_Subscription& slot) override;
+    void     unsubscribe(const ACAN_ESP32_Subscription& slot) override;
+    void     unsubscribeTransmit(const ACAN_ESP32_Subscription& slot) override;
+
+    // Close the socket and stop the reader thread (also done by the destructor)
+    void     end();
+
+    // Statistics
+    uint32_t getTransmittedFrameCount() const;
+    uint32_t getTransmitFailureCount() const;  // refused by the interface
+    uint32_t getReceivedFrameCount() const;
+    uint32_t getReceiveOverrunCount() const;   // lost, receive queue full
+
+private:
+    void readLoop();
+    bool publish(std::atomic<ACAN_ESP32_Subscription*> table[], const CANMessage& message);
+    void release(std::atomic<ACAN_ESP32_Subscription*> table[], const ACAN_ESP32_Subscription& slot);
+
+    char                  interfaceName[16];
+    uint16_t              receiveQueueSize;
+    int                   socketFd = -1;
+    CAN_PRIORITY          socketPriority = CAN_PRIORITY_NORMAL;
+    std::thread           reader;
+    std::atomic<bool>     running{false};
+    ACAN_ESP32_Buffer16   receiveQueue;
+    std::atomic<ACAN_ESP32_Subscription*> slots[kSubscribableIdCount] = {};
+    std::atomic<ACAN_ESP32_Subscription*> transmitSlots[kSubscribableIdCount] = {};
+    std::atomic<uint32_t> publishing{0};    // reader inside publish()
+
+    std::atomic<uint32_t> transmitted{0};
+    std::atomic<uint32_t> transmitFailures{0};
+    std::atomic<uint32_t> received{0};
+    std::atomic<uint32_t> overruns{0};
+};
+
+#endif  // __linux__
+
+#endif  // SOCKET_CAN_TRANSPORT_H
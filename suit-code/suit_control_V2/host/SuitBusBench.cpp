@@ -0,0 +1,216 @@
+/*
+ * SuitBusBench — the suit's CAN layer against four simulated AK motors
+ *
+ * Runs CANHandler, Motor and MotorGroup unchanged, on the host, with a
+ * PD joint controller closing the loop through the simulated bus, and
+ * reports throughput and command → feedback latency. With socketcan the
+ * same loop runs in real time on a SocketCAN interface instead, against
+ * whatever answers there: the motors on can0, or on vcan0 a capture
+ * played back with CANRecordTool.
+ *
+ * Build from suit_control_V2/:
+ *   g++ -std=gnu++17 -O2 -I. -Ihost host/SuitBusBench.cpp CANHandler.cpp \
+ *       ESP32CANTransport.cpp Motor.cpp MotorGroup.cpp RemoteDebug.cpp \
+ *       DeferredLogger.cpp UDPLogTransport.cpp \
+ *       ACAN_ESP32.cpp ACAN_ESP32_Settings.cpp host/HostArduino.cpp \
+ *       host/HostCANBus.cpp host/ACAN_ESP32_HostPlatform.cpp \
+ *       host/ACAN_ESP32_EmulatedTWAI.cpp host/LoopbackCANTransport.cpp \
+ *       host/SimulatedAKMotor.cpp host/SocketCANTransport.cpp -o suit_bus_bench -lpthread
+ *
+ * Usage: suit_bus_bench [loopback|esp32|socketcan <ifname>] [cycles] [period_us]
+ *                       [latency_us] [jitter_us]
+ *   loopback  — ideal controller on the bus (LoopbackCANTransport)
+ *   esp32     — ACAN_ESP32 on the emulated TWAI controller (default)
+ *   socketcan — SocketCANTransport on a Linux interface, in real time; motors
+ *               1…4 must answer there (latency and jitter do not apply)
+ */
+
+#include <Arduino.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "CANHandler.h"
+#include "ESP32CANTransport.h"
+#include "Motor.h"
+#include "MotorGroup.h"
+#include "ACAN_ESP32_EmulatedTWAI.h"
+#include "LoopbackCANTransport.h"
+#include "SimulatedAKMotor.h"
+#include "SocketCANTransport.h"
+
+static const uint8_t JOINTS = 4;
+
+static int usage () {
+    fprintf (stderr, "usage: suit_bus_bench [loopback|esp32|socketcan <ifname>] [cycles] "
+                     "[period_us] [latency_us] [jitter_us]\n");
+    return 2;
+}
+
+int main (int argc, char *argv[]) {
+    const bool  loopback  = (argc > 1) && (strcmp (argv[1], "loopback") == 0);
+    const bool  socketCAN = (argc > 1) && (strcmp (argv[1], "socketcan") == 0);
+    if (socketCAN && argc < 3) {
+        return usage ();
+    }
+    const char *interfaceName = socketCAN ? argv[2] : nullptr;
+    const int   first         = socketCAN ? 3 : 2;    // numeric arguments
+    const uint32_t cycles    = (argc > first)     ? strtoul (argv[first], nullptr, 0)     : 100000;
+    const uint32_t periodUs  = (argc > first + 1) ? strtoul (argv[first + 1], nullptr, 0) : 1000;
+    const uint32_t latencyUs = (argc > first + 2) ? strtoul (argv[first + 2], nullptr, 0) : 50;
+    const uint32_t jitterUs  = (argc > first + 3) ? strtoul (argv[first + 3], nullptr, 0) : 20;
+
+    // The simulated bus drives the host clock while it exists, so on a
+    // real interface there is none
+    std::unique_ptr<HostCANBus>              bus;
+    std::unique_ptr<ACAN_ESP32_EmulatedTWAI> twai;
+    std::unique_ptr<LoopbackCANTransport>    loopbackTransport;
+    std::unique_ptr<SocketCANTransport>      socketTransport;
+    SimulatedAKMotor *plants[JOINTS] = {};
+    CANTransport *transport = &ESP32CANTransport::instance ();
+    if (socketCAN) {
+        socketTransport.reset (new SocketCANTransport (interfaceName));
+        transport = socketTransport.get ();
+        // setupCAN() does not report failure, so open it once here
+        const uint32_t errorCode = socketTransport->begin (0, 0, 1000000, CANFilterPlan ());
+        if (errorCode != 0) {
+            fprintf (stderr, "cannot open %s (error 0x%lX)\n", interfaceName, (unsigned long) errorCode);
+            return 1;
+        }
+    } else {
+        bus.reset (new HostCANBus ());
+        for (uint8_t i = 0; i < JOINTS; ++i) {
+            plants[i] = new SimulatedAKMotor (i + 1);
+            plants[i]->setReplyLatency (latencyUs * 1000ULL, jitterUs * 1000ULL, i + 1);
+            bus->attach (*plants[i]);
+        }
+        twai.reset (new ACAN_ESP32_EmulatedTWAI (*bus));
+        if (loopback) {
+            loopbackTransport.reset (new LoopbackCANTransport (*bus));
+            transport = loopbackTransport.get ();
+        }
+    }
+
+    // Let time pass: virtual on the simulated bus, real on an interface
+    auto deadline = std::chrono::steady_clock::now ();
+    auto advance = [&] (uint64_t nanoseconds) {
+        if (bus) {
+            bus->runFor (nanoseconds);
+        } else {
+            deadline += std::chrono::nanoseconds (nanoseconds);
+            std::this_thread::sleep_until (deadline);
+        }
+    };
+
+    CANHandler canHandler (*transport);
+    MotorGroup joints (canHandler);
+    Motor *motors[JOINTS];
+    for (uint8_t i = 0; i < JOINTS; ++i) {
+        motors[i] = new Motor (i + 1, canHandler, Debug);
+    }
+    canHandler.setupCAN ();
+    for (uint8_t i = 0; i < JOINTS; ++i) {
+        motors[i]->start ();
+        motors[i]->reZero ();
+        joints.add (*motors[i]);
+    }
+    advance (5'000'000ULL);
+    canHandler.update ();
+    joints.update ();
+    if (bus) {
+        bus->resetStatistics ();
+    }
+    const uint32_t framesBefore = socketCAN ? socketTransport->getTransmittedFrameCount () +
+                                              socketTransport->getReceivedFrameCount () : 0;
+
+    // Command → feedback latency: each feedback frame against the last
+    // command that left before it arrived
+    std::vector<uint32_t> sendTimes;
+    std::vector<uint32_t> latencies;
+    sendTimes.reserve (cycles);
+    latencies.reserve (cycles * JOINTS);
+    uint32_t lastSequence[JOINTS] = {};
+    double   trackingError = 0.0;
+
+    const auto wallStart = std::chrono::steady_clock::now ();
+    deadline = wallStart;
+    for (uint32_t cycle = 0; cycle < cycles; ++cycle) {
+        // PD towards a 1 Hz, 0.5 rad sine on every joint
+        const float t = float (cycle) * periodUs * 1e-6f;
+        float torques[JOINTS];
+        for (uint8_t i = 0; i < JOINTS; ++i) {
+            const float target = 0.5f * sinf (2.0f * float (PI) * t + i);
+            const float error  = target - motors[i]->getPosition ();
+            torques[i] = 20.0f * error - 0.5f * motors[i]->getVelocity ();
+            trackingError += fabs (error);
+        }
+        sendTimes.push_back (micros ());
+        joints.sendTorques (torques);
+
+        advance (periodUs * 1000ULL);
+        canHandler.update ();
+        joints.update ();
+
+        for (uint8_t i = 0; i < JOINTS; ++i) {
+            const uint32_t sequence = canHandler.getSequence (i + 1);
+            if (sequence == lastSequence[i]) {
+                continue;
+            }
+            lastSequence[i] = sequence;
+            const uint32_t arrival = motors[i]->getFeedbackTime ();
+            auto sent = std::upper_bound (sendTimes.begin (), sendTimes.end (), arrival);
+            if (sent != sendTimes.begin ()) {
+                latencies.push_back (arrival - *(sent - 1));
+            }
+        }
+    }
+    const double wall = std::chrono::duration<double> (std::chrono::steady_clock::now () - wallStart).count ();
+
+    std::sort (latencies.begin (), latencies.end ());
+    const size_t n = latencies.size ();
+    double sum = 0.0;
+    for (uint32_t value : latencies) {
+        sum += value;
+    }
+    const double simulated = double (cycles) * periodUs * 1e-6;
+
+    if (socketCAN) {
+        // Real time: no bus model, so frames as the socket counted them
+        const uint32_t frames = socketTransport->getTransmittedFrameCount () +
+                                socketTransport->getReceivedFrameCount () - framesBefore;
+        printf ("transport        : socketcan (%s)\n", interfaceName);
+        printf ("control cycles   : %lu x %lu us (%.2f s scheduled, %.2f s wall)\n",
+                (unsigned long) cycles, (unsigned long) periodUs, simulated, wall);
+        printf ("socket frames    : %lu sent and received (%.0f frames/s), %lu refused, %lu overruns\n",
+                (unsigned long) frames, frames / wall,
+                (unsigned long) socketTransport->getTransmitFailureCount (),
+                (unsigned long) socketTransport->getReceiveOverrunCount ());
+        printf ("dropped commands : %lu\n", (unsigned long) joints.getDroppedFrames ());
+    } else {
+        printf ("transport        : %s\n", loopback ? "loopback" : "esp32 (emulated TWAI)");
+        printf ("control cycles   : %lu x %lu us (%.2f s simulated, %.2f s wall, %.1fx real time)\n",
+                (unsigned long) cycles, (unsigned long) periodUs, simulated, wall, simulated / wall);
+        printf ("bus frames       : %llu (%.0f frames/s simulated, %.0f frames/s wall), load %.1f %%\n",
+                (unsigned long long) bus->getFrameCount (), bus->getFrameCount () / simulated,
+                bus->getFrameCount () / wall, 100.0 * bus->getBusLoad ());
+        printf ("dropped commands : %lu, dropped replies %lu\n", (unsigned long) joints.getDroppedFrames (),
+                (unsigned long) (plants[0]->getDroppedReplyCount () + plants[1]->getDroppedReplyCount () +
+                                 plants[2]->getDroppedReplyCount () + plants[3]->getDroppedReplyCount ()));
+    }
+    if (n > 0) {
+        printf ("cmd -> feedback  : avg %.1f us, p50 %lu us, p99 %lu us, max %lu us (%lu samples)\n",
+                sum / n, (unsigned long) latencies[n / 2], (unsigned long) latencies[n * 99 / 100],
+                (unsigned long) latencies[n - 1], (unsigned long) n);
+    }
+    printf ("tracking error   : %.4f rad mean\n", trackingError / (double (cycles) * JOINTS));
+
+    for (uint8_t i = 0; i < JOINTS; ++i) {
+        delete motors[i];
+        if (bus) {
+            bus->detach (*plants[i]);
+            delete plants[i];
+        }
+    }
+    return 0;
+}
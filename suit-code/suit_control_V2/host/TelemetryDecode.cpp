@@ -0,0 +1,165 @@
+/*
+ * TelemetryDecode — turn the sketch's binary telemetry into CSV on Linux
+ *
+ * Reads a raw capture of the serial port, or the port itself through a
+ * pipe, splits it at the zero delimiters and keeps the frames that decode
+ * as Telemetry packets (valid COBS, CRC, type and version). Everything else
+ * is Serial text or a damaged packet and is skipped:
+ *   stty -F /dev/ttyUSB0 921600 raw && cat /dev/ttyUSB0 > suit.bin
+ *   cat /dev/ttyUSB0 | telemetry_decode - suit.csv text
+ *
+ * Build from suit_control_V2/:
+ *   g++ -std=gnu++17 -O2 -I. -Ihost host/TelemetryDecode.cpp Telemetry.cpp \
+ *       -o telemetry_decode
+ *
+ * Usage:
+ *   telemetry_decode <capture|-> [csv|-] [text]
+ *     One CSV row per record (default: stdout). Time is the sketch's
+ *     micros(), unwrapped, in seconds (it restarts with the sketch).
+ *     Sequence gaps (records the sketch dropped, or damaged ones) are
+ *     counted and reported on stderr at the end. With "text", the Serial
+ *     text found between packets goes to stderr as well.
+ */
+
+#include <Arduino.h>
+#include <vector>
+#include "Telemetry.h"
+
+struct Decoder {
+    FILE    *csv;
+    bool     echoText;
+    uint64_t records = 0;
+    uint64_t lost = 0;           // sequence numbers never seen
+    uint64_t damaged = 0;        // binary frames that did not decode
+    uint64_t textBytes = 0;
+    bool     first = true;
+    uint32_t lastSequence = 0;
+    uint32_t lastTimestamp = 0;
+    uint64_t clock = 0;          // µs, unwrapped
+};
+
+// -------------------------------------------------------------
+// Output
+// -------------------------------------------------------------
+static void writeHeader (FILE *csv) {
+    fprintf (csv, "sequence,time_s,loop_period_us,loop_time_us,online");
+    for (uint8_t j = 0; j < TELEMETRY_JOINTS; ++j) {
+        fprintf (csv, ",j%u_omega,j%u_torque_cmd,j%u_position,j%u_velocity,j%u_torque",
+                 j, j, j, j, j);
+    }
+    fprintf (csv, "\n");
+}
+
+static void writeRecord (Decoder &decoder, uint32_t sequence, const TelemetryRecord &record) {
+    if (!decoder.first && int32_t (sequence - decoder.lastSequence) <= 0) {
+        fprintf (stderr, "sequence %u after %u: the sketch restarted\n",
+                 sequence, decoder.lastSequence);
+        decoder.first = true;
+    }
+    if (decoder.first) {
+        decoder.clock = record.timestamp;
+    } else {
+        decoder.clock += uint32_t (record.timestamp - decoder.lastTimestamp);
+        decoder.lost  += uint32_t (sequence - decoder.lastSequence - 1);
+    }
+    decoder.first         = false;
+    decoder.lastSequence  = sequence;
+    decoder.lastTimestamp = record.timestamp;
+    ++decoder.records;
+
+    fprintf (decoder.csv, "%u,%.6f,%u,%u,%u", sequence, decoder.clock / 1e6,
+             record.loopPeriod, record.loopTime, record.online);
+    for (const TelemetryJoint &joint : record.joints) {
+        fprintf (decoder.csv, ",%.6g,%.6g,%.6g,%.6g,%.6g", joint.omega, joint.torqueCommand,
+                 joint.position, joint.velocity, joint.torque);
+    }
+    fprintf (decoder.csv, "\n");
+}
+
+// -------------------------------------------------------------
+// Frames: the bytes between two zeros
+// -------------------------------------------------------------
+static bool isText (const std::vector<uint8_t> &frame) {
+    for (uint8_t c : frame) {
+        if (c >= 0x7F || (c < 0x20 && c != '\n' && c != '\r' && c != '\t')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void handleFrame (Decoder &decoder, const std::vector<uint8_t> &frame) {
+    if (frame.empty ()) {
+        return;
+    }
+    uint32_t sequence;
+    TelemetryRecord record;
+    if (Telemetry::decodePacket (frame.data (), frame.size (), sequence, record)) {
+        writeRecord (decoder, sequence, record);
+    } else if (isText (frame)) {
+        decoder.textBytes += frame.size ();
+        if (decoder.echoText) {
+            fwrite (frame.data (), 1, frame.size (), stderr);
+        }
+    } else {
+        ++decoder.damaged;
+    }
+}
+
+static int usage () {
+    fprintf (stderr, "usage: telemetry_decode <capture|-> [csv|-] [text]\n");
+    return 2;
+}
+
+int main (int argc, char *argv[]) {
+    if (argc < 2 || argc > 4) {
+        return usage ();
+    }
+    const bool fromStdin = strcmp (argv[1], "-") == 0;
+    FILE *in = fromStdin ? stdin : fopen (argv[1], "rb");
+    if (in == nullptr) {
+        fprintf (stderr, "cannot read %s\n", argv[1]);
+        return 1;
+    }
+    Decoder decoder;
+    decoder.csv = stdout;
+    if (argc >= 3 && strcmp (argv[2], "-") != 0) {
+        decoder.csv = fopen (argv[2], "w");
+        if (decoder.csv == nullptr) {
+            fprintf (stderr, "cannot write %s\n", argv[2]);
+            return 1;
+        }
+    }
+    decoder.echoText = (argc == 4);
+    if (decoder.echoText && strcmp (argv[3], "text") != 0) {
+        return usage ();
+    }
+
+    writeHeader (decoder.csv);
+    std::vector<uint8_t> frame;
+    uint8_t buffer[4096];
+    size_t count;
+    while ((count = fread (buffer, 1, sizeof (buffer), in)) > 0) {
+        for (size_t i = 0; i < count; ++i) {
+            if (buffer[i] == 0) {
+                handleFrame (decoder, frame);
+                frame.clear ();
+            } else {
+                frame.push_back (buffer[i]);
+            }
+        }
+        fflush (decoder.csv);
+    }
+    handleFrame (decoder, frame);   // Trailing text, or a cut packet
+
+    if (!fromStdin) {
+        fclose (in);
+    }
+    if (decoder.csv != stdout) {
+        fclose (decoder.csv);
+    }
+    fprintf (stderr, "%llu records, %llu lost, %llu damaged, %llu bytes of text\n",
+             (unsigned long long) decoder.records, (unsigned long long) decoder.lost,
+             (unsigned long long) decoder.damaged, (unsigned long long) decoder.textBytes);
+    return 0;
+}
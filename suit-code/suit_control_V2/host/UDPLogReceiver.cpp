@@ -0,0 +1,184 @@
+/*
+ * UDPLogReceiver — write the suit's UDP debug log to disk on Linux
+ *
+ * Receives the datagrams UDPLogTransport sends (RemoteDebug::beginUDP()),
+ * writes every record to the output as it arrives, and reports loss from
+ * the gaps in the sequence numbers: datagrams lost on the network, and
+ * records lost in all (network, or overwritten in the sender's ring while
+ * WiFi was down). Each gap is reported on stderr when it is seen, and the
+ * totals at the end.
+ *
+ * Build from suit_control_V2/:
+ *   g++ -std=gnu++17 -O2 -I. -Ihost host/UDPLogReceiver.cpp -o udp_log_receiver
+ *
+ * Usage:
+ *   udp_log_receiver <port> [file|-] [seconds]
+ *     Listens on every interface (default output: stdout), until Ctrl-C
+ *     or for the given time. A host build of the sketch's logger sending
+ *     to 127.0.0.1 stands in for the suit in tests.
+ */
+
+#include <Arduino.h>
+#include <map>
+#include <string>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "UDPLogTransport.h"
+
+struct Source {
+    uint32_t nextSequence = 0;
+    uint32_t nextRecord = 0;
+    uint64_t datagrams = 0;
+    uint64_t records = 0;
+    uint64_t lostDatagrams = 0;
+    uint64_t lostRecords = 0;
+    uint32_t restarts = 0;
+};
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void requestStop (int) {
+    stopRequested = 1;
+}
+
+// -------------------------------------------------------------
+// One datagram: check, account for gaps, write the records
+// -------------------------------------------------------------
+static bool receive (std::map<std::string, Source> &sources, const uint8_t *data, size_t size,
+                     FILE *out) {
+    UDPLogHeader header;
+    if (size < sizeof (header)) {
+        return false;
+    }
+    memcpy (&header, data, sizeof (header));
+    if (memcmp (header.magic, "SLOG", 4) != 0 || header.version != UDPLogTransport::VERSION) {
+        return false;
+    }
+    // Records must fill the datagram exactly
+    size_t offset = sizeof (header);
+    for (uint16_t i = 0; i < header.recordCount; ++i) {
+        if (offset + 2 > size) {
+            return false;
+        }
+        offset += 2 + (data[offset] | (data[offset + 1] << 8));
+    }
+    if (offset != size) {
+        return false;
+    }
+
+    const std::string name (header.source, strnlen (header.source, sizeof (header.source)));
+    const bool first = (sources.find (name) == sources.end ());
+    Source &source = sources[name];
+    if (!first) {
+        if (int32_t (header.sequence - source.nextSequence) < 0) {
+            fprintf (stderr, "%s: datagram %u after %u, the sender restarted\n",
+                     name.c_str (), header.sequence, source.nextSequence - 1);
+            ++source.restarts;
+        } else if (header.sequence != source.nextSequence ||
+                   header.firstRecord != source.nextRecord) {
+            const uint32_t datagrams = header.sequence - source.nextSequence;
+            const uint32_t records   = header.firstRecord - source.nextRecord;
+            fprintf (stderr, "%s: lost %u datagrams, %u records before datagram %u\n",
+                     name.c_str (), datagrams, records, header.sequence);
+            source.lostDatagrams += datagrams;
+            source.lostRecords   += records;
+        }
+    }
+    source.nextSequence = header.sequence + 1;
+    source.nextRecord   = header.firstRecord + header.recordCount;
+    ++source.datagrams;
+    source.records += header.recordCount;
+
+    offset = sizeof (header);
+    for (uint16_t i = 0; i < header.recordCount; ++i) {
+        const size_t length = data[offset] | (data[offset + 1] << 8);
+        fwrite (data + offset + 2, 1, length, out);
+        offset += 2 + length;
+    }
+    fflush (out);
+    return true;
+}
+
+static int usage () {
+    fprintf (stderr, "usage: udp_log_receiver <port> [file|-] [seconds]\n");
+    return 2;
+}
+
+int main (int argc, char *argv[]) {
+    if (argc < 2 || argc > 4) {
+        return usage ();
+    }
+    const int port = atoi (argv[1]);
+    if (port <= 0 || port > 65535) {
+        return usage ();
+    }
+    FILE *out = stdout;
+    if (argc >= 3 && strcmp (argv[2], "-") != 0) {
+        out = fopen (argv[2], "w");
+        if (out == nullptr) {
+            fprintf (stderr, "cannot write %s\n", argv[2]);
+            return 1;
+        }
+    }
+    const double seconds = (argc == 4) ? atof (argv[3]) : 0.0;
+
+    const int handle = socket (AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    sockaddr_in local;
+    memset (&local, 0, sizeof (local));
+    local.sin_family      = AF_INET;
+    local.sin_port        = htons (uint16_t (port));
+    local.sin_addr.s_addr = htonl (INADDR_ANY);
+    if (handle < 0 || bind (handle, reinterpret_cast<sockaddr *> (&local), sizeof (local)) < 0) {
+        fprintf (stderr, "cannot listen on UDP port %d: %s\n", port, strerror (errno));
+        return 1;
+    }
+    // Wake up now and then to check for the end
+    timeval timeout = { 0, 200000 };
+    setsockopt (handle, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof (timeout));
+    signal (SIGINT, requestStop);
+    signal (SIGTERM, requestStop);
+
+    timespec start;
+    clock_gettime (CLOCK_MONOTONIC, &start);
+    std::map<std::string, Source> sources;
+    uint64_t malformed = 0;
+    static uint8_t data[65536];
+    while (!stopRequested) {
+        const ssize_t size = recv (handle, data, sizeof (data), 0);
+        if (size >= 0 && !receive (sources, data, size_t (size), out)) {
+            ++malformed;
+        }
+        if (seconds > 0) {
+            timespec now;
+            clock_gettime (CLOCK_MONOTONIC, &now);
+            if ((now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) / 1e9 >= seconds) {
+                break;
+            }
+        }
+    }
+    close (handle);
+    if (out != stdout) {
+        fclose (out);
+    }
+
+    for (const auto &entry : sources) {
+        const Source &source = entry.second;
+        fprintf (stderr, "%s: %llu datagrams, %llu records, lost %llu datagrams, %llu records",
+                 entry.first.empty () ? "(unnamed)" : entry.first.c_str (),
+                 (unsigned long long) source.datagrams, (unsigned long long) source.records,
+                 (unsigned long long) source.lostDatagrams, (unsigned long long) source.lostRecords);
+        if (source.restarts > 0) {
+            fprintf (stderr, ", %u restarts", source.restarts);
+        }
+        fprintf (stderr, "\n");
+    }
+    if (malformed > 0) {
+        fprintf (stderr, "%llu malformed datagrams ignored\n", (unsigned long long) malformed);
+    }
+    return 0;
+}
@@ -0,0 +1,11 @@
+//------------------------------------------------------------------------------
+//   esp_timer.h for host builds: the esp_timer API of ACAN_ESP32_HostPlatform
+//   (esp_timer_get_time, one-shot and periodic timers), so sketch code that
+//   includes <esp_timer.h> builds unchanged on Linux.
+//------------------------------------------------------------------------------
+
+#pragma once
+
+#include <ACAN_ESP32_HostPlatform.h>
+
+//------------------------------------------------------------------------------
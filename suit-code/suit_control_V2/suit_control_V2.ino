@@ -1,8 +1,16 @@
 #include <Arduino.h>
 #include <Wire.h>
+#include <WiFi.h>
 #include "CANHandler.h"
+#include "CANBusMonitor.h"
+#include "CANBusRecovery.h"
+#include "CANFlightRecorder.h"
+#include "MITCodecBenchmark.h"
 #include "Motor.h"
+#include "MotorScheduler.h"
 #include "RemoteDebug.h"
+#include "Telemetry.h"
+#include "ControlScheduler.h"
 #include <Adafruit_MPU6050.h>
 #include <Adafruit_Sensor.h>
 
@@ -13,12 +21,46 @@ static const int CAN_RX_PIN = 21;   // D21 = RX
 static const int I2C_SDA_PIN = 23;
 static const int I2C_SCL_PIN = 25;
 
+// Serial carries the binary telemetry as well as the text, hence the high
+// baud rate; the TX buffer lets a whole record queue without waiting
+static const unsigned long SERIAL_BAUD = 921600;
+static const size_t SERIAL_TX_BUFFER = 2048;
+
+// Debug log over WiFi to host/UDPLogReceiver on DEBUG_UDP_HOST (leave the
+// SSID empty to log to Serial only)
+static const char *DEBUG_WIFI_SSID = "";
+static const char *DEBUG_WIFI_PASSWORD = "";
+static const char *DEBUG_UDP_HOST = "192.168.4.2";
+static const uint16_t DEBUG_UDP_PORT = 5140;
+
 // Global CAN handler
 CANHandler canHandler;
 
+// Bus load, error counters and per-ID timing, sampled every 100 ms
+CANBusMonitor busMonitor;
+
+// Bus-off / error-passive handling, polled every 1 ms
+CANBusRecovery busRecovery;
+
+// Last 1024 CAN frames; frozen on bus-off or 'D' over serial, then dumped
+// to Serial (read it with host/CANRecordTool)
+CANFlightRecorder flightRecorder;
+uint32_t lastBusOffCount = 0;
+
+// One binary record per control cycle on Serial (decode with
+// host/TelemetryDecode)
+Telemetry telemetry;
+
+// Control cycle: released by a 100 Hz timer, not paced by delay()
+static const uint32_t CONTROL_PERIOD_US = 10000;
+ControlScheduler control;
+
 // Motors
 Motor motor1(0x01, canHandler, Debug); // RIGHT HIP
 
+// Active joints: each gets a fixed slot in a 1 ms time-triggered CAN cycle
+MotorScheduler joints(canHandler);
+
 
 // MPU axis unit vectors - these were determined experimentally
 float mpuVec1[3] = {0.25246345, 0.92360996, 0.28845599}; // channel 0 - right hip
@@ -45,69 +87,44 @@ float dotProduct(float gyroVec[3], float sensorVec[3]) {
   return sum;
 }
 
+// Joint state and feedback for the telemetry record
+void fillTelemetryJoint(TelemetryRecord &record, uint8_t joint, float omega, float torqueCommand, const Motor &motor) {
+  TelemetryJoint &out = record.joints[joint];
+  out.omega = omega;
+  out.torqueCommand = torqueCommand;
+  out.position = motor.getPosition();
+  out.velocity = motor.getVelocity();
+  out.torque = motor.getTorque();
+  if (motor.isOnline()) {
+    record.online |= 1 << joint;
+  }
+}
+
 // Proportional gain for control
 const float Kp_HIP = 7.0;
 
 // Derivative gain and filter settings for motor1
 const float Kd_HIP = 0.01;
-const float dt = 0.01; // 10 ms loop
 const float alpha_d = 0.95; // Low-pass filter for derivative
 
 float prev_omega0 = 0.0;
 float filtered_domega0 = 0.0;
 
+// Latest joint state, for the telemetry stage
+float omega0 = 0.0;
+float torque1 = 0.0;
 
-void setup() {
-  Serial.begin(115200);
-  delay(1000);
-  Serial.println("Beginning program...");
+// Motors are restarted and re-zeroed every 15 s (testing watchdog)
+static const unsigned long MOTOR_RESET_INTERVAL_MS = 15000;
+unsigned long lastMotorReset = 0;
 
-  Debug.begin("ESP32_Motor_Controller");
 
-  Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN);
-
-  // ---------- CAN BUS INITIALISATION ----------
-  canHandler.setupCAN(CAN_TX_PIN, CAN_RX_PIN);
-  Serial.println("CAN bus initialized.");
-
-  // Initialise motors
-  motor1.start();
-  /*motor2.start();
-  motor3.start();
-  motor4.start();
-  motor1.reZero();
-  motor2.reZero();
-  motor3.reZero();
-  motor4.reZero();
-  */
-  Serial.println("Motors re-zeroed.");
-
-  // Initialize MPUs
-  selectMuxChannel(0);
-  if (!mpu.begin()) {
-    Serial.println("MPU0 not found!");
-  }
-  selectMuxChannel(1);
-  if (!mpu.begin()) {
-    Serial.println("MPU0 not found!");
-  }
-  delay(200);
-  selectMuxChannel(4);
-  if (!mpu.begin()) {
-    Serial.println("MPU4 not found!");
-  }
-  selectMuxChannel(5);
-  if (!mpu.begin()) {
-    Serial.println("MPU0 not found!");
-  }
-}
-
-unsigned long prev_time = millis();
-
-void loop() {
+// ------------------ Control Stages ------------------
 
+// Sensors → PD control → joint commands, every cycle
+void controlStage(const ControlTick &tick, void *) {
   unsigned long curr = millis();
-  if (curr - prev_time >= 15000) {
+  if (curr - lastMotorReset >= MOTOR_RESET_INTERVAL_MS) {
     // Stop all motors
     motor1.stop();
     /*motor2.stop();
@@ -125,28 +142,26 @@ void loop() {
     motor4.start();
     motor4.reZero();*/
 
-    Serial.println("Motors reset at 5-second interval.");
-    prev_time = curr;
+    debugI("Motors reset at 15-second interval.");
+    lastMotorReset = curr;
   }
 
   canHandler.update();
-  motor1.update();
+  joints.update();
   /*motor2.update();
   motor3.update();
   motor4.update();
   */
 
-  unsigned long now = millis();
-  float dt = (now - prev_time) / 1000.0;
-  prev_time = now;
-
+  // Measured time since the last cycle (µs resolution)
+  const float dt = tick.dt;
 
   // MPU0 (RIGHT HIP)
   selectMuxChannel(0);
   sensors_event_t accel0, gyro0, temp0;
   mpu.getEvent(&accel0, &gyro0, &temp0);
   float gyro0vec[3] = {gyro0.gyro.x, gyro0.gyro.y, gyro0.gyro.z};
-  float omega0 = dotProduct(gyro0vec, mpuVec1);
+  omega0 = dotProduct(gyro0vec, mpuVec1);
 
   /*
   // MPU1 (RIGHT KNEE)
@@ -171,10 +186,11 @@ void loop() {
   float omega5 = dotProduct(gyro5vec, mpuVec4);
   */
 
-  float torque1 = 0.0;
+  torque1 = 0.0;
   float torque2 = 0.0;
   float torque3 = 0.0;
   float torque4 = 0.0;
+  float kd1 = 0.0;
 
   // Threshold for both directions
   // RIGHT HIP (PD with derivative filtering)
@@ -191,13 +207,16 @@ void loop() {
   }
 
   torque1 = constrain(totalTorque, -9.0, 9.0);
-  motor1.sendCommand(0.0, 0.0, 0.0, 0.6, torque1);
+  kd1 = 0.6;
 } else {
-  motor1.sendCommand(0.0, 0.0, 0.0, 0.0, 0.0);
   prev_omega0 = 0;
   filtered_domega0 = 0;
 }
 
+  const float torques[] = {torque1};
+  const float kds[] = {kd1};
+  joints.sendTorques(torques, kds);
+
 
 
   /*
@@ -228,18 +247,126 @@ void loop() {
     motor4.sendCommand(0.0, 0.0, 0.0, 0.0, 0.0);
   }
   */
+}
+
+// Flight recorder trigger and dump, serial commands, every cycle
+void recorderStage(const ControlTick &, void *) {
+  // Flight recorder: keep 100 frames after a bus-off, then freeze; 'D'
+  // freezes at once. The dump goes out as the serial buffer frees up.
+  CANBusRecovery::Statistics recoveryStats;
+  busRecovery.getStatistics(recoveryStats);
+  if (recoveryStats.busOffCount != lastBusOffCount) {
+    lastBusOffCount = recoveryStats.busOffCount;
+    flightRecorder.trigger(100);
+  }
+  while (Serial.available() > 0) {
+    if (Serial.read() == 'D') {
+      flightRecorder.trigger();
+    }
+  }
+  if (flightRecorder.isFrozen() && !flightRecorder.isDumping()) {
+    flightRecorder.startDump();
+  }
+  // The logger task must not write into the middle of a dump
+  Debug.getLogger().setHeld(flightRecorder.isDumping());
+  if (flightRecorder.isDumping()) {
+    flightRecorder.dump(Serial, Serial.availableForWrite());
+  }
+}
 
-  // Always print for log
-  Serial.print("omega0: "); Serial.print(omega0, 4);
-  Serial.print(" | torque1: "); Serial.print(torque1, 4);
+// One binary record per cycle (not in the middle of a dump). A record the
+// serial buffer cannot take is dropped, never waited for.
+void telemetryStage(const ControlTick &tick, void *) {
+  ControlScheduler::Statistics timing;
+  control.getStatistics(timing);
+  TelemetryRecord record = {};
+  record.timestamp = uint32_t(tick.startTime);
+  record.loopPeriod = uint32_t(tick.dt * 1e6f + 0.5f);
+  record.loopTime = timing.lastExecution;  // the previous cycle
+  fillTelemetryJoint(record, 0, omega0, torque1, motor1);
   /*
-  Serial.print("omega1: "); Serial.print(omega1, 4);
-  Serial.print(" | torque2: "); Serial.print(torque2, 4);
-  Serial.print(" || omega4: "); Serial.print(omega4, 4);
-  Serial.print(" | torque3: "); Serial.println(torque3, 4);
-  Serial.print(" || omega5: "); Serial.print(omega5, 4);
-  Serial.print(" | torque4: "); Serial.println(torque4, 4);
+  fillTelemetryJoint(record, 1, omega1, torque2, motor2);
+  fillTelemetryJoint(record, 2, omega4, torque3, motor3);
+  fillTelemetryJoint(record, 3, omega5, torque4, motor4);
+  */
+  telemetry.setPaused(flightRecorder.isDumping());
+  telemetry.send(record);
+}
+
+void setup() {
+  Serial.setTxBufferSize(SERIAL_TX_BUFFER);
+  Serial.begin(SERIAL_BAUD);
+  delay(1000);
+  Serial.println("Beginning program...");
+#ifdef MIT_CODEC_BENCHMARK
+  runMITCodecBenchmark(Serial);
+#endif
+
+  Debug.begin("ESP32_Motor_Controller");
+  if (DEBUG_WIFI_SSID[0] != '\0') {
+    // Not waited for: the log queues until the connection is up
+    WiFi.mode(WIFI_STA);
+    WiFi.begin(DEBUG_WIFI_SSID, DEBUG_WIFI_PASSWORD);
+    if (!Debug.beginUDP(DEBUG_UDP_HOST, DEBUG_UDP_PORT)) {
+      Serial.println("UDP log not started!");
+    }
+  }
+  telemetry.begin(Serial);
+
+  Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN);
+
+  // ---------- CAN BUS INITIALISATION ----------
+  canHandler.setupCAN(CAN_TX_PIN, CAN_RX_PIN);
+  busMonitor.begin(canHandler.getBitRate(), 100);
+  busRecovery.begin();
+  flightRecorder.begin(1024, canHandler.getBitRate());
+  Serial.println("CAN bus initialized.");
+
+  // Initialise motors
+  motor1.start();
+  /*motor2.start();
+  motor3.start();
+  motor4.start();
+  motor1.reZero();
+  motor2.reZero();
+  motor3.reZero();
+  motor4.reZero();
   */
+  joints.configure(1000, 4);  // 1 ms major cycle, one 250 µs slot per joint
+  joints.assign(0, motor1);
+  joints.begin();
+  Serial.println("Motors re-zeroed.");
+
+  // Initialize MPUs
+  selectMuxChannel(0);
+  if (!mpu.begin()) {
+    Serial.println("MPU0 not found!");
+  }
+  selectMuxChannel(1);
+  if (!mpu.begin()) {
+    Serial.println("MPU0 not found!");
+  }
+  delay(200);
+  selectMuxChannel(4);
+  if (!mpu.begin()) {
+    Serial.println("MPU4 not found!");
+  }
+  selectMuxChannel(5);
+  if (!mpu.begin()) {
+    Serial.println("MPU0 not found!");
+  }
 
-  delay(10); // 100 Hz
+  // Control cycle: stages run in this order, once per 10 ms release
+  control.addStage("control", controlStage);
+  control.addStage("recorder", recorderStage);
+  control.addStage("telemetry", telemetryStage);
+  lastMotorReset = millis();
+  if (!control.begin(CONTROL_PERIOD_US)) {
+    Serial.println("Control scheduler not started!");
+  }
+}
+
+void loop() {
+  // Waits for the next 10 ms release, then runs the stages
+  control.run();
 }